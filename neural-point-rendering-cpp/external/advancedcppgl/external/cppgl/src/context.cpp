@@ -17,6 +17,11 @@
 #include <glm/glm.hpp>
 #include <iostream>
 #include <fstream>
+#include <chrono>
+#ifdef CPPGL_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
 
 // -------------------------------------------
 // helper funcs
@@ -92,42 +97,78 @@ static void glfw_char_callback(GLFWwindow* window, unsigned int c) {
 
 static ContextParameters parameters;
 
-Context::Context() {
-    if (!glfwInit())
-        throw std::runtime_error("glfwInit failed!");
-    glfwSetErrorCallback(glfw_error_func);
+// headless: no glfw window exists, its size is kept here
+static bool headless_context = false;
+static glm::ivec2 headless_resolution;
+#ifdef CPPGL_EGL
+static EGLDisplay egl_display = EGL_NO_DISPLAY;
+static EGLContext egl_context = EGL_NO_CONTEXT;
+
+// surfaceless context without window system (mesa gpu drivers and llvmpipe), on the first EGL device otherwise (nvidia)
+static bool egl_make_surfaceless_context() {
+    auto get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    auto query_devices = (PFNEGLQUERYDEVICESEXTPROC)eglGetProcAddress("eglQueryDevicesEXT");
+    if (!get_platform_display) return false;
+    egl_display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    EGLint major, minor;
+    if (egl_display == EGL_NO_DISPLAY || !eglInitialize(egl_display, &major, &minor)) {
+        EGLDeviceEXT device;
+        EGLint devices = 0;
+        if (!query_devices || !query_devices(1, &device, &devices) || devices < 1) return false;
+        egl_display = get_platform_display(EGL_PLATFORM_DEVICE_EXT, device, nullptr);
+        if (egl_display == EGL_NO_DISPLAY || !eglInitialize(egl_display, &major, &minor)) return false;
+    }
+    if (!eglBindAPI(EGL_OPENGL_API)) return false;
+    // highest core version that is available, unless requested
+    const int versions[][2] = { { 4, 6 }, { 4, 5 }, { 4, 3 } };
+    for (const auto& version : versions) {
+        const EGLint attribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, parameters.gl_major > 0 ? parameters.gl_major : version[0],
+            EGL_CONTEXT_MINOR_VERSION, parameters.gl_minor > 0 ? parameters.gl_minor : version[1],
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_CONTEXT_OPENGL_DEBUG, parameters.gl_debug_context ? EGL_TRUE : EGL_FALSE,
+            EGL_NONE };
+        egl_context = eglCreateContext(egl_display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attribs);
+        if (egl_context != EGL_NO_CONTEXT) break;
+    }
+    if (egl_context == EGL_NO_CONTEXT) return false;
+    std::cout << "EGL: " << major << "." << minor << " " << eglQueryString(egl_display, EGL_VENDOR) << std::endl;
+    return eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, egl_context);
+}
+#endif
 
-    // some GL context settings
-    if (parameters.gl_major > 0)
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, parameters.gl_major);
-    if (parameters.gl_minor > 0)
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, parameters.gl_minor);
-    glfwWindowHint(GLFW_RESIZABLE, parameters.resizable);
-    glfwWindowHint(GLFW_VISIBLE, parameters.visible);
-    glfwWindowHint(GLFW_DECORATED, parameters.decorated);
-    glfwWindowHint(GLFW_FLOATING, parameters.floating);
-    glfwWindowHint(GLFW_MAXIMIZED, parameters.maximised);
-    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, parameters.gl_debug_context);
+// in ms, glfw is not initialized for surfaceless contexts
+static double time_ms() {
+    if (headless_context)
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    return glfwGetTime() * 1000;
+}
 
-    // create window and context
-    glfw_window = glfwCreateWindow(parameters.width, parameters.height, parameters.title.c_str(), 0, 0);
-    if (!glfw_window) {
-        glfwTerminate();
-        throw std::runtime_error("glfwCreateContext failed!");
+Context::Context() {
+    glfw_window = 0;
+#ifdef CPPGL_EGL
+    if (parameters.headless) {
+        headless_context = egl_make_surfaceless_context();
+        if (!headless_context)
+            std::cerr << "WARN: Context: no surfaceless EGL context available, using a hidden window." << std::endl;
     }
-    glfwMakeContextCurrent(glfw_window);
-    glfwSwapInterval(parameters.swap_interval);
+#endif
+    if (headless_context)
+        headless_resolution = glm::ivec2(parameters.width, parameters.height);
+    else
+        create_window();
 
     glewExperimental = GL_TRUE;
     const GLenum err = glewInit();
-    if (err != GLEW_OK) {
-        glfwDestroyWindow(glfw_window);
-        glfwTerminate();
+    // glew built for glx reports the missing glx display after loading the gl functions
+    if (err != GLEW_OK && !(headless_context && err == GLEW_ERROR_NO_GLX_DISPLAY)) {
+        if (glfw_window) glfwDestroyWindow(glfw_window);
+        if (!headless_context) glfwTerminate();
         throw std::runtime_error(std::string("GLEWInit failed: ") + (const char*)glewGetErrorString(err));
     }
 
     // output configuration
-    std::cout << "GLFW: " << glfwGetVersionString() << std::endl;
+    if (!headless_context) std::cout << "GLFW: " << glfwGetVersionString() << std::endl;
     std::cout << "OpenGL: " << glGetString(GL_VERSION) << ", " << glGetString(GL_RENDERER) << std::endl;
     std::cout << "GLSL: " << glGetString(GL_SHADING_LANGUAGE_VERSION) << std::endl;
 
@@ -135,25 +176,16 @@ Context::Context() {
     enable_strack_trace_on_crash();
     enable_gl_debug_output();
 
-    // setup user ptr
-    glfwSetWindowUserPointer(glfw_window, this);
-
-    // install callbacks
-    glfwSetKeyCallback(glfw_window, glfw_key_callback);
-    glfwSetCursorPosCallback(glfw_window, glfw_mouse_callback);
-    glfwSetMouseButtonCallback(glfw_window, glfw_mouse_button_callback);
-    glfwSetScrollCallback(glfw_window, glfw_mouse_scroll_callback);
-    glfwSetFramebufferSizeCallback(glfw_window, glfw_resize_callback);
-    glfwSetCharCallback(glfw_window, glfw_char_callback);
-
-    // set input mode
-    glfwSetInputMode(glfw_window, GLFW_STICKY_KEYS, 1);
-    glfwSetInputMode(glfw_window, GLFW_STICKY_MOUSE_BUTTONS, 1);
+    if (!headless_context)
+        install_window_callbacks();
 
     // init imgui
     ImGui::CreateContext();
     ImGui::StyleColorsDark();
-    ImGui_ImplGlfw_InitForOpenGL(glfw_window, false);
+    if (headless_context)
+        ImGui::GetIO().DisplaySize = ImVec2(float(headless_resolution.x), float(headless_resolution.y));
+    else
+        ImGui_ImplGlfw_InitForOpenGL(glfw_window, false);
     ImGui_ImplOpenGL3_Init("#version 130");
     // ImGui::GetIO().ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
     // load custom font?
@@ -166,7 +198,7 @@ Context::Context() {
                 parameters.font_ttf_filename.string().c_str(), float(parameters.font_size_pixels), &config);
     }
     ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
+    if (!headless_context) ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
 
     // set some sane GL defaults
@@ -177,7 +209,7 @@ Context::Context() {
     glClearDepth(1);
 
     // setup timer
-    last_t = curr_t = glfwGetTime();
+    last_t = curr_t = time_ms();
     cpu_timer = TimerQuery("CPU-time");
     frame_timer = TimerQuery("Frame-time");
     gpu_timer = TimerQueryGL("GPU-time");
@@ -190,8 +222,61 @@ Context::Context() {
     frag_count->begin();
 }
 
+void Context::create_window() {
+    if (!glfwInit())
+        throw std::runtime_error("glfwInit failed!");
+    glfwSetErrorCallback(glfw_error_func);
+
+    // some GL context settings
+    if (parameters.gl_major > 0)
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, parameters.gl_major);
+    if (parameters.gl_minor > 0)
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, parameters.gl_minor);
+    glfwWindowHint(GLFW_RESIZABLE, parameters.resizable);
+    glfwWindowHint(GLFW_VISIBLE, parameters.headless ? GLFW_FALSE : parameters.visible);
+    glfwWindowHint(GLFW_DECORATED, parameters.decorated);
+    glfwWindowHint(GLFW_FLOATING, parameters.floating);
+    glfwWindowHint(GLFW_MAXIMIZED, parameters.maximised);
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, parameters.gl_debug_context);
+
+    // create window and context
+    glfw_window = glfwCreateWindow(parameters.width, parameters.height, parameters.title.c_str(), 0, 0);
+    if (!glfw_window) {
+        glfwTerminate();
+        throw std::runtime_error("glfwCreateContext failed!");
+    }
+    glfwMakeContextCurrent(glfw_window);
+    glfwSwapInterval(parameters.swap_interval);
+}
+
+void Context::install_window_callbacks() {
+    // setup user ptr
+    glfwSetWindowUserPointer(glfw_window, this);
+
+    // install callbacks
+    glfwSetKeyCallback(glfw_window, glfw_key_callback);
+    glfwSetCursorPosCallback(glfw_window, glfw_mouse_callback);
+    glfwSetMouseButtonCallback(glfw_window, glfw_mouse_button_callback);
+    glfwSetScrollCallback(glfw_window, glfw_mouse_scroll_callback);
+    glfwSetFramebufferSizeCallback(glfw_window, glfw_resize_callback);
+    glfwSetCharCallback(glfw_window, glfw_char_callback);
+
+    // set input mode
+    glfwSetInputMode(glfw_window, GLFW_STICKY_KEYS, 1);
+    glfwSetInputMode(glfw_window, GLFW_STICKY_MOUSE_BUTTONS, 1);
+}
+
 Context::~Context() {
     ImGui_ImplOpenGL3_Shutdown();
+    if (headless_context) {
+        ImGui::DestroyContext();
+#ifdef CPPGL_EGL
+        eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(egl_display, egl_context);
+        eglTerminate(egl_display);
+#endif
+        return;
+    }
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
     glfwSetInputMode(glfw_window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
@@ -209,7 +294,9 @@ Context& Context::instance() {
     return ctx;
 }
 
-bool Context::running() { return !glfwWindowShouldClose(instance().glfw_window); }
+bool Context::running() { return headless_context || !glfwWindowShouldClose(instance().glfw_window); }
+
+bool Context::headless() { return headless_context; }
 
 void Context::swap_buffers() {
     if (show_gui) gui_draw();
@@ -219,7 +306,7 @@ void Context::swap_buffers() {
     instance().gpu_timer->end();
     instance().prim_count->end();
     instance().frag_count->end();
-    glfwSwapBuffers(instance().glfw_window);
+    if (!headless_context) glfwSwapBuffers(instance().glfw_window);
     instance().frame_timer->end();
     instance().frame_timer->begin();
     instance().cpu_timer->begin();
@@ -227,10 +314,12 @@ void Context::swap_buffers() {
     instance().prim_count->begin();
     instance().frag_count->begin();
     instance().last_t = instance().curr_t;
-    instance().curr_t = glfwGetTime() * 1000; // s to ms
-    glfwPollEvents();
+    instance().curr_t = time_ms();
     ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
+    if (!headless_context) {
+        glfwPollEvents();
+        ImGui_ImplGlfw_NewFrame();
+    }
     ImGui::NewFrame();
 }
 
@@ -304,11 +393,12 @@ void Context::screenshotCustomResolutionBinary(const fs::path& path, const glm::
     std::cout << path_str.c_str() << " written." << std::endl;
 }
 
-void Context::show() { glfwShowWindow(instance().glfw_window); }
+void Context::show() { if (!headless_context) glfwShowWindow(instance().glfw_window); }
 
-void Context::hide() { glfwHideWindow(instance().glfw_window); }
+void Context::hide() { if (!headless_context) glfwHideWindow(instance().glfw_window); }
 
 glm::ivec2 Context::resolution() {
+    if (headless_context) return headless_resolution;
     int w, h;
     glfwGetFramebufferSize(instance().glfw_window, &w, &h);
     return glm::ivec2(w, h);
@@ -322,25 +412,33 @@ void Context::resize(int w, int h) {
     int width = w;// - (w % 32);
     int height = h;// - (h % 32);
     std::cout << "\t[Context::resize( " << w << ", " << h << ")] Resize to (" << width << ", " << height  << ")" << std::endl;
-    glfwSetWindowSize(instance().glfw_window, width, height);
+    if (headless_context) {
+        // no resize event without window
+        headless_resolution = glm::ivec2(width, height);
+        ImGui::GetIO().DisplaySize = ImVec2(float(width), float(height));
+        if (user_resize_callback) user_resize_callback(width, height);
+    }
+    else
+        glfwSetWindowSize(instance().glfw_window, width, height);
     glViewport(0, 0, width, height);
 }
 
-void Context::set_title(const std::string& name) { glfwSetWindowTitle(instance().glfw_window, name.c_str()); }
+void Context::set_title(const std::string& name) { if (!headless_context) glfwSetWindowTitle(instance().glfw_window, name.c_str()); }
 
-void Context::set_swap_interval(uint32_t interval) { glfwSwapInterval(interval); }
+void Context::set_swap_interval(uint32_t interval) { if (!headless_context) glfwSwapInterval(interval); }
 
-void Context::capture_mouse(bool on) { glfwSetInputMode(instance().glfw_window, GLFW_CURSOR, on ? GLFW_CURSOR_DISABLED : GLFW_CURSOR_NORMAL); }
+void Context::capture_mouse(bool on) { if (!headless_context) glfwSetInputMode(instance().glfw_window, GLFW_CURSOR, on ? GLFW_CURSOR_DISABLED : GLFW_CURSOR_NORMAL); }
 
 glm::vec2 Context::mouse_pos() {
+    if (headless_context) return glm::vec2(0);
     double xpos, ypos;
     glfwGetCursorPos(instance().glfw_window, &xpos, &ypos);
     return glm::vec2(xpos, ypos);
 }
 
-bool Context::mouse_button_pressed(int button) { return glfwGetMouseButton(instance().glfw_window, button) == GLFW_PRESS; }
+bool Context::mouse_button_pressed(int button) { return !headless_context && glfwGetMouseButton(instance().glfw_window, button) == GLFW_PRESS; }
 
-bool Context::key_pressed(int key) { return glfwGetKey(instance().glfw_window, key) == GLFW_PRESS; }
+bool Context::key_pressed(int key) { return !headless_context && glfwGetKey(instance().glfw_window, key) == GLFW_PRESS; }
 
 void Context::set_keyboard_callback(void (*fn)(int key, int scancode, int action, int mods)) { user_keyboard_callback = fn; }
 
@@ -23,6 +23,7 @@ struct ContextParameters {
     uint32_t swap_interval = 1; // 0 = no vsync, 1 = 60fps, 2 = 30fps, etc
     fs::path font_ttf_filename;
     uint32_t font_size_pixels = 13;
+    bool headless = false; // no window, render into framebuffer objects only. surfaceless EGL context if available, hidden window otherwise
 };
 
 // Initialize and hold a GLFW/GL context + window.
@@ -30,6 +31,8 @@ class Context {
 private:
     Context();
     ~Context();
+    void create_window();
+    void install_window_callbacks();
 
 public:
     // initialize context (using given params)
@@ -40,8 +43,10 @@ public:
     Context& operator=(const Context&) = delete;
     Context& operator=(const Context&&) = delete;
 
-    // query if window should be closed (for use in main loop)
+    // query if window should be closed (for use in main loop), always true if headless
     static bool running();
+    // true if the context has no window (surfaceless), input queries return nothing then
+    static bool headless();
     // finish current frame
     static void swap_buffers();
     // get last frame's time in ms
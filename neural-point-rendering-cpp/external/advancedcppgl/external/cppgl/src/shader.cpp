@@ -122,6 +122,25 @@ static GLuint compile_shader(GLenum type, std::map<GLenum, fs::path>& source_fil
     return shader;
 }
 
+// locations of the active uniforms outside of uniform blocks, arrays also under their name without [0]
+static void query_uniform_locations(GLuint program, std::unordered_map<std::string, GLint>& locations) {
+    locations.clear();
+    GLint count = 0, max_length = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+    std::vector<char> buffer(std::max(max_length, 1));
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        glGetActiveUniformName(program, GLuint(i), GLsizei(buffer.size()), &length, buffer.data());
+        const std::string uniform_name(buffer.data(), length);
+        const GLint loc = glGetUniformLocation(program, uniform_name.c_str());
+        if (loc < 0) continue;
+        locations[uniform_name] = loc;
+        if (uniform_name.size() > 3 && uniform_name.compare(uniform_name.size() - 3, 3, "[0]") == 0)
+            locations[uniform_name.substr(0, uniform_name.size() - 3)] = loc;
+    }
+}
+
 void reload_modified_shaders() {
     for (auto& pair : Shader::map)
         pair.second->reload_if_modified();
@@ -130,6 +149,10 @@ void reload_modified_shaders() {
 // ----------------------------------------------------
 // ShaderImpl
 
+size_t ShaderImpl::uniform_calls = 0;
+size_t ShaderImpl::location_queries = 0;
+bool ShaderImpl::cache_locations = true;
+
 ShaderImpl::ShaderImpl(const std::string& name) : name(name), id(0) {}
 
 ShaderImpl::ShaderImpl(const std::string& name, const fs::path& compute_source) : name(name), id(0) {
@@ -160,6 +183,7 @@ void ShaderImpl::clear() {
     id = 0;
     source_files.clear();
     timestamps.clear();
+    uniform_locations.clear();
 }
 
 void ShaderImpl::bind() const { glUseProgram(id); }
@@ -259,10 +283,11 @@ void ShaderImpl::compile() {
         std::cerr << error_msg << std::endl;
         throw std::runtime_error("Shader compilation failed, see full output in std::cerr");
     }
-    // success, set new id
+    // success, set new id, the locations of the old program are invalid now
     if (glIsProgram(id))
         glDeleteProgram(id);
     id = program;
+    query_uniform_locations(id, uniform_locations);
 }
 
 void ShaderImpl::dispatch_compute(uint32_t w, uint32_t h, uint32_t d) const {
@@ -271,89 +296,102 @@ void ShaderImpl::dispatch_compute(uint32_t w, uint32_t h, uint32_t d) const {
     glDispatchCompute(int(ceil(w / float(size.x))), int(ceil(h / float(size.y))), int(ceil(d / float(size.z))));
 }
 
+GLint ShaderImpl::uniform_location(const std::string& name) const {
+    ++uniform_calls;
+    if (cache_locations) {
+        auto it = uniform_locations.find(name);
+        if (it != uniform_locations.end()) return it->second;
+    }
+    // array elements and names that are not active (-1) are queried once and cached as well
+    ++location_queries;
+    const GLint loc = glGetUniformLocation(id, name.c_str());
+    if (cache_locations) uniform_locations[name] = loc;
+    return loc;
+}
+
 void ShaderImpl::uniform(const std::string& name, int val) const {
-    int loc = glGetUniformLocation(id, name.c_str());
+    const GLint loc = uniform_location(name);
     glUniform1i(loc, val);
 }
 
 void ShaderImpl::uniform(const std::string& name, int *val, uint32_t count) const {
-    int loc = glGetUniformLocation(id, name.c_str());
+    const GLint loc = uniform_location(name);
     glUniform1iv(loc, count, val);
 }
 
 void ShaderImpl::uniform(const std::string& name, float val) const {
-    int loc = glGetUniformLocation(id, name.c_str());
+    const GLint loc = uniform_location(name);
     glUniform1f(loc, val);
 }
 
 void ShaderImpl::uniform(const std::string& name, float *val, uint32_t count) const {
-    int loc = glGetUniformLocation(id, name.c_str());
+    const GLint loc = uniform_location(name);
     glUniform1fv(loc, count, val);
 }
 
 void ShaderImpl::uniform(const std::string& name, const glm::vec2& val) const {
-    int loc = glGetUniformLocation(id, name.c_str());
+    const GLint loc = uniform_location(name);
     glUniform2f(loc, val.x, val.y);
 }
 
 void ShaderImpl::uniform(const std::string& name, const glm::vec3& val) const {
-    int loc = glGetUniformLocation(id, name.c_str());
+    const GLint loc = uniform_location(name);
     glUniform3f(loc, val.x, val.y, val.z);
 }
 
 void ShaderImpl::uniform(const std::string& name, const glm::vec4& val) const {
-    int loc = glGetUniformLocation(id, name.c_str());
+    const GLint loc = uniform_location(name);
     glUniform4f(loc, val.x, val.y, val.z, val.w);
 }
 
 void ShaderImpl::uniform(const std::string& name, const glm::ivec2& val) const {
-    int loc = glGetUniformLocation(id, name.c_str());
+    const GLint loc = uniform_location(name);
     glUniform2i(loc, val.x, val.y);
 }
 
 void ShaderImpl::uniform(const std::string& name, const glm::ivec3& val) const {
-    int loc = glGetUniformLocation(id, name.c_str());
+    const GLint loc = uniform_location(name);
     glUniform3i(loc, val.x, val.y, val.z);
 }
 
 void ShaderImpl::uniform(const std::string& name, const glm::ivec4& val) const {
-    int loc = glGetUniformLocation(id, name.c_str());
+    const GLint loc = uniform_location(name);
     glUniform4i(loc, val.x, val.y, val.z, val.w);
 }
 
 void ShaderImpl::uniform(const std::string& name, const glm::uvec2& val) const {
-    int loc = glGetUniformLocation(id, name.c_str());
+    const GLint loc = uniform_location(name);
     glUniform2ui(loc, val.x, val.y);
 }
 
 void ShaderImpl::uniform(const std::string& name, const glm::uvec3& val) const {
-    int loc = glGetUniformLocation(id, name.c_str());
+    const GLint loc = uniform_location(name);
     glUniform3ui(loc, val.x, val.y, val.z);
 }
 
 void ShaderImpl::uniform(const std::string& name, const glm::uvec4& val) const {
-    int loc = glGetUniformLocation(id, name.c_str());
+    const GLint loc = uniform_location(name);
     glUniform4ui(loc, val.x, val.y, val.z, val.w);
 }
 
 void ShaderImpl::uniform(const std::string& name, const glm::mat3& val) const {
-    int loc = glGetUniformLocation(id, name.c_str());
+    const GLint loc = uniform_location(name);
     glUniformMatrix3fv(loc, 1, GL_FALSE, glm::value_ptr(val));
 }
 
 void ShaderImpl::uniform(const std::string& name, const glm::mat4& val) const {
-    int loc = glGetUniformLocation(id, name.c_str());
+    const GLint loc = uniform_location(name);
     glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(val));
 }
 
 void ShaderImpl::uniform(const std::string& name, const Texture2D tex, uint32_t unit) const {
-    int loc = glGetUniformLocation(id, name.c_str());
+    const GLint loc = uniform_location(name);
     tex->bind(unit);
     glUniform1i(loc, unit);
 }
 
 void ShaderImpl::uniform(const std::string& name, const Texture3D& tex, uint32_t unit) const {
-    int loc = glGetUniformLocation(id, name.c_str());
+    const GLint loc = uniform_location(name);
     tex->bind(unit);
     glUniform1i(loc, unit);
 }
@@ -4,6 +4,7 @@
 #include <filesystem>
 namespace fs = std::filesystem;
 #include <map>
+#include <unordered_map>
 #include <memory>
 #include <vector>
 #include <GL/glew.h>
@@ -51,7 +52,8 @@ public:
     // compute shader dispatch (call with actual amount of threads, will internally divide by workgroup size)
     void dispatch_compute(uint32_t w, uint32_t h = 1, uint32_t d = 1) const;
 
-    // uniform upload handling
+    // uniform upload handling, the locations are resolved once per link
+    GLint uniform_location(const std::string& name) const;
     void uniform(const std::string& name, int val) const;
     void uniform(const std::string& name, int* val, uint32_t count) const;
     void uniform(const std::string& name, float val) const;
@@ -79,6 +81,14 @@ public:
     GLuint id;
     std::map<GLenum, fs::path> source_files;
     std::map<GLenum, fs::file_time_type> timestamps;
+    // locations of the active uniforms of the current program, refilled by compile()
+    mutable std::unordered_map<std::string, GLint> uniform_locations;
+
+    // statistics of all shaders: uniform uploads and glGetUniformLocation calls they needed
+    static size_t uniform_calls;
+    static size_t location_queries;
+    // query the location on every upload, as without the cache (for comparisons)
+    static bool cache_locations;
 };
 
 using Shader = NamedHandle<ShaderImpl>;
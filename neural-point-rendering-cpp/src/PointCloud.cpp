@@ -1,6 +1,7 @@
 #pragma once
 #include "PointCloud.h"
 #include <iostream>
+#include <algorithm>
 #include "../external/advancedcppgl/external/cppgl/src/platform.h"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -69,13 +70,37 @@ void PointCloudImpl::upload_gpu() {
     add_index_buffer(uint32_t(geometry->indices.size()), geometry->indices.data());
 }
 
-void PointCloudImpl::cull(const Shader& computeShader, vec3& cam_pos, vec3& cam_dir, vec3& cam_up, float cam_near, float cam_far, float cam_fov, float cam_aspect){
+bool PointCloudImpl::use_indirect_count = true;
+
+bool PointCloudImpl::indirect_count() {
+    return use_indirect_count && (GLEW_VERSION_4_6 || GLEW_ARB_indirect_parameters);
+}
+
+void PointCloudImpl::cull(const Shader& computeShader, vec3& cam_pos, vec3& cam_dir, vec3& cam_up, float cam_near, float cam_far, float cam_fov, float cam_aspect, bool compact, const OcclusionCuller* occlusion){
+    // occlusion counts of the previous cull, that one is done by now
+    if (occlusion_pending) {
+        GLuint counts[4];
+        glGetNamedBufferSubData(drawCountBuffer->id, 0, sizeof(counts), counts);
+        points_in_frustum = counts[1];
+        points_occluded = counts[2];
+        occlusion_pending = false;
+    }
     //bind the given shader
     computeShader->bind();
     //bind the command buffers
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, drawCommandBuffer->originalBuffer->id);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, drawCommandBuffer->frontBuffer->id);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, voxelBuffer->id);
+    if (compact || occlusion) {
+        const GLuint zero[4] = { 0, 0, 0, 0 };
+        glNamedBufferSubData(drawCountBuffer->id, 0, sizeof(zero), zero);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, drawCountBuffer->id);
+    }
+    computeShader->uniform("compact", compact);
+    if (occlusion)
+        occlusion->bind(computeShader);
+    else
+        computeShader->uniform("occlusion", false);
     //voxelBuffer->bind_base(0);
     computeShader->uniform("cam_pos", cam_pos);
     computeShader->uniform("cam_dir", cam_dir);
@@ -87,16 +112,47 @@ void PointCloudImpl::cull(const Shader& computeShader, vec3& cam_pos, vec3& cam_
     computeShader->uniform("voxel_count", int(bounding_structure.size()));
     // execute shader properly
     computeShader->dispatch_compute(bounding_structure.size(), 1, 1);
-    glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+    // the count is read as parameter of the draw or, without indirect count, back to the cpu
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | (compact || occlusion ? GL_BUFFER_UPDATE_BARRIER_BIT : 0));
     //unbind everything
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, 0);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, 0);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+    if (compact || occlusion) glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, 0);
+    if (occlusion) glBindTextureUnit(0, 0);
     //voxelBuffer->unbind_base(0);
     computeShader->unbind();
     // signal that culling took place, hence indirect rendering calls should be used
     //std::cerr << "called cull" << std::endl;
     culled = true;
+    compacted = compact;
+    draw_count = -1;
+    occlusion_pending = occlusion != nullptr;
+}
+
+void PointCloudImpl::cull_cpu(const vec3& cam_pos, const vec3& cam_dir, const vec3& cam_up, float cam_near, float cam_far, float cam_fov, float cam_aspect, bool compact, const OcclusionCuller* occlusion) {
+    auto& commands = drawCommandBuffer->cpu_shadow_buffer;
+    cpu_culler.cull(cam_pos, cam_dir, cam_up, cam_near, cam_far, cam_fov, cam_aspect, commands.data());
+    if (occlusion) {
+        points_in_frustum = cpu_culler.points_visible;
+        points_occluded = occlusion->cull_cpu(bounding_structure, commands.data());
+        occlusion_pending = false;
+    }
+    // the original commands stay in originalBuffer for the gpu culling
+    if (compact) {
+        // in the order of the voxels, like the uncompacted commands
+        compacted_commands.clear();
+        for (const auto& command : commands)
+            if (command.count > 0) compacted_commands.push_back(command);
+        glNamedBufferSubData(drawCommandBuffer->frontBuffer->id, 0, sizeof(DrawElementsIndirectCommand) * compacted_commands.size(), compacted_commands.data());
+        draw_count = int64_t(compacted_commands.size());
+    }
+    else {
+        glNamedBufferSubData(drawCommandBuffer->frontBuffer->id, 0, sizeof(DrawElementsIndirectCommand) * commands.size(), commands.data());
+        draw_count = -1;
+    }
+    culled = true;
+    compacted = compact;
 }
 
 void PointCloudImpl::bind(const Shader& shader) const {
@@ -110,7 +166,24 @@ void PointCloudImpl::draw() {
         if (ibo) {
             //std::cerr << "called draw with cull" << std::endl;
             drawCommandBuffer->frontBuffer->bind();
-            glMultiDrawElementsIndirect(primitive_type, GL_UNSIGNED_INT, 0, bounding_structure.size(), 0);
+            if (!compacted)
+                glMultiDrawElementsIndirect(primitive_type, GL_UNSIGNED_INT, 0, bounding_structure.size(), 0);
+            else if (draw_count < 0 && indirect_count()) {
+                // the count of the gpu culling stays on the gpu
+                glBindBuffer(GL_PARAMETER_BUFFER, drawCountBuffer->id);
+                if (GLEW_VERSION_4_6)
+                    glMultiDrawElementsIndirectCount(primitive_type, GL_UNSIGNED_INT, 0, 0, GLsizei(bounding_structure.size()), 0);
+                else
+                    glMultiDrawElementsIndirectCountARB(primitive_type, GL_UNSIGNED_INT, 0, 0, GLsizei(bounding_structure.size()), 0);
+                glBindBuffer(GL_PARAMETER_BUFFER, 0);
+            }
+            else {
+                // cpu culling knows the count, otherwise it is read back (waits for the culling)
+                GLuint count = GLuint(std::max<int64_t>(draw_count, 0));
+                if (draw_count < 0)
+                    glGetNamedBufferSubData(drawCountBuffer->id, 0, sizeof(GLuint), &count);
+                glMultiDrawElementsIndirect(primitive_type, GL_UNSIGNED_INT, 0, count, 0);
+            }
             drawCommandBuffer->frontBuffer->unbind();
         }
         else {
@@ -127,6 +200,13 @@ void PointCloudImpl::draw() {
     }
 }
 
+void PointCloudImpl::draw(const DIBO& commands, GLsizei count) {
+    if (!ibo || count <= 0) return;
+    commands->bind();
+    glMultiDrawElementsIndirect(primitive_type, GL_UNSIGNED_INT, 0, count, 0);
+    commands->unbind();
+}
+
 void PointCloudImpl::unbind() const {
     glBindVertexArray(0);
     if (material)
@@ -207,6 +287,11 @@ void PointCloudImpl::add_bounding_structure(std::vector<PointCloudVoxel> & bound
         drawCommandElements.push_back(newCommand);
     }
     drawCommandBuffer->addElements(drawCommandElements);
+    cpu_culler.build(this->bounding_structure);
+    if (!drawCountBuffer) {
+        drawCountBuffer = SSBO(name + "_drawCountBuffer");
+        drawCountBuffer->resize(4 * sizeof(GLuint));
+    }
     voxelBuffer = SSBO(name + "_voxelBuffer" );
     voxelBuffer->resize(sizeof(PointCloudVoxel)*this->bounding_structure.size());
     //voxelBuffer->bind();
@@ -14,6 +14,8 @@ namespace fs = std::filesystem;
 #include "../external/advancedcppgl/src/commandBuffer.h"
 
 #include "PointCloudData.h"
+#include "frustum_culler.h"
+#include "occlusion_culler.h"
 
 // ------------------------------------------
 // PointCloud
@@ -31,9 +33,13 @@ public:
     void upload_gpu(); // cpu -> gpu transfer
 
     // call in this order to draw
-    void cull(const Shader& computeShader, vec3& cam_pos, vec3& cam_dir, vec3& cam_up, float cam_near, float cam_far, float cam_fov, float cam_aspect);// optional to use culling. only use after add_bounding_structure
+    // compact: only the visible draw commands are written, densely, and draw() draws their amount instead of one command per voxel
+    // occlusion: voxels in the frustum are also tested against its depth pyramid (built for this frame), see OcclusionCuller
+    void cull(const Shader& computeShader, vec3& cam_pos, vec3& cam_dir, vec3& cam_up, float cam_near, float cam_far, float cam_fov, float cam_aspect, bool compact = false, const OcclusionCuller* occlusion = nullptr);// optional to use culling. only use after add_bounding_structure
+    void cull_cpu(const vec3& cam_pos, const vec3& cam_dir, const vec3& cam_up, float cam_near, float cam_far, float cam_fov, float cam_aspect, bool compact = false, const OcclusionCuller* occlusion = nullptr);// same as cull on the cpu, writes the commands into the shadow buffer of drawCommandBuffer
     void bind(const Shader& shader) const;
     void draw();
+    void draw(const DIBO& commands, GLsizei count); // draws the first count commands of the given buffer, e.g. the occluders of the depth pre-pass
     void unbind() const;
 
     // GL vertex and index buffer operations
@@ -57,6 +63,17 @@ public:
     DrawCommandBuffer drawCommandBuffer;
     SSBO voxelBuffer;
     std::vector<PointCloudVoxel> bounding_structure;
+    FrustumCuller cpu_culler; // hierarchy over bounding_structure for cull_cpu
+    bool compacted = false; // the front buffer holds only the visible commands of the last cull
+    int64_t draw_count = -1; // visible commands of a compacting cull_cpu, -1: the count is only in drawCountBuffer (gpu culling)
+    SSBO drawCountBuffer; // visible commands of a compacting cull (parameter buffer of glMultiDrawElementsIndirectCount), points in the frustum, occluded points and voxels
+    // points of the last culls with occlusion, the gpu counts are read at the next cull (without waiting for the current one)
+    size_t points_in_frustum = 0;
+    size_t points_occluded = 0;
+    bool occlusion_pending = false;
+    std::vector<DrawElementsIndirectCommand> compacted_commands;
+    static bool use_indirect_count; // false: always read the count back, e.g. to compare
+    static bool indirect_count(); // glMultiDrawElementsIndirectCount (gl 4.6 or ARB_indirect_parameters) is available and used
     // GPU data
     GLuint vao;
     IBO ibo;
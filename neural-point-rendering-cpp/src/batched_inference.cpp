@@ -0,0 +1,109 @@
+#include "batched_inference.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include <torch/cuda.h>
+#include <c10/cuda/CUDACachingAllocator.h>
+
+int BatchedInference::batch_size_from_budget(size_t budget_bytes, size_t bytes_per_pixel, glm::ivec2 resolution, int max_batch) {
+	size_t bytes_per_frame = std::max<size_t>(1, bytes_per_pixel) * size_t(std::max(1, resolution.x * resolution.y));
+	return std::clamp(int(budget_bytes / bytes_per_frame), 1, std::max(1, max_batch));
+}
+
+void BatchedInference::configure(int batch_size) {
+	if (filled > 0) return;
+	this->batch_size = supports_batches ? std::max(1, batch_size) : 1;
+	if (int(slots.size()) < this->batch_size) slots.resize(this->batch_size);
+}
+
+NetworkInputArena& BatchedInference::next(const std::string& tag) {
+	// a full batch is run and cleared right after its last slot was packed, packing into a queued slot would overwrite its frame
+	TORCH_CHECK(!full(), "[BatchedInference] all ", batch_size, " slots are filled, run() and clear() first.");
+	Slot& s = slots[filled++];
+	s.tag = tag;
+	return s.arena;
+}
+
+// (res0 - res3), (gt or features), (motion) of the first count slots, concatenated along the batch dimension
+std::vector<torch::jit::IValue> BatchedInference::stack(int count) {
+	auto concat = [&](auto get, int n) {
+		std::vector<torch::jit::IValue> group;
+		for (int i = 0; i < n; ++i) {
+			std::vector<torch::Tensor> parts;
+			for (int b = 0; b < count; ++b)
+				parts.push_back(get(slots[b].arena, i));
+			group.push_back(torch::cat(parts, 0));
+		}
+		return c10::ivalue::Tuple::create(group);
+	};
+	const NetworkInputArena& first = slots[0].arena;
+	std::vector<torch::jit::IValue> inputs;
+	inputs.push_back(concat([](NetworkInputArena& a, int i) { return a.resolutions[i]; }, 4));
+	inputs.push_back(concat([](NetworkInputArena& a, int i) { return a.groundtruth_inputs()[i]; }, int(first.groundtruth_inputs().size())));
+	inputs.push_back(concat([](NetworkInputArena& a, int i) { return a.motion[i]; }, int(first.motion.size())));
+	return inputs;
+}
+
+double BatchedInference::timed_forward(torch::jit::script::Module& network, const std::vector<torch::jit::IValue>& inputs, NetworkPrecision precision, torch::Device device, torch::Tensor* output) {
+	torch::NoGradGuard no_grad;
+	PrecisionGuard precision_guard(precision, device);
+	auto start = std::chrono::steady_clock::now();
+	torch::Tensor result = network.forward(inputs).toTensor();
+	if (device.is_cuda()) torch::cuda::synchronize();
+	if (output) *output = result;
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+torch::Tensor BatchedInference::run(torch::jit::script::Module& network, NetworkPrecision precision, torch::Device device) {
+	torch::Tensor output;
+	if (filled == 0) return output;
+	last.batch_size = filled;
+	const auto one_by_one = [&]() {
+		std::vector<torch::Tensor> outputs(filled);
+		last.forward_ms = 0.0;
+		for (int b = 0; b < filled; ++b)
+			last.forward_ms += timed_forward(network, slots[b].arena.inputs(), precision, device, &outputs[b]);
+		output = torch::cat(outputs, 0);
+	};
+	try {
+		last.forward_ms = timed_forward(network, stack(filled), precision, device, &output);
+	}
+	catch (const c10::OutOfMemoryError& e) {
+		if (filled == 1) throw;
+		// transient, the next batch is tried again
+		std::cerr << "[BatchedInference] WARNING: batched forward pass ran out of memory, running the slots one by one: " << e.what_without_backtrace() << std::endl;
+		output = torch::Tensor();
+		if (device.is_cuda()) c10::cuda::CUDACachingAllocator::emptyCache();
+		one_by_one();
+	}
+	catch (const c10::Error& e) {
+		if (filled == 1) throw;
+		// e.g. a batch size of one was baked into the trace
+		std::cerr << "[BatchedInference] WARNING: batched forward pass failed, running the slots one by one: " << e.what_without_backtrace() << std::endl;
+		supports_batches = false;
+		one_by_one();
+	}
+	last.frames_per_second = last.forward_ms > 0.0 ? 1000.0 * filled / last.forward_ms : 0.0;
+	return output;
+}
+
+void BatchedInference::benchmark(torch::jit::script::Module& network, NetworkPrecision precision, torch::Device device, int repeats) {
+	sweep.clear();
+	if (!supports_batches) return;
+	std::cout << "[BatchedInference] throughput vs batch size" << std::endl;
+	std::vector<int> sizes;
+	for (int b = 1; b < filled; b *= 2) sizes.push_back(b);
+	sizes.push_back(filled);
+	for (int b : sizes) {
+		std::vector<torch::jit::IValue> inputs = stack(b);
+		timed_forward(network, inputs, precision, device, nullptr); // the executor specializes on the first pass of a shape
+		Throughput t;
+		t.batch_size = b;
+		for (int r = 0; r < repeats; ++r)
+			t.forward_ms += timed_forward(network, inputs, precision, device, nullptr) / repeats;
+		t.frames_per_second = t.forward_ms > 0.0 ? 1000.0 * b / t.forward_ms : 0.0;
+		sweep.push_back(t);
+		std::cout << "\tbatch " << b << ": " << t.forward_ms << " ms, " << t.frames_per_second << " frames/s" << std::endl;
+	}
+}
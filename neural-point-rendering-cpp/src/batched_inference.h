@@ -0,0 +1,69 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <torch/script.h>
+
+#include "network_input.h"
+#include "network_precision.h"
+
+/*  Batched Inference: offline inference of several poses with a single forward pass
+	The inputs of B poses are packed into B slots (one arena each) over B rendered frames. Once the slots are full,
+	every input is concatenated along the batch dimension, the network runs once and the output is split per slot.
+	Only for offline rendering without temporal reuse, the poses must not depend on the output of each other (no taa).
+	Common usage:
+		per pose:
+			next(tag).pack_...(...)				tag identifies the pose, e.g. the file the output is written to
+			if (full() || last pose)
+				output = run(network, ...)			Bx3xHxW, then slot(b).arena.unpack_output(output[b], tex) per pose
+				clear()
+	Networks whose trace does not support other batch sizes fall back to one forward pass per slot.
+*/
+class BatchedInference {
+//structs
+public:
+	struct Slot {
+		NetworkInputArena arena;
+		std::string tag;
+	};
+	struct Throughput {
+		int batch_size = 0;
+		double forward_ms = 0.0;		// per forward pass of the whole batch
+		double frames_per_second = 0.0;
+	};
+
+//data
+public:
+	int batch_size = 1;
+	int filled = 0;						// slots packed since the last clear()
+	bool supports_batches = true;		// false after a batched forward pass failed (not for running out of memory)
+	Throughput last;					// of the last run()
+	std::vector<Throughput> sweep;		// of the last benchmark()
+
+//methods
+public:
+	// largest batch whose activations fit into the budget, at most max_batch
+	static int batch_size_from_budget(size_t budget_bytes, size_t bytes_per_pixel, glm::ivec2 resolution, int max_batch);
+
+	// (re-)configure the amount of slots, only while no slot is filled
+	void configure(int batch_size);
+	// arena of the next free slot, throws a c10::Error if the batch is full
+	NetworkInputArena& next(const std::string& tag);
+	bool full() const { return filled >= batch_size; }
+	bool empty() const { return filled == 0; }
+	Slot& slot(int b) { return slots[b]; }
+
+	// one forward pass over all filled slots. output of slot b is output[b]
+	torch::Tensor run(torch::jit::script::Module& network, NetworkPrecision precision, torch::Device device);
+	// forward passes with the first 1, 2, 4, ..., filled slots, results in sweep. call after run()
+	void benchmark(torch::jit::script::Module& network, NetworkPrecision precision, torch::Device device, int repeats = 3);
+	// release the slots for the next batch
+	void clear() { filled = 0; }
+
+private:
+	std::vector<torch::jit::IValue> stack(int count);
+	double timed_forward(torch::jit::script::Module& network, const std::vector<torch::jit::IValue>& inputs, NetworkPrecision precision, torch::Device device, torch::Tensor* output);
+
+	std::vector<Slot> slots;
+};
@@ -0,0 +1,157 @@
+#include "capture_shards.h"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+// zlib stream of the png writer (stb_image_write), allocated with malloc
+unsigned char* stbi_zlib_compress(unsigned char* data, int data_len, int* out_len, int quality);
+
+// ------------------------------------------
+// helper funcs
+
+static std::string json_escape(const std::string& s) {
+	std::string out;
+	for (char ch : s) {
+		if (ch == '"' || ch == '\\') out += '\\';
+		out += ch;
+	}
+	return out;
+}
+
+static std::string shard_path(const std::string& dir, int id) {
+	char name[32];
+	std::snprintf(name, sizeof(name), "/shard_%05d.inoshard", id);
+	return dir + name;
+}
+
+// ------------------------------------------
+// CaptureShards
+
+CaptureShards::~CaptureShards() {
+	close();
+}
+
+bool CaptureShards::open(const std::string& dir, size_t shard_bytes, bool compress) {
+	close();
+	std::lock_guard<std::mutex> lock(mutex);
+	std::error_code error;
+	std::filesystem::create_directories(dir, error);
+	this->dir = dir;
+	this->shard_bytes = shard_bytes;
+	this->compress = compress;
+	shard_id = -1;
+	entries_total = 0;
+	// continue after existing shards of an earlier capture instead of overwriting them
+	while (std::filesystem::exists(shard_path(dir, shard_id + 1)))
+		++shard_id;
+	return next_shard();
+}
+
+bool CaptureShards::is_open() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return shard.is_open();
+}
+
+bool CaptureShards::next_shard() {
+	finish_shard();
+	const std::string path = shard_path(dir, ++shard_id);
+	shard.open(path, std::ios::binary);
+	if (!shard.is_open()) {
+		std::cerr << "[CaptureShards] FATAL ERROR: failed to open filestream: " << path << "." << std::endl;
+		return false;
+	}
+	const uint32_t header[2] = { version, 0 };
+	shard.write("INOSHARD", 8);
+	shard.write(reinterpret_cast<const char*>(header), sizeof(header));
+	shard_size = 16;
+	return true;
+}
+
+void CaptureShards::finish_shard() {
+	if (!shard.is_open()) return;
+	std::ostringstream index;
+	index << "{\"entries\": [";
+	for (size_t i = 0; i < entries.size(); ++i) {
+		const Entry& e = entries[i];
+		index << (i ? ", " : "") << "{\"sample\": \"" << json_escape(e.sample) << "\", \"feature\": \"" << json_escape(e.feature)
+			<< "\", \"offset\": " << e.offset << ", \"bytes\": " << e.bytes << ", \"raw_bytes\": " << e.raw_bytes
+			<< ", \"shape\": [" << e.h << ", " << e.w << ", " << e.c << "], \"dtype\": \"" << (e.dtype == FLOAT32 ? "float32" : "uint8")
+			<< "\", \"compression\": \"" << (e.compressed ? "zlib" : "none") << "\"}";
+	}
+	index << "]}";
+	const std::string json = index.str();
+	const uint64_t footer[2] = { shard_size, json.size() };
+	shard.write(json.data(), json.size());
+	shard.write(reinterpret_cast<const char*>(footer), sizeof(footer));
+	shard.write("INOINDEX", 8);
+	shard.close();
+	entries.clear();
+}
+
+void CaptureShards::append(const std::string& sample, const std::string& feature, int w, int h, int c, DType dtype, const void* data) {
+	const uint64_t raw_bytes = uint64_t(w) * uint64_t(h) * c * (dtype == FLOAT32 ? sizeof(float) : 1);
+	// compress outside of the lock, the encoders run in parallel
+	unsigned char* compressed = nullptr;
+	int compressed_bytes = 0;
+	if (compress) {
+		compressed = stbi_zlib_compress((unsigned char*)data, int(raw_bytes), &compressed_bytes, 5);
+		if (compressed && uint64_t(compressed_bytes) >= raw_bytes) {
+			std::free(compressed);
+			compressed = nullptr;
+		}
+	}
+
+	const uint64_t bytes = compressed ? uint64_t(compressed_bytes) : raw_bytes;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!shard.is_open()) {
+		std::cerr << "[CaptureShards] WARNING: no open shard, dropping " << sample << "/" << feature << "." << std::endl;
+		std::free(compressed);
+		return;
+	}
+	if (!entries.empty() && shard_size + bytes > shard_bytes && !next_shard()) {
+		std::free(compressed);
+		return;
+	}
+	// pad to the alignment, numpy views of the mapped shard are aligned then
+	const uint64_t padding = (alignment - shard_size % alignment) % alignment;
+	static const char zeros[alignment] = {};
+	shard.write(zeros, padding);
+	shard_size += padding;
+
+	Entry e;
+	e.sample = sample;
+	e.feature = feature;
+	e.offset = shard_size;
+	e.raw_bytes = raw_bytes;
+	e.bytes = bytes;
+	e.w = w;
+	e.h = h;
+	e.c = c;
+	e.dtype = dtype;
+	e.compressed = compressed != nullptr;
+	shard.write(compressed ? reinterpret_cast<const char*>(compressed) : reinterpret_cast<const char*>(data), e.bytes);
+	shard_size += e.bytes;
+	std::free(compressed);
+	entries.push_back(e);
+	++entries_total;
+	if (!shard)
+		std::cerr << "[CaptureShards] WARNING: failed to write " << sample << "/" << feature << "." << std::endl;
+}
+
+void CaptureShards::close() {
+	std::lock_guard<std::mutex> lock(mutex);
+	finish_shard();
+}
+
+size_t CaptureShards::shard_count() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return size_t(shard_id + 1);
+}
+
+size_t CaptureShards::entry_count() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return entries_total;
+}
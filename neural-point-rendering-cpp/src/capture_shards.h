@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*  Capture Shards: packs the images of a captured training dataset into a few large shard files
+	Instead of one png per image and feature, every image is appended to the current shard as a raw HxWxC tensor
+	(top row first, like the pngs), optionally zlib compressed. A shard is closed once it exceeds shard_bytes.
+	Shard layout (little endian):
+		header:		"INOSHARD", uint32 version, uint32 0
+		records:	the tensors, each starting at a multiple of 64 bytes
+		index:		json {"entries": [{"sample", "feature", "offset", "bytes", "raw_bytes", "shape": [h, w, c], "dtype", "compression"}, ...]}
+		footer:		uint64 offset of the index, uint64 size of the index, "INOINDEX"
+	Uncompressed shards can be memory mapped and read without decoding, see sitof/utils/shard_reader.py of the training.
+	Common usage:
+		open(dir)
+		append(sample, feature, ...) from any thread, e.g. the encoders of the capture writer
+		close()						writes the index of the last shard, shards without index are ignored by the reader
+*/
+class CaptureShards {
+//structs
+public:
+	enum DType { UINT8, FLOAT32 };
+
+	struct Entry {
+		std::string sample;			// e.g. the image name
+		std::string feature;		// e.g. the folder the png would be written to
+		uint64_t offset = 0;
+		uint64_t bytes = 0;			// stored size
+		uint64_t raw_bytes = 0;		// size after decompression
+		int h = 0, w = 0, c = 0;
+		DType dtype = UINT8;
+		bool compressed = false;
+	};
+
+//data
+public:
+	static constexpr uint32_t version = 1;
+	static constexpr uint64_t alignment = 64;
+
+//methods
+public:
+	CaptureShards() {}
+	~CaptureShards();
+
+	// start a new set of shards in dir (shard_00000.inoshard, ...), closes the previous one
+	bool open(const std::string& dir, size_t shard_bytes = size_t(1024) << 20, bool compress = false);
+	bool is_open();
+	// thread safe. data is h x w x c, top row first
+	void append(const std::string& sample, const std::string& feature, int w, int h, int c, DType dtype, const void* data);
+	// writes the index of the current shard
+	void close();
+
+	size_t shard_count();
+	size_t entry_count();
+
+	CaptureShards(const CaptureShards&) = delete;
+	CaptureShards& operator=(const CaptureShards&) = delete;
+
+private:
+	// expect the mutex to be locked
+	bool next_shard();
+	void finish_shard();
+
+	std::mutex mutex;
+	std::string dir;
+	size_t shard_bytes = 0;
+	bool compress = false;
+	std::ofstream shard;
+	uint64_t shard_size = 0;		// bytes written to the current shard
+	int shard_id = -1;
+	std::vector<Entry> entries;		// of the current shard
+	size_t entries_total = 0;
+};
@@ -0,0 +1,311 @@
+#include "capture_writer.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "../external/advancedcppgl/external/cppgl/src/stb_image_write.h"
+
+// ------------------------------------------
+// helper funcs
+
+// channels of the saved image, as in the save functions of Texture2D
+static int format_channels(GLenum format) {
+	return format == GL_RGBA ? 4 : format == GL_RGB ? 3 : format == GL_RG ? 2 : 1;
+}
+
+static void free_download(CaptureWriter::Download& download) {
+	if (download.fence) glDeleteSync(download.fence);
+	download.fence = 0;
+	if (download.buffer) {
+		if (download.mapped) {
+			download.buffer->bind();
+			download.buffer->unmap();
+		}
+		PPBO::erase(download.buffer->name);
+		download.buffer = PPBO();
+	}
+	download.mapped = nullptr;
+}
+
+// ------------------------------------------
+// CaptureWriter
+
+CaptureWriter::CaptureWriter(int threads, size_t max_bytes) : max_bytes(max_bytes) {
+	stbi_flip_vertically_on_write(1);
+	start(threads);
+}
+
+CaptureWriter::~CaptureWriter() {
+	// pending downloads need the gl context, run() flushes them before it is destroyed
+	if (!pending.empty())
+		std::cerr << "[CaptureWriter] WARNING: " << pending.size() << " downloads were not flushed and are lost." << std::endl;
+	stop();
+}
+
+void CaptureWriter::start(int threads) {
+	if (threads <= 0) threads = std::max(1, int(std::thread::hardware_concurrency()) / 2);
+	running = true;
+	for (int i = 0; i < threads; ++i)
+		workers.emplace_back(&CaptureWriter::work, this);
+}
+
+// the workers drain the queue before they exit
+void CaptureWriter::stop() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		running = false;
+	}
+	cv_work.notify_all();
+	for (auto& worker : workers)
+		if (worker.joinable()) worker.join();
+	workers.clear();
+}
+
+void CaptureWriter::configure(int threads, size_t max_bytes) {
+	this->max_bytes = std::max<size_t>(1, max_bytes);
+	const int count = threads <= 0 ? std::max(1, int(std::thread::hardware_concurrency()) / 2) : threads;
+	if (count == int(workers.size())) return;
+	stop();
+	start(count);
+}
+
+void CaptureWriter::write(const Texture2D& tex, const std::string& path, Mode mode, int quality) {
+	write(tex, path, mode, quality, nullptr, "");
+}
+
+void CaptureWriter::write(const Texture2D& tex, CaptureShards& shards, const std::string& sample, const std::string& feature, Mode mode) {
+	write(tex, sample, mode, 0, &shards, feature);
+}
+
+void CaptureWriter::write(const Texture2D& tex, const std::string& path, Mode mode, int quality, CaptureShards* shards, const std::string& feature) {
+	const int c = format_channels(tex->format);
+	const GLenum type = mode == BINARY ? GL_FLOAT : GL_UNSIGNED_BYTE;
+	const size_t bytes = size_t(tex->w) * size_t(tex->h) * c * (mode == BINARY ? sizeof(float) : 1);
+
+	// backpressure: wait for older frames until this one fits (a single frame larger than the budget is allowed)
+	poll();
+	while (bytes_in_flight() > 0 && bytes_in_flight() + bytes > max_bytes) {
+		std::unique_lock<std::mutex> lock(mutex);
+		if (queued_bytes > 0) {
+			const size_t before = queued_bytes;
+			cv_done.wait(lock, [&] { return queued_bytes < before; });
+		}
+		else {
+			lock.unlock();
+			finish(pending.front(), true);
+			pending.pop_front();
+		}
+	}
+
+	// reuse the smallest idle buffer that is large enough
+	Download download;
+	auto best = pool.end();
+	for (auto it = pool.begin(); it != pool.end(); ++it)
+		if (it->buffer->size_bytes >= bytes && (best == pool.end() || it->buffer->size_bytes < best->buffer->size_bytes))
+			best = it;
+	if (best != pool.end()) {
+		download = *best;
+		pool.erase(best);
+	}
+	else {
+		// the download pattern changed, e.g. other resolution -> drop the old buffers
+		if (pool.size() > 8) {
+			for (auto& d : pool) free_download(d);
+			pool.clear();
+		}
+		const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		download.buffer = PPBO("capture_writer/pack_" + std::to_string(buffer_counter++));
+		download.buffer->bind();
+		glBufferStorage(GL_PIXEL_PACK_BUFFER, bytes, nullptr, flags | GL_CLIENT_STORAGE_BIT);
+		download.buffer->size_bytes = bytes;
+		download.mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, flags);
+		download.buffer->unbind();
+		if (!download.mapped) {
+			std::cerr << "[CaptureWriter] FATAL ERROR: failed to map pixel buffer, skipping " << path << "." << std::endl;
+			free_download(download);
+			return;
+		}
+	}
+	download.bytes = bytes;
+	download.w = tex->w;
+	download.h = tex->h;
+	download.c = c;
+	download.path = path;
+	download.mode = mode;
+	download.quality = quality;
+	download.shards = shards;
+	download.feature = feature;
+
+	// download into the pixel pack buffer, returns immediately. tightly packed rows, the alignment of the renderer is restored
+	GLint pack_alignment = 4;
+	glGetIntegerv(GL_PACK_ALIGNMENT, &pack_alignment);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	download.buffer->bind();
+	glGetTextureImage(tex->id, 0, tex->format, type, GLsizei(download.buffer->size_bytes), 0);
+	download.buffer->unbind();
+	glPixelStorei(GL_PACK_ALIGNMENT, pack_alignment);
+	download.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending_bytes += bytes;
+	}
+	pending.push_back(download);
+}
+
+bool CaptureWriter::finish(Download& download, bool wait) {
+	if (download.fence) {
+		GLenum res = glClientWaitSync(download.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+		if (res == GL_TIMEOUT_EXPIRED && !wait) return false;
+		while (res == GL_TIMEOUT_EXPIRED)
+			res = glClientWaitSync(download.fence, 0, 1000000); // 1ms
+		if (res == GL_WAIT_FAILED)
+			std::cerr << "[CaptureWriter] WARNING: waiting for the download of " << download.path << " failed." << std::endl;
+		glDeleteSync(download.fence);
+		download.fence = 0;
+	}
+
+	Job job;
+	job.pixels.resize(download.bytes);
+	std::memcpy(job.pixels.data(), download.mapped, download.bytes);
+	job.w = download.w;
+	job.h = download.h;
+	job.c = download.c;
+	job.path = download.path;
+	job.mode = download.mode;
+	job.quality = download.quality;
+	job.shards = download.shards;
+	job.feature = download.feature;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending_bytes -= download.bytes;
+		queued_bytes += download.bytes;
+		queue.push_back(std::move(job));
+	}
+	cv_work.notify_one();
+	pool.push_back(download);
+	return true;
+}
+
+void CaptureWriter::poll() {
+	// downloads finish in order, stop at the first one still in flight
+	while (!pending.empty() && finish(pending.front(), false))
+		pending.pop_front();
+}
+
+void CaptureWriter::flush() {
+	while (!pending.empty()) {
+		finish(pending.front(), true);
+		pending.pop_front();
+	}
+	std::unique_lock<std::mutex> lock(mutex);
+	cv_done.wait(lock, [&] { return queued_bytes == 0; });
+}
+
+void CaptureWriter::clear() {
+	flush();
+	for (auto& download : pool) free_download(download);
+	pool.clear();
+}
+
+int CaptureWriter::frames_in_flight() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return int(pending.size() + queue.size()) + encoding;
+}
+
+size_t CaptureWriter::bytes_in_flight() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return locked_bytes_in_flight();
+}
+
+size_t CaptureWriter::frames_written() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return written;
+}
+
+void CaptureWriter::work() {
+	while (true) {
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			cv_work.wait(lock, [&] { return !queue.empty() || !running; });
+			if (queue.empty()) return;
+			job = std::move(queue.front());
+			queue.pop_front();
+			++encoding;
+		}
+		const size_t bytes = job.pixels.size();
+		encode(job);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			--encoding;
+			queued_bytes -= bytes;
+			++written;
+		}
+		cv_done.notify_all();
+	}
+}
+
+// conversions of the save functions of Texture2D, the image is flipped by stb (or by hand for BINARY and shards)
+void CaptureWriter::encode(Job& job) {
+	const size_t pixel_count = size_t(job.w) * size_t(job.h);
+	// one channel targets (the compact r32f depth) as gray rgba, like the former rgba depth targets
+	if (job.mode != BINARY && job.c == 1) {
+		std::vector<uint8_t> rgba(pixel_count * 4, 255);
+		for (size_t i = 0; i < pixel_count; ++i)
+			rgba[i * 4] = rgba[i * 4 + 1] = rgba[i * 4 + 2] = job.pixels[i];
+		job.pixels.swap(rgba);
+		job.c = 4;
+	}
+	if (job.mode == PNG_RGB && job.c == 4)
+		for (size_t i = 0; i < pixel_count; ++i) job.pixels[i * 4 + 3] = 255;
+	if (job.mode == PNG_DEPTH_TO_BW && job.c == 4)
+		for (size_t i = 0; i < pixel_count; ++i)
+			job.pixels[i * 4] = job.pixels[i * 4 + 1] = job.pixels[i * 4 + 2] = job.pixels[i * 4 + 3];
+
+	// BINARY: the first three channels as floats with flipped rows
+	std::vector<float> reduced;
+	if (job.mode == BINARY) {
+		const float* pixels = reinterpret_cast<const float*>(job.pixels.data());
+		reduced.assign(pixel_count * 3, 0.f);
+		for (int row = 0; row < job.h; ++row)
+			for (int x = 0; x < job.w; ++x)
+				for (int j = 0; j < std::min(job.c, 3); ++j)
+					reduced[(size_t(job.h - 1 - row) * job.w + x) * 3 + j] = pixels[(size_t(row) * job.w + x) * job.c + j];
+	}
+
+	if (job.shards) {
+		if (job.mode == BINARY) {
+			job.shards->append(job.path, job.feature, job.w, job.h, 3, CaptureShards::FLOAT32, reduced.data());
+			return;
+		}
+		std::vector<uint8_t> flipped(job.pixels.size());
+		const size_t row_bytes = size_t(job.w) * job.c;
+		for (int row = 0; row < job.h; ++row)
+			std::memcpy(&flipped[size_t(job.h - 1 - row) * row_bytes], &job.pixels[size_t(row) * row_bytes], row_bytes);
+		job.shards->append(job.path, job.feature, job.w, job.h, job.c, CaptureShards::UINT8, flipped.data());
+		return;
+	}
+
+	bool ok = true;
+	if (job.mode == JPG)
+		ok = stbi_write_jpg(job.path.c_str(), job.w, job.h, job.c, job.pixels.data(), job.quality);
+	else if (job.mode == BINARY) {
+		std::string path = job.path;
+		if (std::filesystem::path(path).extension() != ".bin") {
+			std::cerr << "[CaptureWriter] WARNING: unknown extension, adding .bin: " << path << std::endl;
+			path += ".bin";
+		}
+		const int meta[5] = { job.w, job.h, 3, int(sizeof(float)), 0 };
+		std::ofstream out_stream(path, std::ios::binary);
+		out_stream.write(reinterpret_cast<const char*>(meta), sizeof(meta));
+		out_stream.write(reinterpret_cast<const char*>(reduced.data()), sizeof(float) * reduced.size());
+		ok = bool(out_stream);
+	}
+	else
+		ok = stbi_write_png(job.path.c_str(), job.w, job.h, job.c, job.pixels.data(), 0);
+	if (!ok)
+		std::cerr << "[CaptureWriter] WARNING: failed to write " << job.path << "." << std::endl;
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <cppgl.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "capture_shards.h"
+
+/*  Capture Writer: asynchronous replacement of the Texture2D save functions for captures
+	write() downloads the texture into a pixel pack buffer and returns immediately. Once the download finished
+	(checked by poll() every frame), the pixels are copied to the host and a pool of encoder threads converts
+	and writes them (png, jpg or the binary format of save_binary), so the render thread neither waits for the
+	readback nor for the compression.
+	Downloads and encodings in flight are bounded by max_bytes. If a write would exceed it, write() blocks until
+	enough older frames are on disk (backpressure), so a long capture never runs out of memory.
+	Common usage:
+		write(tex, path, CaptureWriter::PNG_RGB) instead of tex->save_png_rgb(path)
+		or write(tex, shards, sample, feature, mode) to pack the image into shards (see capture_shards.h)
+		per frame:
+			poll()
+		on exit, before the gl context is destroyed:
+			flush()							every queued frame is on disk afterwards
+	The encoders rely on the global vertical flip of stb_image_write staying enabled (as set by the save functions).
+*/
+class CaptureWriter {
+//structs
+public:
+	// mirror the save functions of Texture2D
+	enum Mode { PNG, PNG_RGB, PNG_DEPTH_TO_BW, JPG, BINARY };
+
+	struct Download {
+		PPBO buffer;
+		void* mapped = nullptr;		// persistently mapped pointer into the buffer
+		GLsync fence = 0;			// signaled when the download has finished
+		size_t bytes = 0;
+		int w = 0, h = 0, c = 0;
+		std::string path;
+		Mode mode = PNG;
+		int quality = 0;
+		CaptureShards* shards = nullptr;	// append to the shards instead of writing path, which is the sample name then
+		std::string feature;
+	};
+
+	struct Job {
+		std::vector<uint8_t> pixels;	// floats for BINARY
+		int w = 0, h = 0, c = 0;
+		std::string path;
+		Mode mode = PNG;
+		int quality = 0;
+		CaptureShards* shards = nullptr;
+		std::string feature;
+	};
+
+//methods
+public:
+	CaptureWriter(int threads = 0, size_t max_bytes = size_t(1024) << 20);
+	~CaptureWriter();
+
+	// restarts the encoder threads if their amount changed. threads <= 0: half of the hardware threads
+	void configure(int threads, size_t max_bytes);
+
+	// issue the download of tex, the file is written asynchronously. quality is only used for JPG
+	void write(const Texture2D& tex, const std::string& path, Mode mode, int quality = 90);
+	// same conversion, but the image is appended to the shards as sample/feature (JPG is stored like PNG)
+	void write(const Texture2D& tex, CaptureShards& shards, const std::string& sample, const std::string& feature, Mode mode);
+	// hand finished downloads to the encoders, never blocks
+	void poll();
+	// wait until every written frame is on disk
+	void flush();
+	// free the pixel buffers, e.g. on shutdown. flushes first
+	void clear();
+
+	int frames_in_flight();
+	size_t bytes_in_flight();
+	size_t frames_written();
+
+	CaptureWriter(const CaptureWriter&) = delete;
+	CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+private:
+	void write(const Texture2D& tex, const std::string& path, Mode mode, int quality, CaptureShards* shards, const std::string& feature);
+	void start(int threads);
+	void stop();
+	void work();
+	void encode(Job& job);
+	// copy the pixels of a finished download into a job and queue it. blocks on the fence if wait
+	bool finish(Download& download, bool wait);
+	// expects the mutex to be locked
+	size_t locked_bytes_in_flight() const { return pending_bytes + queued_bytes; }
+
+	size_t max_bytes;
+	std::deque<Download> pending;		// downloads in flight, oldest first (render thread only)
+	std::vector<Download> pool;			// idle pixel buffers (render thread only)
+	uint32_t buffer_counter = 0;		// used for unique buffer names
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable cv_work;
+	std::condition_variable cv_done;
+	std::deque<Job> queue;
+	size_t pending_bytes = 0;
+	size_t queued_bytes = 0;			// of the queued jobs and the jobs being encoded
+	int encoding = 0;
+	size_t written = 0;
+	bool running = false;
+};
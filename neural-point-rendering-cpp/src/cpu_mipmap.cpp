@@ -0,0 +1,137 @@
+#include "cpu_mipmap.h"
+#include <ATen/Parallel.h>
+#include <algorithm>
+#include <cstdint>
+
+// ------------------------------------------
+// helper funcs
+
+// channel planes of a 1xCxHxW float tensor with arbitrary strides
+struct MipPlanes {
+	float* data = nullptr;
+	int64_t sc = 0, sh = 0, sw = 0;
+	int c = 0, h = 0, w = 0;
+
+	float* row(int channel, int y) const { return data + channel * sc + y * sh; }
+};
+
+static MipPlanes mip_planes(const torch::Tensor& t) {
+	TORCH_CHECK(t.dim() == 4 && t.size(0) == 1 && t.scalar_type() == torch::kFloat32 && t.device().is_cpu(), "cpu_mipmap: expects 1xCxHxW float tensors on the cpu");
+	MipPlanes p;
+	p.data = t.data_ptr<float>();
+	p.sc = t.stride(1);
+	p.sh = t.stride(2);
+	p.sw = t.stride(3);
+	p.c = int(t.size(1));
+	p.h = int(t.size(2));
+	p.w = int(t.size(3));
+	return p;
+}
+
+// empty pixels have depth 0 in the depth color target, but are tested with the cleared depth buffer (1)
+static inline float mip_depth(float d) {
+	return d == 0.f ? 1.f : d;
+}
+
+// the candidate of the selection s, in the order of the shader: (0,0), (0,1), (1,0), (1,1) in gl coordinates
+static inline float mip_select(int s, float v0, float v1, float v2, float v3) {
+	const float a = s == 1 ? v1 : v0;
+	const float b = s == 3 ? v3 : v2;
+	return s < 2 ? a : b;
+}
+
+// one row of the low resolution. row_0/row_1: high rows of the gl offsets 0 and 1, sw: stride between pixels (1 for contiguous)
+template <bool contiguous>
+static void mip_row(const MipPlanes& high, const MipPlanes& low, int row_0, int row_1, int y,
+	const std::vector<MipPlanes>& motion_high, const std::vector<MipPlanes>& motion_low, bool motion_pixelwise,
+	std::vector<uint8_t>& sel, std::vector<float>& minimum) {
+	const int64_t sw = contiguous ? 1 : high.sw;
+	const int w = low.w;
+	const float* d_0 = high.row(3, row_0);
+	const float* d_1 = high.row(3, row_1);
+	for (int x = 0; x < w; ++x) {
+		const float d0 = mip_depth(d_0[2 * x * sw]);
+		const float d1 = mip_depth(d_1[2 * x * sw]);
+		const float d2 = mip_depth(d_0[(2 * x + 1) * sw]);
+		const float d3 = mip_depth(d_1[(2 * x + 1) * sw]);
+		// first minimum wins, like the strict comparison of the shader
+		int s = 0;
+		float m = d0;
+		s = d1 < m ? 1 : s; m = d1 < m ? d1 : m;
+		s = d2 < m ? 2 : s; m = d2 < m ? d2 : m;
+		s = d3 < m ? 3 : s; m = d3 < m ? d3 : m;
+		sel[x] = uint8_t(s);
+		minimum[x] = m;
+	}
+
+	const auto gather = [&](const MipPlanes& src, const MipPlanes& dst, int channel, int src_row_0, int src_row_1, float scale, bool offset) {
+		const int64_t ssw = contiguous ? 1 : src.sw;
+		const int64_t dsw = contiguous ? 1 : dst.sw;
+		const float* s_0 = src.row(channel, src_row_0);
+		const float* s_1 = src.row(channel, src_row_1);
+		float* out = dst.row(channel, y);
+		for (int x = 0; x < w; ++x) {
+			const int s = sel[x];
+			float v = mip_select(s, s_0[2 * x * ssw], s_1[2 * x * ssw], s_0[(2 * x + 1) * ssw], s_1[(2 * x + 1) * ssw]) * scale;
+			// mipmapMotion: offset of a quarter low resolution pixel towards the chosen high resolution pixel
+			if (offset) v += channel == 0 ? (s < 2 ? 0.25f : -0.25f) : ((s & 1) ? -0.25f : 0.25f);
+			out[x * dsw] = v;
+		}
+	};
+
+	for (int c = 0; c < 3; ++c)
+		gather(high, low, c, row_0, row_1, 1.f, false);
+	const int64_t dsw = contiguous ? 1 : low.sw;
+	float* depth = low.row(3, y);
+	for (int x = 0; x < w; ++x) depth[x * dsw] = minimum[x];
+
+	for (size_t i = 0; i < motion_low.size(); ++i) {
+		const MipPlanes& src = motion_high[i];
+		const MipPlanes& dst = motion_low[i];
+		for (int c = 0; c < dst.c; ++c) {
+			if (c < 2) gather(src, dst, c, row_0, row_1, motion_pixelwise ? 0.5f : 1.f, motion_pixelwise);
+			else if (c == 2) gather(src, dst, c, row_0, row_1, 1.f, false);
+			else {
+				// alpha of the motion targets
+				const int64_t msw = contiguous ? 1 : dst.sw;
+				float* out = dst.row(c, y);
+				for (int x = 0; x < w; ++x) out[x * msw] = 1.f;
+			}
+		}
+	}
+}
+
+// ------------------------------------------
+// cpu_mipmap
+
+void cpu_mipmap(const torch::Tensor& rgbd_high, const torch::Tensor& rgbd_low,
+	const std::vector<torch::Tensor>& motion_high, const std::vector<torch::Tensor>& motion_low, bool motion_pixelwise) {
+	const MipPlanes high = mip_planes(rgbd_high);
+	const MipPlanes low = mip_planes(rgbd_low);
+	TORCH_CHECK(high.c >= 4 && low.c >= 4 && 2 * low.w <= high.w && 2 * low.h <= high.h, "cpu_mipmap: levels do not match");
+	TORCH_CHECK(motion_high.size() == motion_low.size(), "cpu_mipmap: motion levels do not match");
+	std::vector<MipPlanes> m_high, m_low;
+	bool contiguous = high.sw == 1 && low.sw == 1;
+	for (size_t i = 0; i < motion_low.size(); ++i) {
+		m_high.push_back(mip_planes(motion_high[i]));
+		m_low.push_back(mip_planes(motion_low[i]));
+		TORCH_CHECK(m_high[i].h == high.h && m_high[i].w == high.w && m_low[i].h == low.h && m_low[i].w == low.w
+			&& m_high[i].c >= std::min(m_low[i].c, 3), "cpu_mipmap: motion does not match the levels");
+		contiguous = contiguous && m_high[i].sw == 1 && m_low[i].sw == 1;
+	}
+
+	at::parallel_for(0, low.h, 8, [&](int64_t begin, int64_t end) {
+		std::vector<uint8_t> sel(low.w);
+		std::vector<float> minimum(low.w);
+		for (int64_t y = begin; y < end; ++y) {
+			// rows are top first, the shader reads the gl rows 2 * gl_y and 2 * gl_y + 1
+			const int gl_y = low.h - 1 - int(y);
+			const int row_0 = high.h - 1 - 2 * gl_y;
+			const int row_1 = row_0 - 1;
+			if (contiguous)
+				mip_row<true>(high, low, row_0, row_1, int(y), m_high, m_low, motion_pixelwise, sel, minimum);
+			else
+				mip_row<false>(high, low, row_0, row_1, int(y), m_high, m_low, motion_pixelwise, sel, minimum);
+		}
+	});
+}
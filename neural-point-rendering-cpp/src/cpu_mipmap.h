@@ -0,0 +1,19 @@
+#pragma once
+#include <vector>
+
+#include <torch/script.h>
+
+/*  CPU Mip Map: the depth aware downsampling of mipmap.fs and mipmapMotion(TC).fs on host tensors
+	Every low resolution pixel takes the color (and motion vectors) of the closest of its 2x2 high resolution pixels,
+	the depth is the minimum. Ties go to the first pixel in the order of the shader, (0,0), (0,1), (1,0), (1,1) in gl coordinates.
+	The tensors are network inputs (1xCxHxW, top row first, contiguous or channels last), so the gl rows are mirrored here.
+	Empty pixels have depth 0 in the depth color target of the point rendering but 1 in its depth buffer, which the shaders test.
+	They are tested with depth 1 here as well, so the downsampled depth of four empty pixels is 1, as in the lower gl resolutions.
+	Motion vectors are copied (mipmapMotionTC) or halved and offset towards the chosen pixel (mipmapMotion, motion_pixelwise).
+	Rows are processed in parallel on the intra-op threads of torch, the loop over a row is vectorized by the compiler.
+	Common usage:
+		cpu_mipmap(level0, level1, motion0, motion1)	level: 1x4xHxW rgb + depth, motion: 1xCxHxW each, empty for no motion
+*/
+// low is written in place, its size determines the area used of high (2x the size of low, an odd row/column of high is ignored)
+void cpu_mipmap(const torch::Tensor& rgbd_high, const torch::Tensor& rgbd_low,
+	const std::vector<torch::Tensor>& motion_high = {}, const std::vector<torch::Tensor>& motion_low = {}, bool motion_pixelwise = false);
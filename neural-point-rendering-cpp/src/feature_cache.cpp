@@ -0,0 +1,49 @@
+#include "feature_cache.h"
+#include <iostream>
+
+static size_t tensor_bytes(const torch::Tensor& t) {
+	return size_t(t.numel()) * t.element_size();
+}
+
+bool FeatureCache::contains(int network, int view, glm::ivec2 resolution) const {
+	return entries.count({ network, view, resolution.x, resolution.y }) > 0;
+}
+
+torch::Tensor FeatureCache::get(int network, int view, glm::ivec2 resolution, const std::function<torch::Tensor()>& encode) {
+	Key key = { network, view, resolution.x, resolution.y };
+	auto it = entries.find(key);
+	if (it != entries.end()) {
+		++hits;
+		it->second.last_use = ++use_counter;
+		return it->second.features;
+	}
+	++misses;
+	torch::Tensor features = encode();
+	size_t required = tensor_bytes(features);
+	if (required > capacity_bytes) {
+		std::cerr << "[FeatureCache] WARNING: features of view " << view << " (" << (required >> 20) << " MB) exceed the capacity, not cached." << std::endl;
+		return features;
+	}
+	trim(required);
+	Entry entry;
+	entry.features = features;
+	entry.last_use = ++use_counter;
+	entries.emplace(key, std::move(entry));
+	bytes += required;
+	return features;
+}
+
+void FeatureCache::trim(size_t required_bytes) {
+	while (!entries.empty() && bytes + required_bytes > capacity_bytes) {
+		auto oldest = entries.begin();
+		for (auto e = entries.begin(); e != entries.end(); ++e)
+			if (e->second.last_use < oldest->second.last_use) oldest = e;
+		bytes -= tensor_bytes(oldest->second.features);
+		entries.erase(oldest);
+	}
+}
+
+void FeatureCache::clear() {
+	entries.clear();
+	bytes = 0;
+}
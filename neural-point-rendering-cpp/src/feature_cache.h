@@ -0,0 +1,44 @@
+#pragma once
+#include <array>
+#include <functional>
+#include <map>
+
+#include <glm/glm.hpp>
+#include <torch/script.h>
+
+/*  Feature Cache: encoded auxiliary images of networks that are split into encoder and decoder
+	The encoder output of a capture view only depends on the view's image, not on the novel view. It is computed once
+	and kept until the least recently used entries exceed the memory capacity.
+	Keyed by network, view id and resolution of the encoded image.
+	Common usage:
+		per frame and auxiliary view:
+			arena.set_features(i, get(network, view, res, [&] { return encoder(pack(view)); }))
+*/
+class FeatureCache {
+//data
+public:
+	size_t capacity_bytes = size_t(512) << 20;
+	size_t bytes = 0;			// memory of all cached features
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+
+//methods
+public:
+	bool contains(int network, int view, glm::ivec2 resolution) const;
+	// cached features, encode() is only called on a miss
+	torch::Tensor get(int network, int view, glm::ivec2 resolution, const std::function<torch::Tensor()>& encode);
+	size_t size() const { return entries.size(); }
+	// drop least recently used features until required_bytes more fit into the capacity
+	void trim(size_t required_bytes = 0);
+	void clear();
+
+private:
+	struct Entry {
+		torch::Tensor features;
+		uint64_t last_use = 0;
+	};
+	using Key = std::array<int, 4>;
+
+	std::map<Key, Entry> entries;
+	uint64_t use_counter = 0;
+};
@@ -0,0 +1,220 @@
+#include "frustum_culler.h"
+#include <ATen/Parallel.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+// ------------------------------------------
+// helper funcs
+
+using Planes = FrustumCuller::Planes;
+static constexpr int lanes = FrustumCuller::lanes;
+
+enum Classification { OUTSIDE, INSIDE, INTERSECTING };
+
+// the voxel spheres of a node against all planes: the extremes of the signed distance over the box of the centers,
+// widened by the largest (outside) or smallest (inside) radius
+static inline Classification classify(const FrustumCuller::Node& node, const Planes& p) {
+	int any_outside = 0, all_inside = 1;
+	for (int i = 0; i < lanes; ++i) {
+		const float x0 = p.nx[i] * node.center_min.x, x1 = p.nx[i] * node.center_max.x;
+		const float y0 = p.ny[i] * node.center_min.y, y1 = p.ny[i] * node.center_max.y;
+		const float z0 = p.nz[i] * node.center_min.z, z1 = p.nz[i] * node.center_max.z;
+		const float lo = std::min(x0, x1) + std::min(y0, y1) + std::min(z0, z1) - p.d[i];
+		const float hi = std::max(x0, x1) + std::max(y0, y1) + std::max(z0, z1) - p.d[i];
+		any_outside |= int(hi + node.radius_max < -p.margin[i]);
+		all_inside &= int(lo > p.margin[i] - node.radius_min);
+	}
+	return any_outside ? OUTSIDE : all_inside ? INSIDE : INTERSECTING;
+}
+
+// ------------------------------------------
+// FrustumCuller
+
+void FrustumCuller::clear() {
+	nodes.clear();
+	tasks.clear();
+	cx.clear();
+	cy.clear();
+	cz.clear();
+	radius.clear();
+	slot_voxel.clear();
+	slot_size.clear();
+	count = 0;
+}
+
+void FrustumCuller::build(const std::vector<PointCloudVoxel>& voxels) {
+	clear();
+	count = voxels.size();
+	if (voxels.empty()) return;
+	scale = 1.f;
+	for (const auto& v : voxels)
+		scale = std::max(scale, std::max(std::abs(v.center.x), std::max(std::abs(v.center.y), std::abs(v.center.z))) + v.radius);
+
+	std::vector<uint32_t> indices(voxels.size());
+	for (uint32_t i = 0; i < uint32_t(indices.size()); ++i) indices[i] = i;
+	nodes.reserve(2 * (voxels.size() / lanes + 1));
+	build_node(indices, 0, uint32_t(indices.size()), 0, voxels);
+}
+
+uint32_t FrustumCuller::build_node(std::vector<uint32_t>& indices, uint32_t first, uint32_t last, int depth, const std::vector<PointCloudVoxel>& voxels) {
+	const uint32_t index = uint32_t(nodes.size());
+	nodes.emplace_back();
+	Node node;
+	node.center_min = glm::vec3(std::numeric_limits<float>::max());
+	node.center_max = glm::vec3(-std::numeric_limits<float>::max());
+	node.radius_min = std::numeric_limits<float>::max();
+	node.radius_max = -std::numeric_limits<float>::max();
+	for (uint32_t i = first; i < last; ++i) {
+		const PointCloudVoxel& v = voxels[indices[i]];
+		node.center_min = glm::min(node.center_min, v.center);
+		node.center_max = glm::max(node.center_max, v.center);
+		node.radius_min = std::min(node.radius_min, v.radius);
+		node.radius_max = std::max(node.radius_max, v.radius);
+	}
+
+	const uint32_t n = last - first;
+	if (n <= uint32_t(lanes)) {
+		node.leaf = 1;
+		node.begin = uint32_t(slot_voxel.size());
+		node.end = node.begin + lanes;
+		for (int j = 0; j < lanes; ++j) {
+			const bool used = uint32_t(j) < n;
+			const PointCloudVoxel* v = used ? &voxels[indices[first + j]] : nullptr;
+			cx.push_back(used ? v->center.x : 0.f);
+			cy.push_back(used ? v->center.y : 0.f);
+			cz.push_back(used ? v->center.z : 0.f);
+			radius.push_back(used ? v->radius : -std::numeric_limits<float>::infinity());
+			slot_voxel.push_back(used ? indices[first + j] : no_voxel);
+			slot_size.push_back(used ? v->size : 0);
+		}
+		node.skip = index + 1;
+		if (depth <= task_depth) tasks.push_back(index);
+		nodes[index] = node;
+		return index;
+	}
+
+	// median of the centers along the longest axis, rounded up to full leaves
+	const glm::vec3 extent = node.center_max - node.center_min;
+	const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+	const uint32_t mid = first + (n / 2 + lanes - 1) / lanes * lanes;
+	std::nth_element(indices.begin() + first, indices.begin() + mid, indices.begin() + last,
+		[&](uint32_t a, uint32_t b) { return voxels[a].center[axis] < voxels[b].center[axis]; });
+
+	if (depth == task_depth) tasks.push_back(index);
+	const uint32_t left = build_node(indices, first, mid, depth + 1, voxels);
+	const uint32_t right = build_node(indices, mid, last, depth + 1, voxels);
+	node.begin = nodes[left].begin;
+	node.end = nodes[right].end;
+	node.skip = uint32_t(nodes.size());
+	nodes[index] = node;
+	return index;
+}
+
+Planes FrustumCuller::frustum_planes(const glm::vec3& cam_pos, const glm::vec3& cam_dir, const glm::vec3& cam_up, float cam_near, float cam_far,
+	float cam_fov, float cam_aspect, float scale) {
+	// same construction as computeFrustumCulling.glcs
+	const glm::vec3 dir = glm::normalize(cam_dir);
+	const glm::vec3 nc = cam_pos + dir * cam_near;
+	const glm::vec3 fc = cam_pos + dir * cam_far;
+	const float tang = std::tan(glm::radians(cam_fov) * 0.5f);
+	const float nh = cam_near * tang;
+	const float nw = nh * cam_aspect;
+	const float fh = cam_far * tang;
+	const float fw = fh * cam_aspect;
+	const glm::vec3 right = glm::normalize(glm::cross(cam_dir, cam_up));
+	const glm::vec3 up = glm::normalize(glm::cross(right, cam_dir));
+
+	const glm::vec3 ntl = nc + up * nh - right * nw;
+	const glm::vec3 ntr = nc + up * nh + right * nw;
+	const glm::vec3 nbl = nc - up * nh - right * nw;
+	const glm::vec3 nbr = nc - up * nh + right * nw;
+	const glm::vec3 ftl = fc + up * fh - right * fw;
+	const glm::vec3 ftr = fc + up * fh + right * fw;
+	const glm::vec3 fbl = fc - up * fh - right * fw;
+
+	const glm::vec3 normals[6] = { dir, -dir,
+		glm::normalize(glm::cross(ftr - ntr, nbr - ntr)),
+		glm::normalize(glm::cross(nbl - ntl, ftl - ntl)),
+		glm::normalize(glm::cross(ntl - ntr, ftr - ntr)),
+		glm::normalize(glm::cross(nbr - nbl, fbl - nbl)) };
+	const glm::vec3 points[6] = { nc, fc, cam_pos, cam_pos, cam_pos, cam_pos };
+
+	Planes planes;
+	for (int i = 0; i < lanes; ++i) {
+		if (i < 6) {
+			planes.nx[i] = normals[i].x;
+			planes.ny[i] = normals[i].y;
+			planes.nz[i] = normals[i].z;
+			planes.d[i] = glm::dot(points[i], normals[i]);
+			planes.margin[i] = 1e-5f * (scale + std::abs(planes.d[i]));
+		}
+		else {
+			// padding: every sphere is inside
+			planes.nx[i] = planes.ny[i] = planes.nz[i] = 0.f;
+			planes.d[i] = -1e30f;
+			planes.margin[i] = 0.f;
+		}
+	}
+	return planes;
+}
+
+void FrustumCuller::cull(const glm::vec3& cam_pos, const glm::vec3& cam_dir, const glm::vec3& cam_up, float cam_near, float cam_far,
+	float cam_fov, float cam_aspect, DrawElementsIndirectCommand* commands) {
+	const auto start = std::chrono::steady_clock::now();
+	const Planes planes = frustum_planes(cam_pos, cam_dir, cam_up, cam_near, cam_far, cam_fov, cam_aspect, scale);
+
+	std::vector<std::array<size_t, 4>> stats(tasks.size(), std::array<size_t, 4>{ 0, 0, 0, 0 });
+	at::parallel_for(0, int64_t(tasks.size()), 1, [&](int64_t begin, int64_t end) {
+		for (int64_t t = begin; t < end; ++t)
+			cull_subtree(tasks[t], planes, commands, stats[t].data());
+	});
+
+	voxels_visible = points_visible = nodes_tested = leaves_tested = 0;
+	for (const auto& s : stats) {
+		voxels_visible += s[0];
+		points_visible += s[1];
+		nodes_tested += s[2];
+		leaves_tested += s[3];
+	}
+	cull_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// depth first over the subtree, accepted and rejected nodes skip their children
+void FrustumCuller::cull_subtree(uint32_t root, const Planes& p, DrawElementsIndirectCommand* commands, size_t stats[4]) const {
+	const auto write = [&](uint32_t slot, bool visible) {
+		const uint32_t voxel = slot_voxel[slot];
+		if (voxel == no_voxel) return;
+		commands[voxel].count = visible ? slot_size[slot] : 0;
+		stats[0] += visible;
+		stats[1] += visible ? slot_size[slot] : 0;
+	};
+
+	const uint32_t root_end = nodes[root].skip;
+	for (uint32_t i = root; i < root_end;) {
+		const Node& node = nodes[i];
+		++stats[2];
+		const Classification c = classify(node, p);
+		if (c != INTERSECTING) {
+			for (uint32_t s = node.begin; s < node.end; ++s) write(s, c == INSIDE);
+			i = node.skip;
+			continue;
+		}
+		if (!node.leaf) {
+			++i;
+			continue;
+		}
+		// the sphere test of the shader for every voxel of the leaf
+		++stats[3];
+		const uint32_t b = node.begin;
+		int visible[lanes];
+		for (int j = 0; j < lanes; ++j) visible[j] = 1;
+		for (int k = 0; k < 6; ++k)
+			for (int j = 0; j < lanes; ++j)
+				visible[j] &= int(cx[b + j] * p.nx[k] + cy[b + j] * p.ny[k] + cz[b + j] * p.nz[k] - p.d[k] > -radius[b + j]);
+		for (int j = 0; j < lanes; ++j) write(b + j, visible[j]);
+		i = node.skip;
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "PointCloudData.h"
+#include "../external/advancedcppgl/src/shaderStructs.h"
+
+/*  Frustum Culler: cpu backend of computeFrustumCulling.glcs over a bounding volume hierarchy of the voxels
+	The voxels are sorted into a binary tree (median split along the longest axis) with leaves of up to `lanes` voxels.
+	Every node stores the bounding box of the voxel centers and the smallest and largest voxel radius.
+	Every frame:
+		1. the six planes are built once from the camera, with the same construction as the shader (frustum corners, cross products)
+		2. the subtrees of the task roots are traversed in parallel on the intra-op threads of torch. A node is tested against all
+		   planes at once: if the spheres of all its voxels are outside of one plane, the subtree is rejected, if they are inside of
+		   every plane, it is accepted, without visiting the voxels. Otherwise the children are tested
+		3. the voxels of partially visible leaves get the sphere test of the shader, dot(center, n) - dot(point, n) > -radius per plane
+	The node tests only decide with a margin of float rounding, everything closer to a plane is decided by the leaf test, so the
+	visible voxels are the ones of the shader (up to rounding of voxels touching a plane). The tests over planes and leaf voxels
+	are branchless loops of fixed width over structure of arrays data, vectorized by the compiler.
+	The draw commands are written in the order of the voxels, culled voxels get count 0 (like the shader).
+	Common usage:
+		on load: build(voxels)
+		per frame:
+			cull(cam_pos, cam_dir, cam_up, near, far, fov, aspect, commands)		commands: one per voxel, e.g. the cpu_shadow_buffer
+			upload commands into the indirect draw buffer
+*/
+class FrustumCuller {
+//structs
+public:
+	static constexpr int lanes = 8;			// voxels per leaf and planes per test (6 and two that accept everything)
+
+	struct Node {
+		glm::vec3 center_min = glm::vec3(0);
+		float radius_min = 0.f;
+		glm::vec3 center_max = glm::vec3(0);
+		float radius_max = 0.f;
+		uint32_t skip = 0;					// next node after the subtree (depth first order)
+		uint32_t begin = 0, end = 0;		// voxel slots of the subtree
+		uint32_t leaf = 0;
+	};
+
+	// planes in structure of arrays layout, dot(x, n) - d is the signed distance
+	struct Planes {
+		alignas(32) float nx[lanes];
+		alignas(32) float ny[lanes];
+		alignas(32) float nz[lanes];
+		alignas(32) float d[lanes];
+		alignas(32) float margin[lanes];	// rounding tolerance of the node tests
+	};
+
+//data
+public:
+	static constexpr uint32_t no_voxel = ~uint32_t(0);
+	static constexpr int task_depth = 6;	// subtrees at this depth are the parallel tasks
+
+	// statistics of the last cull()
+	size_t voxels_visible = 0;
+	size_t points_visible = 0;
+	size_t nodes_tested = 0;
+	size_t leaves_tested = 0;
+	float cull_ms = 0.f;
+
+//methods
+public:
+	void build(const std::vector<PointCloudVoxel>& voxels);
+	void clear();
+	bool empty() const { return nodes.empty(); }
+	size_t voxel_count() const { return count; }
+	size_t node_count() const { return nodes.size(); }
+
+	// commands has one entry per voxel, only the count is written
+	void cull(const glm::vec3& cam_pos, const glm::vec3& cam_dir, const glm::vec3& cam_up, float cam_near, float cam_far,
+		float cam_fov, float cam_aspect, DrawElementsIndirectCommand* commands);
+
+	// the planes of computeFrustumCulling.glcs (fov in degrees), order: near, far, right, left, top, bottom
+	static Planes frustum_planes(const glm::vec3& cam_pos, const glm::vec3& cam_dir, const glm::vec3& cam_up, float cam_near, float cam_far,
+		float cam_fov, float cam_aspect, float scale);
+
+private:
+	uint32_t build_node(std::vector<uint32_t>& indices, uint32_t first, uint32_t last, int depth, const std::vector<PointCloudVoxel>& voxels);
+	void cull_subtree(uint32_t root, const Planes& planes, DrawElementsIndirectCommand* commands, size_t stats[4]) const;
+
+	std::vector<Node> nodes;
+	std::vector<uint32_t> tasks;			// roots of the parallel subtrees
+	// voxel slots in tree order, leaves are padded to lanes slots (no_voxel, radius -inf)
+	std::vector<float> cx, cy, cz, radius;
+	std::vector<uint32_t> slot_voxel;
+	std::vector<uint32_t> slot_size;
+	size_t count = 0;
+	float scale = 1.f;						// largest coordinate of the voxels, for the rounding margin
+};
@@ -0,0 +1,76 @@
+#include "groundtruth_views.h"
+#include <algorithm>
+#include <cstring>
+
+// ------------------------------------------
+// helper funcs
+
+// the count is padded to the alignment of the view array (std430, 16 bytes of the mat4)
+static const size_t header_bytes = 16;
+
+static bool same_views(const std::vector<GroundtruthViews::View>& a, const std::vector<GroundtruthViews::View>& b) {
+	if (a.size() != b.size()) return false;
+	for (size_t i = 0; i < a.size(); ++i)
+		if (a[i].view != b[i].view || a[i].handle != b[i].handle || a[i].size != b[i].size) return false;
+	return true;
+}
+
+// ------------------------------------------
+// GroundtruthViews
+
+bool GroundtruthViews::bindless() {
+	return GLEW_ARB_bindless_texture;
+}
+
+uint64_t GroundtruthViews::handle(const Texture2D& tex) {
+	auto it = handles.find(tex->id);
+	if (it == handles.end())
+		it = handles.emplace(tex->id, BindlessTexture("groundtruth_views/" + tex->name, tex)).first;
+	return it->second->handle;
+}
+
+void GroundtruthViews::update(const std::vector<glm::mat4>& view_matrices, const std::vector<Texture2D>& textures) {
+	std::vector<View> next(view_matrices.size());
+	for (size_t i = 0; i < next.size(); ++i) {
+		next[i].view = view_matrices[i];
+		if (i >= textures.size() || !textures[i]) continue;
+		next[i].size = glm::ivec2(textures[i]->w, textures[i]->h);
+		if (bindless()) next[i].handle = handle(textures[i]);
+	}
+	// views that left the list, the commands already issued with their handles precede this in the command stream
+	for (auto it = handles.begin(); it != handles.end();) {
+		const bool current = std::any_of(textures.begin(), textures.end(), [&](const Texture2D& tex) { return tex && tex->id == it->first; });
+		if (current) {
+			++it;
+			continue;
+		}
+		BindlessTexture::erase(it->second->name);
+		it = handles.erase(it);
+	}
+	if (buffer && same_views(next, views)) return;
+	views.swap(next);
+
+	static_assert(sizeof(View) == 80, "View does not match the std430 layout of GroundtruthView");
+	const size_t bytes = header_bytes + views.size() * sizeof(View);
+	if (!buffer) buffer = SSBO("groundtruth_views");
+	if (buffer->size_bytes < bytes) buffer->resize(bytes);
+	std::vector<uint8_t> data(bytes, 0);
+	const int view_count = count();
+	std::memcpy(data.data(), &view_count, sizeof(int));
+	if (!views.empty()) std::memcpy(data.data() + header_bytes, views.data(), views.size() * sizeof(View));
+	buffer->upload_subdata(data.data(), 0, bytes);
+	++uploads;
+}
+
+void GroundtruthViews::bind() const {
+	if (buffer) buffer->bind_base(binding);
+}
+
+void GroundtruthViews::clear() {
+	for (auto& [id, tex] : handles)
+		BindlessTexture::erase(tex->name);
+	handles.clear();
+	views.clear();
+	if (buffer) SSBO::erase(buffer->name);
+	buffer = SSBO();
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cppgl.h>
+#include <bindlessTexture.h>
+#include <map>
+#include <vector>
+
+/*  Groundtruth Views: the nearest ground truth views of a frame for the shaders, in one shader storage buffer
+	Every view has its view matrix and the bindless handle of its texture, so shaders reach any number of views
+	through one buffer binding instead of a sampler (and a texture bind) per view. Only the handles of the current views
+	are resident, a view leaving the list makes its handle non resident (its texture keeps the handle for a later return).
+	The buffer is only rewritten if the list of views changed.
+	Without GL_ARB_bindless_texture the handles are 0, the view matrices are still available.
+	Common usage:
+		per frame:
+			update(views, textures)
+			bind()
+		in the shaders:
+			#include "__groundtruth_views_include.glsl"
+			groundtruth_views[i].view, groundtruth_texture(i) (needs bindless())
+*/
+class GroundtruthViews {
+//structs
+public:
+	// std430 layout of GroundtruthView in __groundtruth_views_include.glsl
+	struct View {
+		glm::mat4 view = glm::mat4(1);
+		uint64_t handle = 0;
+		glm::ivec2 size = glm::ivec2(0);
+	};
+
+//data
+public:
+	static const GLuint binding = 6;
+	size_t uploads = 0;				// buffer updates since the start
+
+//methods
+public:
+	static bool bindless();
+	int count() const { return int(views.size()); }
+	const View& operator[](int i) const { return views[i]; }
+
+	// views and textures of the same length, empty textures get no handle
+	void update(const std::vector<glm::mat4>& view_matrices, const std::vector<Texture2D>& textures);
+	void bind() const;
+	// makes the handles non resident and frees the buffer (needs the gl context)
+	void clear();
+
+private:
+	uint64_t handle(const Texture2D& tex);
+
+	std::vector<View> views;
+	SSBO buffer;
+	std::map<GLuint, BindlessTexture> handles;	// resident handles of the current views by texture id
+};
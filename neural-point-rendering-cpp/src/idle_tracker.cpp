@@ -0,0 +1,38 @@
+#include "idle_tracker.h"
+#include <imgui/imgui.h>
+
+bool IdleTracker::State::operator==(const State& other) const {
+	return view == other.view && proj == other.proj && resolution == other.resolution && lod == other.lod
+		&& network_id == other.network_id && display_mode == other.display_mode && render_info == other.render_info
+		&& timestamp_min == other.timestamp_min && timestamp_max == other.timestamp_max && nearest_views == other.nearest_views;
+}
+
+bool IdleTracker::update(const State& state, bool changed, int settle_frames) {
+	if (changed || !valid || state != last) {
+		last = state;
+		valid = true;
+		settle_frames_left = settle_frames;
+	}
+	else if (settle_frames_left > 0) {
+		--settle_frames_left;
+	}
+	else {
+		idle = true;
+		++idle_frames;
+		return false;
+	}
+	idle = false;
+	idle_frames = 0;
+	return true;
+}
+
+void IdleTracker::invalidate() {
+	valid = false;
+}
+
+bool IdleTracker::gui_interaction() {
+	const ImGuiIO& io = ImGui::GetIO();
+	if (ImGui::IsAnyItemActive()) return true;
+	if (io.WantCaptureMouse && (ImGui::IsMouseDown(0) || ImGui::IsMouseDown(1) || ImGui::IsMouseReleased(0) || ImGui::IsMouseReleased(1) || io.MouseWheel != 0.f)) return true;
+	return io.WantCaptureKeyboard && io.InputQueueCharacters.Size > 0;
+}
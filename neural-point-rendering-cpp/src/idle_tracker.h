@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+
+#include <glm/glm.hpp>
+
+/*  Idle Tracker: decides if a frame has to be rendered or if the last output can be presented again
+	Every frame a snapshot of everything the rendered image depends on (camera, resolution, lod, timestamp range,
+	network, display mode and nearest views) is compared to the snapshot of the last rendered frame.
+	Gui widgets are not compared one by one, any interaction with the gui or a key press counts as a change.
+	After a change, settle_frames more frames are rendered before the renderer goes idle: gui changes take effect
+	one frame after the interaction, the pipelined output lags one frame behind and taa needs some frames to converge.
+	Common usage:
+		per frame:
+			if (!tracker.update(state, forced, settle_frames))
+				present last output, skip rendering
+*/
+class IdleTracker {
+//structs
+public:
+	struct State {
+		glm::mat4 view = glm::mat4(1);
+		glm::mat4 proj = glm::mat4(1);
+		glm::ivec2 resolution = glm::ivec2(0);
+		int lod = -1;
+		int network_id = -1;
+		int display_mode = -1;
+		int render_info = -1;
+		int timestamp_min = 0;
+		int timestamp_max = 0;
+		std::vector<int> nearest_views;	// ids of the nearest capture views in order
+
+		bool operator==(const State& other) const;
+		bool operator!=(const State& other) const { return !(*this == other); }
+	};
+
+//data
+public:
+	bool idle = false;		// the current frame was skipped
+	int idle_frames = 0;	// consecutive skipped frames
+
+//methods
+public:
+	// true if the frame has to be rendered. changed forces a render, e.g. for captures, animations or input events
+	bool update(const State& state, bool changed, int settle_frames);
+	// the next frame is rendered
+	void invalidate();
+
+	// the gui is hovered and clicked, scrolled or typed in, or a widget is active
+	static bool gui_interaction();
+
+private:
+	State last;
+	bool valid = false;
+	int settle_frames_left = 0;
+};
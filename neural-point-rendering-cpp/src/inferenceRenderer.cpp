@@ -2,6 +2,16 @@
 
 #include "frustum.h"
 #include "camPathRenderer.h"
+#include "network_input.h"
+#include "inference_pipeline.h"
+#include "tiled_inference.h"
+#include "idle_tracker.h"
+#include "network_cache.h"
+#include "feature_cache.h"
+#include "network_loader.h"
+#include "resolution_controller.h"
+#include "batched_inference.h"
+#include "capture_writer.h"
 
 #include <ctime>
 #include <cmath>
@@ -10,10 +20,12 @@
 
 ////////////////////////////////////////////////////////////////
 // draw a texture to the fbo
-void ir_blit(const Texture2D tex) {
+// tc_scale: part of the texture that is used (render targets at a dynamic resolution)
+void ir_blit(const Texture2D tex, glm::vec2 tc_scale = glm::vec2(1)) {
 	static Shader blit_shader("blit", "shader/quad.vs", "shader/blit.fs");
 	blit_shader->bind();
 	blit_shader->uniform("tex", tex, 0);
+	blit_shader->uniform("tc_scale", tc_scale);
 	Quad::draw();
 	blit_shader->unbind();
 }
@@ -30,30 +42,62 @@ void ir_blit_depth(const Texture2D tex) {
 
 ////////////////////////////////////////////////////////////////
 // draw 4 textures to the fbo
-void ir_blit_multi(const Texture2D tex0, const Texture2D tex1, const Texture2D tex2, const Texture2D tex3) {
+void ir_blit_multi(const Texture2D tex0, const Texture2D tex1, const Texture2D tex2, const Texture2D tex3,
+	glm::vec2 tc_scale0 = glm::vec2(1), glm::vec2 tc_scale1 = glm::vec2(1), glm::vec2 tc_scale2 = glm::vec2(1), glm::vec2 tc_scale3 = glm::vec2(1)) {
 	static Shader blit_shader("blit_multi", "shader/quad.vs", "shader/blitmulti.fs");
 	blit_shader->bind();
 	blit_shader->uniform("tex0", tex0, 0);
 	blit_shader->uniform("tex1", tex1, 1);
 	blit_shader->uniform("tex2", tex2, 2);
 	blit_shader->uniform("tex3", tex3, 3);
+	blit_shader->uniform("tc_scale0", tc_scale0);
+	blit_shader->uniform("tc_scale1", tc_scale1);
+	blit_shader->uniform("tc_scale2", tc_scale2);
+	blit_shader->uniform("tc_scale3", tc_scale3);
 	Quad::draw();
 	blit_shader->unbind();
 }
 
 ////////////////////////////////////////////////////////////////
 // draw 4 depth textures to the fbo
-void ir_blit_multi_depth(const Texture2D tex0, const Texture2D tex1, const Texture2D tex2, const Texture2D tex3) {
+void ir_blit_multi_depth(const Texture2D tex0, const Texture2D tex1, const Texture2D tex2, const Texture2D tex3,
+	glm::vec2 tc_scale0 = glm::vec2(1), glm::vec2 tc_scale1 = glm::vec2(1), glm::vec2 tc_scale2 = glm::vec2(1), glm::vec2 tc_scale3 = glm::vec2(1)) {
 	static Shader blit_shader("blit_multi_depth", "shader/quad.vs", "shader/blitmultiDepth.fs");
 	blit_shader->bind();
 	blit_shader->uniform("tex0", tex0, 0);
 	blit_shader->uniform("tex1", tex1, 1);
 	blit_shader->uniform("tex2", tex2, 2);
 	blit_shader->uniform("tex3", tex3, 3);
+	blit_shader->uniform("tc_scale0", tc_scale0);
+	blit_shader->uniform("tc_scale1", tc_scale1);
+	blit_shader->uniform("tc_scale2", tc_scale2);
+	blit_shader->uniform("tc_scale3", tc_scale3);
 	Quad::draw();
 	blit_shader->unbind();
 }
 
+////////////////////////////////////////////////////////////////
+// draw count ground truth views of the bound GroundtruthViews from first on to the fbo, in a grid from the top left.
+// one draw per view, the bindless handles have to be uniform within a draw
+void ir_blit_groundtruth(int first, int count, bool depth = false) {
+	static Shader blit_shader("blit_groundtruth", "shader/quad.vs", "shader/blitGroundtruth.fs");
+	if (count < 1) return;
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	const int cols = int(std::ceil(std::sqrt(float(count))));
+	const int rows = (count + cols - 1) / cols;
+	const int w = viewport[2] / cols, h = viewport[3] / rows;
+	blit_shader->bind();
+	blit_shader->uniform("depth", int(depth));
+	for (int i = 0; i < count; ++i) {
+		glViewport(viewport[0] + (i % cols) * w, viewport[1] + viewport[3] - (i / cols + 1) * h, w, h);
+		blit_shader->uniform("view_index", first + i);
+		Quad::draw();
+	}
+	blit_shader->unbind();
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
 ////////////////////////////////////////////////////////////////
 // draw a color to the fbo
 void ir_blit(const vec3& col) {
@@ -94,22 +138,21 @@ void ir_mipmap(const Texture2D tex_rgb, const Texture2D tex_depth, glm::ivec2 re
 }
 
 ////////////////////////////////////////////////////////////////
-// draw a mipmapped variant of tex_rgb and tex_depth and 6 motion vectors to the fbo
-void ir_mipmap_with_motion(const Texture2D tex_rgb, const Texture2D tex_motion1, const Texture2D tex_motion2, const Texture2D tex_motion3, const Texture2D tex_motion4, const Texture2D tex_motion5, const Texture2D tex_motion6, const Texture2D tex_depth, glm::ivec2 res_high, glm::ivec2 res_low, bool motion_pixelwise) {
+// draw a mipmapped variant of tex_rgb and tex_depth and the first motion_count of the 6 motion vectors to the fbo
+void ir_mipmap_with_motion(const Texture2D tex_rgb, const Texture2D tex_motion1, const Texture2D tex_motion2, const Texture2D tex_motion3, const Texture2D tex_motion4, const Texture2D tex_motion5, const Texture2D tex_motion6, const Texture2D tex_depth, glm::ivec2 res_high, glm::ivec2 res_low, bool motion_pixelwise, int motion_count = 6) {
 	static Shader pixelwise_shader("mipmapMotionShader", "shader/quad.vs", "shader/mipmapMotion.fs");
 	static Shader tc_shader("mipmapMotionShaderTC", "shader/quad.vs", "shader/mipmapMotionTC.fs");
 	Shader& blit_shader = (motion_pixelwise) ? pixelwise_shader : tc_shader;
 	blit_shader->bind();
 	blit_shader->uniform("tex_rgb", tex_rgb, 0);
 	blit_shader->uniform("tex_depth", tex_depth, 1);
-	blit_shader->uniform("tex_motion_1", tex_motion1, 2);
-	blit_shader->uniform("tex_motion_2", tex_motion2, 3);
-	blit_shader->uniform("tex_motion_3", tex_motion3, 4);
-	blit_shader->uniform("tex_motion_4", tex_motion3, 4);
-	blit_shader->uniform("tex_motion_5", tex_motion3, 4);
-	blit_shader->uniform("tex_motion_6", tex_motion3, 4);
+	// targets after motion_count are not fetched and may be empty (unused render graph targets)
+	const Texture2D tex_motion[6] = { tex_motion1, tex_motion2, tex_motion3, tex_motion4, tex_motion5, tex_motion6 };
+	for (int i = 0; i < motion_count; ++i)
+		blit_shader->uniform("tex_motion_" + std::to_string(i + 1), tex_motion[i], 2 + i);
 	blit_shader->uniform("res_high", res_high);
 	blit_shader->uniform("res_low", res_low);
+	blit_shader->uniform("motion_count", motion_count);
 	Quad::draw();
 	blit_shader->unbind();
 }
@@ -161,6 +204,193 @@ void ir_render_cam_path(CamPathRenderer & pathRenderer, mat4& view, mat4& proj,
 
 
 
+////////////////////////////////////////////////////////////////
+// set res0 - res3 to the used sub-rectangles (at the origin) of the render targets. nothing is reallocated
+void ir_set_render_scale(float scale) {
+	gui_params_ir.render_scale = scale;
+	gui_params_ir.res0 = ResolutionController::resolution(gui_params_ir.res_max, scale, gui_params_ir.drs_alignment);
+	gui_params_ir.res1 = gui_params_ir.res0 / 2;
+	gui_params_ir.res2 = gui_params_ir.res0 / 4;
+	gui_params_ir.res3 = gui_params_ir.res0 / 8;
+}
+
+////////////////////////////////////////////////////////////////
+// capture by index collects the poses into batches, the neural images are written when a batch is inferred
+bool ir_capture_batched() {
+	return gui_params_ir.batched_capture && gui_params_ir.captureByIndex && !gui_params_ir.use_taa && !gui_params_ir.pipelined_inference;
+}
+
+////////////////////////////////////////////////////////////////
+// only the network output is presented, none of the render targets
+bool ir_shows_network_output_only() {
+	return gui_params_ir.displayMode == 0 && gui_params_ir.currentRenderInfo == 17;
+}
+
+////////////////////////////////////////////////////////////////
+// used resolution of fbo_res<level>
+glm::ivec2 ir_level_resolution(int level) {
+	switch (level) {
+	case 1: return gui_params_ir.res1;
+	case 2: return gui_params_ir.res2;
+	case 3: return gui_params_ir.res3;
+	default: return gui_params_ir.res0;
+	}
+}
+
+////////////////////////////////////////////////////////////////
+// motion targets that are rendered: all six for the displays, otherwise the views of the network (and of a running capture)
+int ir_motion_target_count() {
+	if (!ir_shows_network_output_only()) return 6;
+	int count = gui_params_ir.network_groundtruth_amount.empty() ? 6 : gui_params_ir.network_groundtruth_amount[gui_params_ir.network_id];
+	if (gui_params_ir.capturing || gui_params_ir.startCapturing)
+		count = std::max(count, gui_params_ir.captureGroundtruthAmount);
+	return glm::clamp(count, 1, 6);
+}
+
+////////////////////////////////////////////////////////////////
+// last mip level with motion vectors: the level the network reads them from, all levels for the displays
+int ir_motion_level() {
+	if (!ir_shows_network_output_only() || gui_params_ir.network_feature_extraction_depth.empty()) return 3;
+	return glm::clamp(gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id], 0, 3);
+}
+
+////////////////////////////////////////////////////////////////
+// restrict the draw buffers of the bound fbo to the targets before first_motion and motion_count motion targets
+// bind() enables every attachment again, so this is called after each bind
+void ir_draw_buffers(const Framebuffer& fbo, int first_motion, int motion_count) {
+	glDrawBuffers(GLsizei(std::min(first_motion + motion_count, int(fbo->color_targets.size()))), fbo->color_targets.data());
+}
+
+////////////////////////////////////////////////////////////////
+// depth pre-pass of the nearest voxels in the frustum for the occlusion culling, with the bound point shader and its uniforms
+// returns the culler for ir_cull with the pyramids of this frame, nullptr without occlusion culling
+const OcclusionCuller* ir_occlusion_prepass(PointCloud pc, OcclusionCuller& occlusion, const mat4& view_proj, float aspect) {
+	if (!gui_params_ir.enableCulling || !gui_params_ir.occlusion_culling || pc->bounding_structure.empty()) return nullptr;
+	Camera cam = current_camera();
+	occlusion.occluder_voxels = gui_params_ir.occluder_voxels;
+	occlusion.select(pc->cpu_culler, pc->bounding_structure, cam->pos, cam->dir, cam->up, cam->near, cam->far, cam->fov_degree, aspect);
+	occlusion.begin_prepass(gui_params_ir.res0, view_proj, std::max(1, gui_params_ir.pointSizeGL));
+	pc->draw(occlusion.occluder_commands(), occlusion.occluder_count());
+	occlusion.end_prepass();
+	if (!gui_params_ir.cpu_culling || gui_params_ir.culling_compare)
+		occlusion.build(Shader::find("hizBuild"));
+	if (gui_params_ir.cpu_culling || gui_params_ir.culling_compare)
+		occlusion.build_cpu();
+	return &occlusion;
+}
+
+////////////////////////////////////////////////////////////////
+// frustum culling of a point cloud for the next draw(), with the compute shader or on the cpu (FrustumCuller)
+// with culling_compare in the main pass, both run and the voxels they decide differently are counted before the chosen one runs again
+// occlusion: the voxels in the frustum are also tested against the pyramid of ir_occlusion_prepass
+void ir_cull(PointCloud pc, const Shader& computeShader, float aspect, const OcclusionCuller* occlusion = nullptr, bool main_pass = false) {
+	if (!gui_params_ir.enableCulling || pc->bounding_structure.empty()) return;
+	Camera cam = current_camera();
+	// the motion only pass culls without occlusion, only the main pass compares and resets the request
+	if (gui_params_ir.culling_compare && main_pass) {
+		pc->cull_cpu(cam->pos, cam->dir, cam->up, cam->near, cam->far, cam->fov_degree, aspect, false, occlusion);
+		pc->cull(computeShader, cam->pos, cam->dir, cam->up, cam->near, cam->far, cam->fov_degree, aspect, false, occlusion);
+		const auto& cpu_commands = pc->drawCommandBuffer->cpu_shadow_buffer;
+		std::vector<DrawElementsIndirectCommand> gpu_commands(cpu_commands.size());
+		glGetNamedBufferSubData(pc->drawCommandBuffer->frontBuffer->id, 0, sizeof(DrawElementsIndirectCommand) * gpu_commands.size(), gpu_commands.data());
+		int differing = 0;
+		for (size_t i = 0; i < gpu_commands.size(); ++i)
+			differing += int(gpu_commands[i].count != cpu_commands[i].count);
+		gui_params_ir.culling_compare_info = ivec2(differing, int(gpu_commands.size()));
+		std::cout << "[InferenceRenderer] frustum culling: " << differing << " of " << gpu_commands.size() << " voxels differ between cpu and gpu" << std::endl;
+		gui_params_ir.culling_compare = false;
+	}
+	const bool compact = gui_params_ir.compact_draw_commands;
+	if (gui_params_ir.cpu_culling) {
+		pc->cull_cpu(cam->pos, cam->dir, cam->up, cam->near, cam->far, cam->fov_degree, aspect, compact, occlusion);
+		const FrustumCuller& culler = pc->cpu_culler;
+		gui_params_ir.culling_info = vec4(culler.cull_ms, float(culler.voxels_visible), float(culler.voxel_count()), float(culler.nodes_tested));
+	}
+	else
+		pc->cull(computeShader, cam->pos, cam->dir, cam->up, cam->near, cam->far, cam->fov_degree, aspect, compact, occlusion);
+	// the gpu counts are the ones of the previous frame
+	if (occlusion)
+		gui_params_ir.occlusion_info = vec4(float(pc->points_in_frustum), float(pc->points_occluded),
+			float(pc->points_in_frustum - std::min(pc->points_occluded, pc->points_in_frustum)), float(occlusion->occluder_points));
+}
+
+////////////////////////////////////////////////////////////////
+// scale the used part of the output and the taa history from res_from to res_to, scratch is overwritten later in the frame
+void ir_rescale_output(Framebuffer fbo, Framebuffer scratch, glm::ivec2 res_from, glm::ivec2 res_to) {
+	// color and depth attachment, the same fbo can not be source and target of an overlapping blit
+	// both blits read and write only this attachment, the other draw buffers of fbo and scratch are left untouched
+	for (GLenum attachment : { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 }) {
+		glNamedFramebufferReadBuffer(fbo->id, attachment);
+		glNamedFramebufferDrawBuffer(scratch->id, attachment);
+		glBlitNamedFramebuffer(fbo->id, scratch->id, 0, 0, res_from.x, res_from.y, 0, 0, res_to.x, res_to.y, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+		glNamedFramebufferReadBuffer(scratch->id, attachment);
+		glNamedFramebufferDrawBuffer(fbo->id, attachment);
+		glBlitNamedFramebuffer(scratch->id, fbo->id, 0, 0, res_to.x, res_to.y, 0, 0, res_to.x, res_to.y, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	}
+	// restore the draw buffers of all attachments (bind() sets them as well)
+	glNamedFramebufferDrawBuffers(fbo->id, GLsizei(fbo->color_targets.size()), fbo->color_targets.data());
+	glNamedFramebufferDrawBuffers(scratch->id, GLsizei(scratch->color_targets.size()), scratch->color_targets.data());
+	glNamedFramebufferReadBuffer(fbo->id, GL_COLOR_ATTACHMENT0);
+	glNamedFramebufferReadBuffer(scratch->id, GL_COLOR_ATTACHMENT0);
+}
+
+////////////////////////////////////////////////////////////////
+// upload a target of the software rasterizer into the lower left res part of tex (rgba or depth floats, bottom row first)
+// compact targets (r, rg) keep the channels they have, gl drops the others
+void ir_upload(const Texture2D tex, glm::ivec2 res, const void* data) {
+	const GLenum format = tex->format == GL_DEPTH_COMPONENT ? GL_DEPTH_COMPONENT : GL_RGBA;
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTextureSubImage2D(tex->id, 0, 0, 0, res.x, res.y, format, GL_FLOAT, data);
+}
+
+////////////////////////////////////////////////////////////////
+// compact render targets of fbo_res0 - fbo_res3, sampled like the former rgba32f targets by swizzling
+// depth color: r32f, sampled as (d, d, d, 1)
+Texture2D ir_depth_target(const std::string& name, glm::ivec2 res) {
+	Texture2D tex = Texture2D(name, res.x, res.y, GL_R32F, GL_RED, GL_FLOAT);
+	const GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+	glTextureParameteriv(tex->id, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+	return tex;
+}
+
+// motion: ndc position in the old view as rg32f (or rg16f), sampled as (x, y, 1, 1). the third channel of the network input
+// (1 where a point was rendered) is restored from the depth when packing (NetworkInputArena) or capturing (ir_expand_motion)
+Texture2D ir_motion_target(const std::string& name, glm::ivec2 res, bool half) {
+	Texture2D tex = Texture2D(name, res.x, res.y, half ? GL_RG16F : GL_RG32F, GL_RG, half ? GL_HALF_FLOAT : GL_FLOAT);
+	const GLint swizzle[4] = { GL_RED, GL_GREEN, GL_ONE, GL_ONE };
+	glTextureParameteriv(tex->id, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+	return tex;
+}
+
+////////////////////////////////////////////////////////////////
+// expand a compact motion target to the rgba layout of the captures (x, y, rendered, 1), returns the scratch target
+// the whole texture is expanded, like the captures write the whole render targets
+Texture2D ir_expand_motion(const Texture2D tex_motion, const Texture2D tex_depth, bool pre_init) {
+	static Shader expand_shader("expandMotion", "shader/quad.vs", "shader/expandMotion.fs");
+	Framebuffer fbo = Framebuffer::find("fbo_capture_motion");
+	fbo->bind();
+	glViewport(0, 0, tex_motion->w, tex_motion->h);
+	expand_shader->bind();
+	expand_shader->uniform("tex_motion", tex_motion, 0);
+	expand_shader->uniform("tex_depth", tex_depth, 1);
+	expand_shader->uniform("pre_init", pre_init);
+	Quad::draw();
+	expand_shader->unbind();
+	fbo->unbind();
+	return fbo->color_textures[0];
+}
+
+////////////////////////////////////////////////////////////////
+// FramebufferImpl::resize for fbos with render graph slots: unused slots are empty, the attached transients are resized
+// in place, so the render graph keeps them if their target is resized the same way
+void ir_resize_fbo(Framebuffer fbo, int w, int h) {
+	fbo->w = w;
+	fbo->h = h;
+	if (fbo->depth_texture) fbo->depth_texture->resize(w, h);
+	for (auto& tex : fbo->color_textures)
+		if (tex) tex->resize(w, h);
+}
+
 ////////////////////////////////////////////////////////////////
 // callback function resize -- called on window resize
 // does not use the values at all. size is specified by the framebuffer size on startup + the resolution modifier
@@ -175,17 +405,17 @@ void ir_resize_callback(int w, int h) {
     int nw = gui_params_ir.initial_resolution_default.x * mod;
     int nh = gui_params_ir.initial_resolution_default.y * mod;
 	//---------------------------------------------------------------
-	// set resolution for all fbos of different resolution
-	gui_params_ir.res0 = glm::ivec2(nw  , nh  );
-	gui_params_ir.res1 = glm::ivec2(nw/2, nh/2);
-	gui_params_ir.res2 = glm::ivec2(nw/4, nh/4);
-	gui_params_ir.res3 = glm::ivec2(nw/8, nh/8);
+	// allocate all fbos of different resolution at full scale, the current scale only uses a part of them
+	gui_params_ir.res_max = glm::ivec2(nw, nh);
 	Framebuffer::find("fbo_out_1")->resize(nw, nh);
 	Framebuffer::find("fbo_out_2")->resize(nw, nh);
-	Framebuffer::find("fbo_res0")->resize(nw, nh);
-	Framebuffer::find("fbo_res1")->resize(gui_params_ir.res1.x, gui_params_ir.res1.y);
-	Framebuffer::find("fbo_res2")->resize(gui_params_ir.res2.x, gui_params_ir.res2.y);
-	Framebuffer::find("fbo_res3")->resize(gui_params_ir.res3.x, gui_params_ir.res3.y);
+	Framebuffer::find("fbo_pipeline_depth")->resize(nw, nh);
+	ir_resize_fbo(Framebuffer::find("fbo_res0"), nw, nh);
+	ir_resize_fbo(Framebuffer::find("fbo_capture_motion"), nw, nh);
+	ir_resize_fbo(Framebuffer::find("fbo_res1"), nw/2, nh/2);
+	ir_resize_fbo(Framebuffer::find("fbo_res2"), nw/4, nh/4);
+	ir_resize_fbo(Framebuffer::find("fbo_res3"), nw/8, nh/8);
+	ir_set_render_scale(gui_params_ir.render_scale);
 	std::cout << "\t[ir_resize_callback()] Resize to [(" << gui_params_ir.res0 << "), "
 				<< "(" << gui_params_ir.res1 << "), "
 				<< "(" << gui_params_ir.res2 << "), "
@@ -196,24 +426,14 @@ void ir_resize_callback(int w, int h) {
 // callback function motion buffer resize -- called on movec buffer resize
 void ir_resize_motion_buffer() {
 	Framebuffer fbo = Framebuffer::find("fbo_motion");
-	auto res = glm::ivec2(0, 0);
-	switch (gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id]) {
-	case 0:
-		res = gui_params_ir.res0;
-		break;
-	case 1:
-		res = gui_params_ir.res1;
-		break;
-	case 2:
-		res = gui_params_ir.res2;
-		break;
-	case 3:
-		res = gui_params_ir.res3;
-		break;
-	default:
+	const int depth = gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id];
+	if (depth < 0 || depth > 3) {
 		std::cerr << "[ir_resize_motion_buffer] FATAL ERROR: feature extraction depth not recognized." << std::endl;
+		return;
 	}
-	fbo->resize(res.x,res.y);
+	// allocated at full scale, the current scale only uses a part of it
+	auto res = gui_params_ir.res_max / (1 << depth);
+	ir_resize_fbo(fbo, res.x, res.y);
 	std::cerr << "[ir_resize_motion_buffer] resized motion buffer to " << res << std::endl;
 }
 
@@ -221,6 +441,8 @@ void ir_resize_motion_buffer() {
 // callback function keyboard -- called on button pressed
 void ir_keyboard_callback(int key, int scancode, int action, int mods) {
 	if (ImGui::GetIO().WantCaptureKeyboard) return;
+	// keys change parameters, render the next frame
+	gui_params_ir.redraw_requested = true;
 	//---------------------------------------------------------------
 	// SHIFT + R: Reload Shader
 	if (mods == GLFW_MOD_SHIFT && key == GLFW_KEY_R && action == GLFW_PRESS)
@@ -500,6 +722,7 @@ void InferenceRenderer::loadPointClouds(std::vector<PointCloud>& pcs, std::vecto
 			pcs[i]->add_index_buffer(pc_index.size(), pc_index.data());
 			pcs[i]->add_bounding_structure(bounding_structure);
 			pcs[i]->set_primitive_type(GL_POINTS);
+			if (keepCpuPoints) cpu_points.push_back(SoftwareRasterizer::Points{ pc_position, pc_color, pc_timestamp, bounding_structure });
 
 			std::cout << "[InferenceRenderer] PointCloud has " << pc_position.size() << " points." << std::endl;
 
@@ -561,6 +784,7 @@ void InferenceRenderer::loadPointClouds(std::vector<PointCloud>& pcs, std::vecto
 				pcs[i]->add_bounding_structure(plyParser.bounding_structure);
 
 				pcs[i]->set_primitive_type(GL_POINTS);
+				if (keepCpuPoints) cpu_points.push_back(SoftwareRasterizer::Points{ pc_position, pc_color, pc_timestamp, plyParser.bounding_structure });
 
 				std::cout << "[InferenceRenderer] PointCloud has " << pc_position.size() << " points." << std::endl;
 
@@ -612,6 +836,8 @@ void InferenceRenderer::loadPointClouds(std::vector<PointCloud>& pcs, std::vecto
 				pcs[i]->add_bounding_structure(plyParser.bounding_structure);
 
 				pcs[i]->set_primitive_type(GL_POINTS);
+				// no timestamps in these clouds
+				if (keepCpuPoints) cpu_points.push_back(SoftwareRasterizer::Points{ pc_position, pc_color, {}, plyParser.bounding_structure });
 
 				std::cout << "[InferenceRenderer] PointCloud has " << pc_position.size() << " points." << std::endl;
 
@@ -637,7 +863,7 @@ void InferenceRenderer::run(int argc, char** argv) {
 	std::filesystem::create_directory("./out");
 	std::ofstream timingFile;
 	timingFile.open("./out/timings.csv");
-	timingFile << "Inference;PointRendering;MipMapping;Total" << std::endl;
+	timingFile << "Inference;PointRendering;MipMapping;Total;Precision;PSNR_vs_fp32;Pipelined;Forward;TilesSkipped;TileTimeSaved" << std::endl;
 
 
 	// adjust these parameters to change main functionalities
@@ -656,6 +882,7 @@ void InferenceRenderer::run(int argc, char** argv) {
 	
 	params.title = "Inovis";
 	params.swap_interval = 0;
+	params.headless = offline_job != nullptr;
 	Context::init(params);	
 	params.width /= 4;
 	params.height /= 4;
@@ -756,9 +983,28 @@ void InferenceRenderer::run(int argc, char** argv) {
 		network_stream >> dummy >> n_movec_channels;
 		network_stream >> dummy >> n_groundtruth_amount;
 		network_stream >> dummy >> n_prevInitMV;
+		// optional fields
+		NetworkPrecision n_precision = NetworkPrecision::FP32;
+		int n_receptive_field = 64;
+		int n_memory_per_pixel = 4096;
+		std::string n_encoder, n_decoder;
+		std::string key, value;
+		while (network_stream >> key >> value) {
+			if (key == "precision:") n_precision = parse_network_precision(value);
+			else if (key == "receptive_field:") n_receptive_field = std::stoi(value);
+			else if (key == "memory_per_pixel:") n_memory_per_pixel = std::stoi(value);
+			else if (key == "encoder:") n_encoder = value;
+			else if (key == "decoder:") n_decoder = value;
+			else std::cerr << "[InferenceRenderer] WARNING: unknown network field " << key << " in " << network_file.path().string() << "." << std::endl;
+		}
 
 		if (n_feature_extraction_depth !=0) std::cerr << "[InferenceRenderer] WARNING: Other extraction depths than 0 are deprecated: " << n_feature_extraction_depth << "." << std::endl;
 		if (n_movec_channels < 2 || n_movec_channels > 3) std::cerr << "[InferenceRenderer] WARNING: Other movec channels than 2 or 3 are not supported: " << n_movec_channels << "." << std::endl;
+		if (n_encoder.empty() != n_decoder.empty()) {
+			std::cerr << "[InferenceRenderer] WARNING: split networks need an encoder and a decoder, using the full trace of " << n_name << "." << std::endl;
+			n_encoder.clear();
+			n_decoder.clear();
+		}
 		if (n_groundtruth_amount < 1 || n_groundtruth_amount > 6) std::cerr << "[InferenceRenderer] WARNING: Other ground truth amounts than 1 to 6 are not supported: " << n_groundtruth_amount << "." << std::endl;
 		
 		gui_params_ir.network_filenames.push_back(n_name);
@@ -766,10 +1012,15 @@ void InferenceRenderer::run(int argc, char** argv) {
 		gui_params_ir.network_movec_channels.push_back(n_movec_channels);
 		gui_params_ir.network_groundtruth_amount.push_back(n_groundtruth_amount);
 		gui_params_ir.network_prevInitMV.push_back(n_prevInitMV);
+		gui_params_ir.network_precision.push_back(n_precision);
+		gui_params_ir.network_receptive_field.push_back(n_receptive_field);
+		gui_params_ir.network_memory_per_pixel.push_back(n_memory_per_pixel);
+		gui_params_ir.network_encoder_filenames.push_back(n_encoder);
+		gui_params_ir.network_decoder_filenames.push_back(n_decoder);
 
 		network_stream.close();
 
-		std::cout << "[InferenceRenderer] Found network from file: " << network_file.path() << " \tname: " << n_name << " \tdepth:" << n_feature_extraction_depth << " \tmv_channels: " << n_movec_channels << " \tgt amount: " << n_groundtruth_amount << " \tpreInitMV: " << n_prevInitMV << std::endl;
+		std::cout << "[InferenceRenderer] Found network from file: " << network_file.path() << " \tname: " << n_name << " \tdepth:" << n_feature_extraction_depth << " \tmv_channels: " << n_movec_channels << " \tgt amount: " << n_groundtruth_amount << " \tpreInitMV: " << n_prevInitMV << " \tprecision: " << network_precision_name(n_precision) << std::endl;
 	}
 
 	//----------------------------------------------------------------------
@@ -777,7 +1028,11 @@ void InferenceRenderer::run(int argc, char** argv) {
 
 	//----------------------------------------------------------------------
 	// gui for dataset selection
-	custom_gui_select_dataset();
+	if (offline_job) {
+		if (!select_offline_job()) return;
+	}
+	else
+		custom_gui_select_dataset();
 
 	//----------------------------------------------------------------------
 	// init resolutions etc
@@ -818,6 +1073,11 @@ void InferenceRenderer::run(int argc, char** argv) {
 
 	// culling compute Shader
 	Shader computeFrustumCullingShader("computeFrustumCulling", "shader/computeFrustumCulling.glcs");
+	// max depth pyramid of the occlusion culling
+	Shader hizBuildShader("hizBuild", "shader/hizBuild.glcs");
+	// FrameCamera block of the point shaders
+	frameCameraBuffer = UBO("frameCameraBuffer");
+	frameCameraBuffer->resize(sizeof(FrameCamera));
 	//----------------------------------------------------------------------
 
 	glPointSize(std::max(1, gui_params_ir.pointSizeGL));// std::max(1, int(gui_params_ir.pointSizeGL * gui_params_ir.lodPointSizesGL[gui_params_ir.lod])));
@@ -829,73 +1089,66 @@ void InferenceRenderer::run(int argc, char** argv) {
 	// setup fbo
 	float mod = 2.0 * glm::pow(0.5, gui_params_ir.resolution_modifier);
 	gui_params_ir.res0 = ivec2(gui_params_ir.initial_resolution_default.x *mod, gui_params_ir.initial_resolution_default.y *mod);
+	gui_params_ir.res_max = gui_params_ir.res0;
 
 	// extra fbo for target. normally only texture is used but handy for resizing
 	Framebuffer fbo_out_1 = Framebuffer("fbo_out_1", gui_params_ir.res0.x, gui_params_ir.res0.y);
 	fbo_out_1->attach_depthbuffer(Texture2D("fbo_out_1/depth", gui_params_ir.res0.x, gui_params_ir.res0.y, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT));
 	fbo_out_1->attach_colorbuffer(Texture2D("fbo_out_1/col", gui_params_ir.res0.x, gui_params_ir.res0.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_out_1->attach_colorbuffer(Texture2D("fbo_out_1/depthcol", gui_params_ir.res0.x, gui_params_ir.res0.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
+	fbo_out_1->attach_colorbuffer(ir_depth_target("fbo_out_1/depthcol", gui_params_ir.res0));
 	fbo_out_1->check();
 
 	Framebuffer fbo_out_2 = Framebuffer("fbo_out_2", gui_params_ir.res0.x, gui_params_ir.res0.y);
 	fbo_out_2->attach_depthbuffer(Texture2D("fbo_out_2/depth", gui_params_ir.res0.x, gui_params_ir.res0.y, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT));
 	fbo_out_2->attach_colorbuffer(Texture2D("fbo_out_2/col", gui_params_ir.res0.x, gui_params_ir.res0.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_out_2->attach_colorbuffer(Texture2D("fbo_out_2/depthcol", gui_params_ir.res0.x, gui_params_ir.res0.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
+	fbo_out_2->attach_colorbuffer(ir_depth_target("fbo_out_2/depthcol", gui_params_ir.res0));
 	fbo_out_2->check();
 
 	// 2 output buffer to switch between the two buffers and use the other one as a previous image for TAA
+	// point rendered depth of the frames in flight when inference is pipelined, one per slot
+	Framebuffer fbo_pipeline_depth = Framebuffer("fbo_pipeline_depth", gui_params_ir.res0.x, gui_params_ir.res0.y);
+	fbo_pipeline_depth->attach_colorbuffer(ir_depth_target("fbo_pipeline_depth/slot0", gui_params_ir.res0));
+	fbo_pipeline_depth->attach_colorbuffer(ir_depth_target("fbo_pipeline_depth/slot1", gui_params_ir.res0));
+	fbo_pipeline_depth->check();
+
 	Framebuffer fbo_out = fbo_out_1;
 	Framebuffer fbo_prev = fbo_out_2;
 	cur_out_fbo = fbo_out->name;
 
 	Framebuffer fbo_res0 = Framebuffer("fbo_res0", gui_params_ir.res0.x, gui_params_ir.res0.y);
 	fbo_res0->attach_depthbuffer(Texture2D("fbo_res0/depth", gui_params_ir.res0.x, gui_params_ir.res0.y, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT));
-	// maximum number of color attachments should be 8 -> 1: col, 1: depthcol, 6: motion 
+	// maximum number of color attachments should be 8 -> 1: col, 1: depthcol, 6: motion
+	// compact formats: 16 + 4 + 6 * 8 (6 * 4 with half motion) instead of 8 * 16 bytes per pixel, see ir_depth_target/ir_motion_target
+	// the motion targets are transients of the render graph, only allocated while a pass uses them
 	fbo_res0->attach_colorbuffer(Texture2D("fbo_res0/col", gui_params_ir.res0.x, gui_params_ir.res0.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res0->attach_colorbuffer(Texture2D("fbo_res0/depthcol", gui_params_ir.res0.x, gui_params_ir.res0.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res0->attach_colorbuffer(Texture2D("fbo_res0/motion1", gui_params_ir.res0.x, gui_params_ir.res0.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res0->attach_colorbuffer(Texture2D("fbo_res0/motion2", gui_params_ir.res0.x, gui_params_ir.res0.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res0->attach_colorbuffer(Texture2D("fbo_res0/motion3", gui_params_ir.res0.x, gui_params_ir.res0.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res0->attach_colorbuffer(Texture2D("fbo_res0/motion4", gui_params_ir.res0.x, gui_params_ir.res0.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res0->attach_colorbuffer(Texture2D("fbo_res0/motion5", gui_params_ir.res0.x, gui_params_ir.res0.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res0->attach_colorbuffer(Texture2D("fbo_res0/motion6", gui_params_ir.res0.x, gui_params_ir.res0.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
+	fbo_res0->attach_colorbuffer(ir_depth_target("fbo_res0/depthcol", gui_params_ir.res0));
+	for (int i = 0; i < 6; ++i) render_graph.attach(fbo_res0, 2 + i, "res0/motion" + std::to_string(i + 1));
 	fbo_res0->check();
 
+	// scratch target of the motion captures, expanded to rgba (ir_expand_motion), a transient of the render graph
+	Framebuffer fbo_capture_motion = Framebuffer("fbo_capture_motion", gui_params_ir.res0.x, gui_params_ir.res0.y);
+	render_graph.attach(fbo_capture_motion, 0, "capture/motion");
+
 	gui_params_ir.res1 = glm::ivec2(gui_params_ir.res0.x / 2, gui_params_ir.res0.y / 2);
 	Framebuffer fbo_res1 = Framebuffer("fbo_res1", gui_params_ir.res1.x, gui_params_ir.res1.y);
 	fbo_res1->attach_depthbuffer(Texture2D("fbo_res1/depth", gui_params_ir.res1.x, gui_params_ir.res1.y, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT));
 	fbo_res1->attach_colorbuffer(Texture2D("fbo_res1/col", gui_params_ir.res1.x, gui_params_ir.res1.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res1->attach_colorbuffer(Texture2D("fbo_res1/depthcol", gui_params_ir.res1.x, gui_params_ir.res1.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res1->attach_colorbuffer(Texture2D("fbo_res1/motion1", gui_params_ir.res1.x, gui_params_ir.res1.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res1->attach_colorbuffer(Texture2D("fbo_res1/motion2", gui_params_ir.res1.x, gui_params_ir.res1.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res1->attach_colorbuffer(Texture2D("fbo_res1/motion3", gui_params_ir.res1.x, gui_params_ir.res1.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res1->attach_colorbuffer(Texture2D("fbo_res1/motion4", gui_params_ir.res1.x, gui_params_ir.res1.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res1->attach_colorbuffer(Texture2D("fbo_res1/motion5", gui_params_ir.res1.x, gui_params_ir.res1.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res1->attach_colorbuffer(Texture2D("fbo_res1/motion6", gui_params_ir.res1.x, gui_params_ir.res1.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
+	fbo_res1->attach_colorbuffer(ir_depth_target("fbo_res1/depthcol", gui_params_ir.res1));
+	for (int i = 0; i < 6; ++i) render_graph.attach(fbo_res1, 2 + i, "res1/motion" + std::to_string(i + 1));
 	fbo_res1->check();
 	gui_params_ir.res2 = glm::ivec2(gui_params_ir.res1.x / 2, gui_params_ir.res1.y / 2);
 	Framebuffer fbo_res2 = Framebuffer("fbo_res2", gui_params_ir.res2.x, gui_params_ir.res2.y);
 	fbo_res2->attach_depthbuffer(Texture2D("fbo_res2/depth", gui_params_ir.res2.x, gui_params_ir.res2.y, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT));
 	fbo_res2->attach_colorbuffer(Texture2D("fbo_res2/col", gui_params_ir.res2.x, gui_params_ir.res2.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res2->attach_colorbuffer(Texture2D("fbo_res2/depthcol", gui_params_ir.res2.x, gui_params_ir.res2.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res2->attach_colorbuffer(Texture2D("fbo_res2/motion1", gui_params_ir.res2.x, gui_params_ir.res2.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res2->attach_colorbuffer(Texture2D("fbo_res2/motion2", gui_params_ir.res2.x, gui_params_ir.res2.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res2->attach_colorbuffer(Texture2D("fbo_res2/motion3", gui_params_ir.res2.x, gui_params_ir.res2.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res2->attach_colorbuffer(Texture2D("fbo_res2/motion4", gui_params_ir.res2.x, gui_params_ir.res2.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res2->attach_colorbuffer(Texture2D("fbo_res2/motion5", gui_params_ir.res2.x, gui_params_ir.res2.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res2->attach_colorbuffer(Texture2D("fbo_res2/motion6", gui_params_ir.res2.x, gui_params_ir.res2.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
+	fbo_res2->attach_colorbuffer(ir_depth_target("fbo_res2/depthcol", gui_params_ir.res2));
+	for (int i = 0; i < 6; ++i) render_graph.attach(fbo_res2, 2 + i, "res2/motion" + std::to_string(i + 1));
 	fbo_res2->check();
 	gui_params_ir.res3 = glm::ivec2(gui_params_ir.res2.x / 2, gui_params_ir.res2.y / 2);
 	Framebuffer fbo_res3 = Framebuffer("fbo_res3", gui_params_ir.res3.x, gui_params_ir.res3.y);
 	fbo_res3->attach_depthbuffer(Texture2D("fbo_res3/depth", gui_params_ir.res3.x, gui_params_ir.res3.y, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT));
 	fbo_res3->attach_colorbuffer(Texture2D("fbo_res3/col", gui_params_ir.res3.x, gui_params_ir.res3.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res3->attach_colorbuffer(Texture2D("fbo_res3/depthcol", gui_params_ir.res3.x, gui_params_ir.res3.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res3->attach_colorbuffer(Texture2D("fbo_res3/motion1", gui_params_ir.res3.x, gui_params_ir.res3.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res3->attach_colorbuffer(Texture2D("fbo_res3/motion2", gui_params_ir.res3.x, gui_params_ir.res3.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res3->attach_colorbuffer(Texture2D("fbo_res3/motion3", gui_params_ir.res3.x, gui_params_ir.res3.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res3->attach_colorbuffer(Texture2D("fbo_res3/motion4", gui_params_ir.res3.x, gui_params_ir.res3.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res3->attach_colorbuffer(Texture2D("fbo_res3/motion5", gui_params_ir.res3.x, gui_params_ir.res3.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_res3->attach_colorbuffer(Texture2D("fbo_res3/motion6", gui_params_ir.res3.x, gui_params_ir.res3.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
+	fbo_res3->attach_colorbuffer(ir_depth_target("fbo_res3/depthcol", gui_params_ir.res3));
+	for (int i = 0; i < 6; ++i) render_graph.attach(fbo_res3, 2 + i, "res3/motion" + std::to_string(i + 1));
 	fbo_res3->check();
 
     std::cout << "[InferenceRenderer] Setup framebuffers with resolutions " << gui_params_ir.res0 << ", " << gui_params_ir.res1 << ", " << gui_params_ir.res2 << ", "  << gui_params_ir.res3 << std::endl;
@@ -918,15 +1171,10 @@ void InferenceRenderer::run(int argc, char** argv) {
 		std::cerr << "[ir_resize_motion_buffer] FATAL ERROR: feature extraction depth not recognized." << std::endl;
 	}
 
+	// motion vectors at the feature extraction depth without mip mapping, the targets are transients of the render graph
 	Framebuffer fbo_motion = Framebuffer("fbo_motion", res_motion.x, res_motion.y);
-	fbo_motion->attach_depthbuffer(Texture2D("fbo_motion/depth", gui_params_ir.res1.x, gui_params_ir.res1.y, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT));
-	fbo_motion->attach_colorbuffer(Texture2D("fbo_motion/motion1", gui_params_ir.res1.x, gui_params_ir.res1.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_motion->attach_colorbuffer(Texture2D("fbo_motion/motion2", gui_params_ir.res1.x, gui_params_ir.res1.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_motion->attach_colorbuffer(Texture2D("fbo_motion/motion3", gui_params_ir.res1.x, gui_params_ir.res1.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_motion->attach_colorbuffer(Texture2D("fbo_motion/motion4", gui_params_ir.res1.x, gui_params_ir.res1.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_motion->attach_colorbuffer(Texture2D("fbo_motion/motion5", gui_params_ir.res1.x, gui_params_ir.res1.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_motion->attach_colorbuffer(Texture2D("fbo_motion/motion6", gui_params_ir.res1.x, gui_params_ir.res1.y, GL_RGBA32F, GL_RGBA, GL_FLOAT));
-	fbo_motion->check();
+	render_graph.attach(fbo_motion, -1, "motion/depth");
+	for (int i = 0; i < 6; ++i) render_graph.attach(fbo_motion, i, "motion/" + std::to_string(i + 1));
 	//----------------------------------------------------------------------
 	//Load Dataset
 	dataset.load(0, setSize[dataset_id], setType[dataset_id], setFolder[dataset_id], setInfo[dataset_id], setKittyPCRange, gui_params_ir.initial_resolution_default, setGenericTestStartStep);
@@ -945,6 +1193,7 @@ void InferenceRenderer::run(int argc, char** argv) {
 	std::vector<PointCloud> pointClouds;
 	loadPointClouds(pointClouds, pointCloud_filenames);
 	gui_params_ir.lod_amount = pointCloud_filenames.size();
+	if (offline_job) gui_params_ir.lod = glm::clamp(offline_job->lod, 0, gui_params_ir.lod_amount - 1);
 	//----------------------------------------------------------------------
 	
 	//----------------------------------------------------------------------
@@ -1358,7 +1607,20 @@ void InferenceRenderer::run(int argc, char** argv) {
 		<< TORCH_VERSION_MAJOR << "."
 		<< TORCH_VERSION_MINOR << "."
 		<< TORCH_VERSION_PATCH << std::endl;
-	std::vector<torch::jit::script::Module> renderer_traces;
+	FeatureCache feature_cache;			// encoded auxiliary images of split networks
+	NetworkInputArena input_arena;
+	InferencePipeline pipeline;
+	TiledInference tiled_inference;
+	BatchedInference batched_inference;
+	NetworkCache network_cache;			// frozen and optimized networks, shared by all resolutions
+	glm::mat4 out_view = glm::mat4(1);	// camera of the image in fbo_out, one frame behind when pipelined
+	double forward_ms = 0.0;
+	IdleTracker idle_tracker;
+	ResolutionController resolution_controller;
+	bool out_swapped = false;			// fbo_out and fbo_prev were swapped after the last rendered frame
+	OfflineReport offline_report;
+	size_t offline_frame = 0;			// next frame of the offline job
+	double offline_write_ms = 0.0;
 
 //    try{
 //        std::cout << "try to create a tensor" << std::endl;
@@ -1391,32 +1653,48 @@ void InferenceRenderer::run(int argc, char** argv) {
 //        std::cerr << e.what() << std::endl << std::endl;;
 //        std::cerr << e.what_without_backtrace() << std::endl;
 //    }
-    if(doInference) {
-        try {
-            gui_params_ir.network_amount = gui_params_ir.network_filenames.size();
-            //renderer_trace = torch::jit::load("../../../networks/aliev.pt");
-            for (int i = 0; i < gui_params_ir.network_amount; ++i) {
-                std::string network_path = networks_path + gui_params_ir.network_filenames[i] + ".pt";
-                std::cout << "\tload Net: " << network_path << std::endl;
-                if (!std::filesystem::exists(network_path)) {
-                    std::cerr << "\tfile not found: " << network_path << std::endl;
-                }
-
-                renderer_traces.push_back(torch::jit::load(network_path));
-                renderer_traces[i].to(torch::kCUDA);
-                renderer_traces[i].eval();
+	// without a cuda device the inference runs on the cpu and textures are transferred through pixel buffers instead of cuda-gl interop
+	const torch::Device inference_device = torch::cuda::is_available() ? torch::kCUDA : torch::kCPU;
+	set_texture_transfer_device(inference_device);
+	std::cerr << "[InferenceRenderer] Inference device: " << (inference_device.is_cuda() ? "cuda (cuda-gl interop)" : "cpu (pixel buffer transfers)") << std::endl;
+	// networks are loaded on first use in the background
+	NetworkLoader network_loader(inference_device);
 
+    if(doInference) {
+        gui_params_ir.network_amount = gui_params_ir.network_filenames.size();
+        //renderer_trace = torch::jit::load("../../../networks/aliev.pt");
+        for (int i = 0; i < gui_params_ir.network_amount; ++i) {
+            NetworkPrecision& precision = gui_params_ir.network_precision[i];
+            // split networks: the decoder runs every frame, the encoder only for auxiliary images that are not cached
+            const bool split = !gui_params_ir.network_encoder_filenames[i].empty();
+            const std::string& trace_name = split ? gui_params_ir.network_decoder_filenames[i] : gui_params_ir.network_filenames[i];
+            std::string network_path_fp32 = network_trace_path(networks_path, trace_name, NetworkPrecision::FP32);
+            if (precision == NetworkPrecision::INT8 && inference_device.is_cuda()) {
+                std::cerr << "[InferenceRenderer] WARNING: int8 traces run on the cpu only, using fp32 for " << trace_name << "." << std::endl;
+                precision = NetworkPrecision::FP32;
             }
+            if (precision == NetworkPrecision::INT8 && !std::filesystem::exists(network_trace_path(networks_path, trace_name, precision))) {
+                std::cerr << "[InferenceRenderer] WARNING: no int8 trace found (export with trace_int8), using fp32 for " << trace_name << "." << std::endl;
+                precision = NetworkPrecision::FP32;
+            }
+            NetworkLoader::Paths paths;
+            paths.module = network_trace_path(networks_path, trace_name, precision);
+            std::cout << "\tfound Net: " << paths.module << " (" << network_precision_name(precision) << ")" << std::endl;
+            if (!std::filesystem::exists(paths.module)) {
+                std::cerr << "\tfile not found: " << paths.module << std::endl;
+            }
+            if (split)
+                paths.encoder = network_trace_path(networks_path, gui_params_ir.network_encoder_filenames[i], NetworkPrecision::FP32);
+            // fp32 reference for the accuracy report of reduced precision networks
+            if (precision != NetworkPrecision::FP32)
+                paths.reference = network_path_fp32;
+            network_loader.add(paths);
         }
-        catch (const c10::Error &e) {
-            std::cerr << "error loading the model\n";
-            std::cerr << e.what() << std::endl << std::endl;;
-            std::cerr << e.what_without_backtrace() << std::endl;
-            return;
-        }
+        // start loading the initial network while the rest is set up
+        network_loader.get(gui_params_ir.network_id);
     }
 	
-	std::cerr << "[InferenceRenderer] Finished Loading CNN" << std::endl;
+	std::cerr << "[InferenceRenderer] Finished Registering CNN" << std::endl;
 
     //----------------------------------------------------------------------
     // setup debug frustum
@@ -1427,12 +1705,35 @@ void InferenceRenderer::run(int argc, char** argv) {
     int mod_target_res = (gui_params_ir.initial_resolution_default.y <= 560) ? 4 : 2;
     Context::resize(gui_params_ir.initial_resolution_default.x * mod_target_res, gui_params_ir.initial_resolution_default.y * mod_target_res);
 
+	//----------------------------------------------------------------------
+	// offline: every frame of the job is rendered and written, without gui and at full resolution
+	if (offline_job) {
+		gui_params_ir.draw_gui = 0;
+		gui_params_ir.idle_skip = false;
+		gui_params_ir.pipelined_inference = false;
+		gui_params_ir.dynamic_resolution = false;
+		gui_params_ir.animationRunning = false;
+		gui_params_ir.animation_show_capture_frustum = false;
+		gui_params_ir.use_taa = offline_job->use_taa;
+		gui_params_ir.cpu_rasterizer = offline_job->cpu_rasterizer;
+		gui_params_ir.displayMode = 0;
+		gui_params_ir.currentRenderInfo = 17;
+		std::filesystem::create_directories(offline_job->output_dir + "/neural");
+	}
+
 	//----------------------------------------------------------------------
 	// render loop
 	std::cerr << "[InferenceRenderer] Start Render Loop " << std::endl;
 	//glDisable(GL_CULL_FACE); 
 	// run
 	while (Context::running()){
+		const auto frame_start = std::chrono::steady_clock::now();
+		if (offline_job) {
+			if (offline_frame >= offline_job->frames.size()) break;
+			current_camera()->load(offline_job->frames[offline_frame].first, offline_job->frames[offline_frame].second);
+		}
+		capture_writer.configure(gui_params_ir.capture_writer_threads, size_t(gui_params_ir.capture_writer_memory_mb) << 20);
+		capture_writer.poll();
 		if (gui_params_ir.increment_image) {
 			setCurrentCam(dataset.currentCam + 1, gui_params_ir.cycleTestImages);
 			gui_params_ir.increment_image = false;
@@ -1445,16 +1746,24 @@ void InferenceRenderer::run(int argc, char** argv) {
 		if (gui_params_ir.animationRunning) {
 			// write timings while animation
 			auto frametimer = TimerQuery::find("Frame-time");
-			timingFile << timerInference->exp_avg << ";" << timerRenderPC->exp_avg << ";" << timerMipMap->exp_avg << ";" << frametimer->exp_avg << ";" << std::endl;
+			NetworkPrecision precision = gui_params_ir.network_precision[gui_params_ir.network_id];
+			timingFile << timerInference->exp_avg << ";" << timerRenderPC->exp_avg << ";" << timerMipMap->exp_avg << ";" << frametimer->exp_avg << ";" << network_precision_name(precision) << ";";
+			if (gui_params_ir.precision_report && precision != NetworkPrecision::FP32) timingFile << gui_params_ir.precision_psnr;
+			timingFile << ";" << gui_params_ir.pipelined_inference << ";" << forward_ms << ";";
+			if (gui_params_ir.tiled_inference && gui_params_ir.tile_selective_update) timingFile << gui_params_ir.tile_skipped_fraction << ";" << gui_params_ir.tile_time_saved_ms;
+			else timingFile << ";";
+			timingFile << std::endl;
 		}
 		timerPreprocess->begin();
 		//----------------------------------------------------------------------
 		// compute current gui_params_ir.res0
 		mod = 2.0 * glm::pow(0.5, gui_params_ir.resolution_modifier);
 		// handle input
-		glfwPollEvents();
 		float frame_time = Context::frame_time();
-		CameraImpl::default_input_handler(frame_time);
+		if (!offline_job) {
+			glfwPollEvents();
+			CameraImpl::default_input_handler(frame_time);
+		}
 
 		//----------------------------------------------------------------------
 		// Animation handling
@@ -1562,6 +1871,111 @@ void InferenceRenderer::run(int argc, char** argv) {
 		}
 		//std::cout << gt_timestamp_min << " : " << gt_timestamp_max << std::endl;
 
+		//----------------------------------------------------------------------
+		// Idle frames: nothing the image depends on changed since the output settled -> present the last output again
+		IdleTracker::State frame_state;
+		frame_state.view = current_camera()->view;
+		frame_state.proj = current_camera()->proj;
+		frame_state.resolution = gui_params_ir.res0;
+		frame_state.lod = gui_params_ir.lod;
+		frame_state.network_id = gui_params_ir.network_id;
+		frame_state.display_mode = gui_params_ir.displayMode;
+		frame_state.render_info = gui_params_ir.currentRenderInfo;
+		frame_state.timestamp_min = gt_timestamp_min;
+		frame_state.timestamp_max = gt_timestamp_max;
+		for (int nv = 0; nv < std::min(int(nearest_views.size()), 8); ++nv)
+			frame_state.nearest_views.push_back(nearest_views[nv].id);
+		const bool frame_forced = !gui_params_ir.idle_skip || gui_params_ir.redraw_requested || gui_params_ir.network_loading || IdleTracker::gui_interaction() || gui_params_ir.animationRunning || takeScreenshot
+			|| gui_params_ir.captureVideo || gui_params_ir.startCaptureVideo || gui_params_ir.capturing || gui_params_ir.startCapturing || gui_params_ir.captureByIndex || gui_params_ir.startCaptureByIndex;
+		gui_params_ir.redraw_requested = false;
+		// gui changes take effect in the next frame, the pipelined output one frame later, taa converges over taa_idle_frames
+		const int settle_frames = 1 + int(gui_params_ir.pipelined_inference) + (gui_params_ir.use_taa ? gui_params_ir.taa_idle_frames : 0);
+		const bool render_frame = idle_tracker.update(frame_state, frame_forced, settle_frames);
+		gui_params_ir.idle_frames = idle_tracker.idle_frames;
+		if (!render_frame) {
+			resolution_controller.hold(); // timings of idle frames do not count
+			timer->end();
+			if (gui_params_ir.draw_gui == 2 || gui_params_ir.draw_gui == 3) {
+				gui_draw();
+			}
+			if (gui_params_ir.draw_gui == 1 || gui_params_ir.draw_gui == 3) {
+				custom_gui_draw();
+			}
+			// the last output is in fbo_prev if the buffers were swapped after it was rendered
+			if (out_swapped)
+				present_output(fbo_prev, fbo_out);
+			else
+				present_output(fbo_out, fbo_prev);
+			Context::swap_buffers();
+			continue;
+		}
+
+		//----------------------------------------------------------------------
+		// Dynamic resolution: scale res0 - res3 within the preallocated render targets to hold the target frame time
+		{
+			// screenshots and captures are written at full resolution
+			const bool full_scale = !gui_params_ir.dynamic_resolution || takeScreenshot || gui_params_ir.captureVideo || gui_params_ir.startCaptureVideo
+				|| gui_params_ir.capturing || gui_params_ir.startCapturing || gui_params_ir.captureByIndex || gui_params_ir.startCaptureByIndex;
+			float scale = 1.f;
+			if (full_scale) {
+				resolution_controller.reset(1.f);
+			}
+			else {
+				resolution_controller.target_ms = gui_params_ir.drs_target_ms;
+				resolution_controller.min_scale = gui_params_ir.drs_min_scale;
+				// everything between the start of the point rendering and the end of the inference scales with the pixel count
+				resolution_controller.update(frame_time, timerRenderPC->last() + timerMipMap->last() + timerInference->last());
+				scale = resolution_controller.scale;
+			}
+			if (scale != gui_params_ir.render_scale) {
+				const ivec2 res_from = gui_params_ir.res0;
+				ir_set_render_scale(scale);
+				// keep the presented output and the taa history valid, fbo_res0 is rendered afterwards and serves as scratch
+				ir_rescale_output(fbo_out, fbo_res0, res_from, gui_params_ir.res0);
+				ir_rescale_output(fbo_prev, fbo_res0, res_from, gui_params_ir.res0);
+			}
+		}
+
+		// only the motion targets (and mip levels) the network reads are rendered when nothing else is shown
+		const int motion_count = ir_motion_target_count();
+		const int motion_level = ir_motion_level();
+		// cpu inference of the network output only: the network inputs of res1 - res3 are downsampled on the host (pack_pyramid)
+		const bool cpu_mipmap = gui_params_ir.cpu_mipmap && !inference_device.is_cuda() && doInference && ir_shows_network_output_only()
+			&& !gui_params_ir.capturing && !gui_params_ir.captureByIndex && !gui_params_ir.captureVideo;
+		// passes nothing is read from are skipped, the motion targets of the kept passes are taken from the pool
+		declare_frame_graph(cpu_mipmap, motion_count, motion_level);
+		// camera and old views of all point shaders, bound once for the frame
+		gui_params_ir.uniform_info = ivec2(int(ShaderImpl::uniform_calls), int(ShaderImpl::location_queries));
+		ShaderImpl::uniform_calls = 0;
+		ShaderImpl::location_queries = 0;
+		if (gui_params_ir.uniform_benchmark) {
+			benchmark_uniforms(motion_count);
+			gui_params_ir.uniform_benchmark = false;
+		}
+		upload_frame_camera();
+		if (gui_params_ir.culling_benchmark) {
+			benchmark_culling(pointClouds[gui_params_ir.lod], computeFrustumCullingShader, drawPCmultiShader, motion_count);
+			gui_params_ir.culling_benchmark = false;
+		}
+
+		// uniforms of the point shaders for the software rasterizer
+		const bool cpu_raster = gui_params_ir.cpu_rasterizer && gui_params_ir.lod < int(cpu_points.size());
+		SoftwareRasterizer::Params raster_params;
+		if (cpu_raster) {
+			software_rasterizer.configure(gui_params_ir.cpu_rasterizer_threads);
+			raster_params.proj = frame_camera.proj;
+			raster_params.view = frame_camera.view;
+			raster_params.proj_old = frame_camera.proj_old;
+			raster_params.use_taa = gui_params_ir.use_taa;
+			for (int i = 0; i < 6; ++i)
+				raster_params.view_old[i] = motion_view(i);
+			raster_params.use_timestamp = gui_params_ir.use_timestamp;
+			raster_params.timestamp_min = gt_timestamp_min;
+			raster_params.timestamp_max = gt_timestamp_max;
+			raster_params.point_size = std::max(1, gui_params_ir.pointSizeGL);
+			raster_params.motion_count = motion_count;
+			raster_params.motion_limit = halfMotionTargets ? half_motion_limit : 0.f;
+		}
 
 		timerRenderPC->begin();
 		//----------------------------------------------------------------------
@@ -1570,92 +1984,59 @@ void InferenceRenderer::run(int argc, char** argv) {
 		
 		//----------------------------------------------------------------------
 		// Render Motion Vectors
-		if (!gui_params_ir.mipmap_motion) {
+		if (render_graph.enabled("motion")) {
+			// render targets are allocated at full scale, only the part of the current scale is used
+			const ivec2 motion_res = ir_level_resolution(gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id]);
 			fbo_motion->bind();
+			ir_draw_buffers(fbo_motion, 0, motion_count);
+			glViewport(0, 0, motion_res.x, motion_res.y);
 			glClearColor(-2.0, -2.0, -2.0, 1.0);
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 			glClearColor(0.0, 0.0, 0.0, 1.0);
 
-			if (gui_params_ir.preInitMV) {
-				glDepthMask(GL_FALSE);
-				initMoVecsOnly->bind();
-				initMoVecsOnly->uniform("proj", current_camera()->proj);
-				initMoVecsOnly->uniform("view", current_camera()->view);
-				initMoVecsOnly->uniform("view_normal", current_camera()->view_normal);
-				
-				initMoVecsOnly->uniform("use_taa", gui_params_ir.use_taa);
-
-				//load old view if motion vecs are rendered
-				initMoVecsOnly->uniform("resolution", gui_params_ir.res0);
-				int base_index = 0;
-				if (gui_params_ir.use_taa) {
-					initMoVecsOnly->uniform("view_old_1", view_old);
-					base_index = -1;
-				}
-				else {
-					initMoVecsOnly->uniform("view_old_1", getView(nearest_views[base_index + int(gui_params_ir.skipNearest)].id));
-				}
-				initMoVecsOnly->uniform("view_old_2", getView(nearest_views[base_index + 1 + int(gui_params_ir.skipNearest)].id));
-				initMoVecsOnly->uniform("view_old_3", getView(nearest_views[base_index + 2 + int(gui_params_ir.skipNearest)].id));
-				initMoVecsOnly->uniform("view_old_4", getView(nearest_views[base_index + 3 + int(gui_params_ir.skipNearest)].id));
-				initMoVecsOnly->uniform("view_old_5", getView(nearest_views[base_index + 4 + int(gui_params_ir.skipNearest)].id));
-				initMoVecsOnly->uniform("view_old_6", getView(nearest_views[base_index + 5 + int(gui_params_ir.skipNearest)].id));
-
-				initMoVecsOnly->uniform("proj_old", dataset.gt_proj);
-				Quad::draw();
-				initMoVecsOnly->unbind();
-				glDepthMask(GL_TRUE);
-				glClear(GL_DEPTH_BUFFER_BIT);
-			}
-			//else { // use the full clouds present in pointClouds
-			if (gui_params_ir.enableCulling) pointClouds[gui_params_ir.lod]->cull(computeFrustumCullingShader, current_camera()->pos, current_camera()->dir, current_camera()->up,
-				current_camera()->near, current_camera()->far, current_camera()->fov_degree, dataset.camera_aspect_ratio);
-			pointClouds[gui_params_ir.lod]->bind(drawPCmultiMotionOnly);
-			//}
-			//----------------------------------------------------------------------
-			// bind shader and uniforms
-			drawPCmultiMotionOnly->bind();
-			drawPCmultiMotionOnly->uniform("proj", current_camera()->proj);
-			drawPCmultiMotionOnly->uniform("view", current_camera()->view);
-			drawPCmultiMotionOnly->uniform("view_normal", current_camera()->view_normal);
-			
-			drawPCmultiMotionOnly->uniform("use_taa", gui_params_ir.use_taa);
-
-			//load old view if motion vecs are rendered
-			ivec2 motion_res = glm::ivec2(Framebuffer::find("fbo_motion")->w, Framebuffer::find("fbo_motion")->h);
-			drawPCmultiMotionOnly->uniform("resolution", motion_res);
-			int base_index = 0;
-			if (gui_params_ir.use_taa) {
-				drawPCmultiMotionOnly->uniform("view_old_1", view_old);
-				base_index = -1;
+			if (cpu_raster) {
+				raster_params.color = false;
+				raster_params.motion = true;
+				raster_params.pre_init_motion = gui_params_ir.preInitMV;
+				raster_params.motion_clear = vec4(-2, -2, -2, 1);
+				software_rasterizer.render(cpu_points[gui_params_ir.lod], motion_res, raster_params);
+				for (int i = 0; i < motion_count; ++i)
+					ir_upload(fbo_motion->color_textures[i], motion_res, software_rasterizer.motion[i].data());
 			}
 			else {
-				drawPCmultiMotionOnly->uniform("view_old_1", getView(nearest_views[base_index + int(gui_params_ir.skipNearest)].id));
+				if (gui_params_ir.preInitMV) {
+					glDepthMask(GL_FALSE);
+					initMoVecsOnly->bind();
+					set_motion_uniforms(initMoVecsOnly, gui_params_ir.res0, motion_count);
+					Quad::draw();
+					initMoVecsOnly->unbind();
+					glDepthMask(GL_TRUE);
+					glClear(GL_DEPTH_BUFFER_BIT);
+				}
+				//else { // use the full clouds present in pointClouds
+				ir_cull(pointClouds[gui_params_ir.lod], computeFrustumCullingShader, dataset.camera_aspect_ratio);
+				pointClouds[gui_params_ir.lod]->bind(drawPCmultiMotionOnly);
+				//}
+				//----------------------------------------------------------------------
+				// bind shader and uniforms
+				drawPCmultiMotionOnly->bind();
+				set_motion_uniforms(drawPCmultiMotionOnly, motion_res, motion_count);
+				//----------------------------------------------------------------------
+				// draw PointCloud
+				pointClouds[gui_params_ir.lod]->draw();
+				pointClouds[gui_params_ir.lod]->unbind();
+				//}
+				drawPCmultiMotionOnly->unbind();
 			}
-			drawPCmultiMotionOnly->uniform("view_old_2", getView(nearest_views[base_index + 1 + int(gui_params_ir.skipNearest)].id));
-			drawPCmultiMotionOnly->uniform("view_old_3", getView(nearest_views[base_index + 2 + int(gui_params_ir.skipNearest)].id));
-			drawPCmultiMotionOnly->uniform("view_old_4", getView(nearest_views[base_index + 3 + int(gui_params_ir.skipNearest)].id));
-			drawPCmultiMotionOnly->uniform("view_old_5", getView(nearest_views[base_index + 4 + int(gui_params_ir.skipNearest)].id));
-			drawPCmultiMotionOnly->uniform("view_old_6", getView(nearest_views[base_index + 5 + int(gui_params_ir.skipNearest)].id));
-
-
-			drawPCmultiMotionOnly->uniform("proj_old", dataset.gt_proj);
-
-			drawPCmultiMotionOnly->uniform("gt_timestamp_max", gt_timestamp_max);
-			drawPCmultiMotionOnly->uniform("gt_timestamp_min", gt_timestamp_min);
-			drawPCmultiMotionOnly->uniform("use_timestamp", gui_params_ir.use_timestamp);
-			//----------------------------------------------------------------------
-			// draw PointCloud
-			pointClouds[gui_params_ir.lod]->draw();
-			pointClouds[gui_params_ir.lod]->unbind();
-			//}
-			drawPCmultiMotionOnly->unbind();
 
 			fbo_motion->unbind();
 		}
 
+		const bool render_points = render_graph.enabled("points");
 		fbo_res0->bind();
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		ir_draw_buffers(fbo_res0, 2, gui_params_ir.mipmap_motion ? motion_count : 0);
+		glViewport(0, 0, gui_params_ir.res0.x, gui_params_ir.res0.y);
+		if (render_points) glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 
 
@@ -1663,93 +2044,68 @@ void InferenceRenderer::run(int argc, char** argv) {
 		//----------------------------------------------------------------------
 		//default camera
 
-		// preinit movecs in 
-		if (gui_params_ir.mipmap_motion && gui_params_ir.preInitMV) {
-			glDepthMask(GL_FALSE);
-			initMoVecs->bind();
-			initMoVecs->uniform("proj", current_camera()->proj);
-			initMoVecs->uniform("view", current_camera()->view);
-			initMoVecs->uniform("view_normal", current_camera()->view_normal);
-
-			initMoVecs->uniform("use_taa", gui_params_ir.use_taa);
-
-			//load old view if motion vecs are rendered
-			initMoVecs->uniform("resolution", gui_params_ir.res0);
-			int base_index = 0;
-			if (gui_params_ir.use_taa) {
-				initMoVecs->uniform("view_old_1", view_old);
-				base_index = -1;
-			}
-			else {
-				initMoVecs->uniform("view_old_1", getView(nearest_views[base_index + int(gui_params_ir.skipNearest)].id));
-			}
-			initMoVecs->uniform("view_old_2", getView(nearest_views[base_index + 1 + int(gui_params_ir.skipNearest)].id));
-			initMoVecs->uniform("view_old_3", getView(nearest_views[base_index + 2 + int(gui_params_ir.skipNearest)].id));
-			initMoVecs->uniform("view_old_4", getView(nearest_views[base_index + 3 + int(gui_params_ir.skipNearest)].id));
-			initMoVecs->uniform("view_old_5", getView(nearest_views[base_index + 4 + int(gui_params_ir.skipNearest)].id));
-			initMoVecs->uniform("view_old_6", getView(nearest_views[base_index + 5 + int(gui_params_ir.skipNearest)].id));
-
-			initMoVecs->uniform("proj_old", dataset.gt_proj);
-			Quad::draw();
-			initMoVecs->unbind();
-			glDepthMask(GL_TRUE);
-			glClear(GL_DEPTH_BUFFER_BIT);
+		if (!render_points) {
+			// nothing reads the point rendering this frame
 		}
-
-
-		fbo_res0->bind();
-		// choose shader according to gui
-		Shader& curShader = (gui_params_ir.mipmap_motion) ? drawPCmultiMotionShader : drawPCmultiShader;
-		if (gui_params_ir.enableCulling) pointClouds[gui_params_ir.lod]->cull(computeFrustumCullingShader, current_camera()->pos, current_camera()->dir, current_camera()->up,
-			current_camera()->near, current_camera()->far, current_camera()->fov_degree, dataset.camera_aspect_ratio);
-		pointClouds[gui_params_ir.lod]->bind(curShader);
-		//}
-		//----------------------------------------------------------------------
-		// bind shader and uniforms
-		curShader->bind();
-		curShader->uniform("proj", current_camera()->proj);
-		curShader->uniform("view", current_camera()->view);
-		curShader->uniform("view_normal", current_camera()->view_normal);
-
-		curShader->uniform("use_taa", gui_params_ir.use_taa);
-
-		//load old view if motion vecs are rendered
-		curShader->uniform("resolution", gui_params_ir.res0);
-		if (gui_params_ir.mipmap_motion) {
-			int base_index = 0;
-			if (gui_params_ir.use_taa) {
-				curShader->uniform("view_old_1", view_old);
-				base_index = -1;
-			}
-			else {
-				curShader->uniform("view_old_1", getView(nearest_views[base_index + int(gui_params_ir.skipNearest)].id));
-			}
-			curShader->uniform("view_old_2", getView(nearest_views[base_index + 1 + int(gui_params_ir.skipNearest)].id));
-			curShader->uniform("view_old_3", getView(nearest_views[base_index + 2 + int(gui_params_ir.skipNearest)].id));
-			curShader->uniform("view_old_4", getView(nearest_views[base_index + 3 + int(gui_params_ir.skipNearest)].id));
-			curShader->uniform("view_old_5", getView(nearest_views[base_index + 4 + int(gui_params_ir.skipNearest)].id));
-			curShader->uniform("view_old_6", getView(nearest_views[base_index + 5 + int(gui_params_ir.skipNearest)].id));
-
-			curShader->uniform("proj_old", dataset.gt_proj);
+		else if (cpu_raster) {
+			// software rasterizer: the same targets on the cpu, uploaded into the used part of fbo_res0
+			raster_params.color = true;
+			raster_params.motion = gui_params_ir.mipmap_motion;
+			raster_params.pre_init_motion = gui_params_ir.preInitMV;
+			raster_params.motion_clear = vec4(0, 0, 0, 1);
+			software_rasterizer.render(cpu_points[gui_params_ir.lod], gui_params_ir.res0, raster_params);
+			ir_upload(fbo_res0->color_textures[0], gui_params_ir.res0, software_rasterizer.color.data());
+			ir_upload(fbo_res0->color_textures[1], gui_params_ir.res0, software_rasterizer.depth_color.data());
+			if (gui_params_ir.mipmap_motion)
+				for (int i = 0; i < motion_count; ++i)
+					ir_upload(fbo_res0->color_textures[2 + i], gui_params_ir.res0, software_rasterizer.motion[i].data());
+			ir_upload(fbo_res0->depth_texture, gui_params_ir.res0, software_rasterizer.depth.data());
 		}
 		else {
-			curShader->uniform("view_old", view_old);
+			// preinit movecs in 
+			if (gui_params_ir.mipmap_motion && gui_params_ir.preInitMV) {
+				glDepthMask(GL_FALSE);
+				initMoVecs->bind();
+				set_motion_uniforms(initMoVecs, gui_params_ir.res0, motion_count);
+				Quad::draw();
+				initMoVecs->unbind();
+				glDepthMask(GL_TRUE);
+				glClear(GL_DEPTH_BUFFER_BIT);
+			}
 
-		}
-		
-		curShader->uniform("gt_timestamp_max", gt_timestamp_max);
-		curShader->uniform("gt_timestamp_min", gt_timestamp_min);
-		curShader->uniform("use_timestamp", gui_params_ir.use_timestamp);
 
+			// choose shader according to gui
+			Shader& curShader = (gui_params_ir.mipmap_motion) ? drawPCmultiMotionShader : drawPCmultiShader;
+			//----------------------------------------------------------------------
+			// bind shader and uniforms
+			curShader->bind();
+			set_motion_uniforms(curShader, gui_params_ir.res0, motion_count);
+			//old view of the single motion target without mipmapped motion
+			if (!gui_params_ir.mipmap_motion)
+				curShader->uniform("view_old", view_old);
+			// the pre-pass draws the occluders with the same shader and uniforms, so it has the depths of the point pass
+			pointClouds[gui_params_ir.lod]->bind(curShader);
+			const OcclusionCuller* occlusion = ir_occlusion_prepass(pointClouds[gui_params_ir.lod], occlusion_culler, frame_camera.proj * frame_camera.view,
+				dataset.camera_aspect_ratio);
+			ir_cull(pointClouds[gui_params_ir.lod], computeFrustumCullingShader, dataset.camera_aspect_ratio, occlusion, true);
+			// the culling uses texture unit 0 and its own program
+			pointClouds[gui_params_ir.lod]->bind(curShader);
+			curShader->bind();
+
+			fbo_res0->bind();
+			if (gui_params_ir.mipmap_motion) ir_draw_buffers(fbo_res0, 2, motion_count);
+			glViewport(0, 0, gui_params_ir.res0.x, gui_params_ir.res0.y);
 
-		//----------------------------------------------------------------------
-		// draw PointCloud 
 
+			//----------------------------------------------------------------------
+			// draw PointCloud 
 
-		pointClouds[gui_params_ir.lod]->draw();
-		pointClouds[gui_params_ir.lod]->unbind();
-		//}
-		curShader->unbind();
+
+			pointClouds[gui_params_ir.lod]->draw();
+			pointClouds[gui_params_ir.lod]->unbind();
+			//}
+			curShader->unbind();
+		}
 
 		//----------------------------------------------------------------------
 
@@ -1772,30 +2128,40 @@ void InferenceRenderer::run(int argc, char** argv) {
 		// mip map lower resolutions
 		glClearDepth(1);
 
-		fbo_res1->bind();
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		bool motion_pixelwise = false;
-		if (gui_params_ir.mipmap_motion)
-			ir_mipmap_with_motion(fbo_res0->color_textures[0], fbo_res0->color_textures[2], fbo_res0->color_textures[3], fbo_res0->color_textures[4], fbo_res0->color_textures[5], fbo_res0->color_textures[6], fbo_res0->color_textures[7], fbo_res0->depth_texture, gui_params_ir.res0, gui_params_ir.res1, motion_pixelwise);
-		else
-			ir_mipmap(fbo_res0->color_textures[0], fbo_res0->depth_texture, gui_params_ir.res0, gui_params_ir.res1);
-		fbo_res1->unbind();
-
-		fbo_res2->bind();
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		if (gui_params_ir.mipmap_motion)
-			ir_mipmap_with_motion(fbo_res1->color_textures[0], fbo_res1->color_textures[2], fbo_res1->color_textures[3], fbo_res1->color_textures[4], fbo_res1->color_textures[5], fbo_res1->color_textures[6], fbo_res1->color_textures[7], fbo_res1->depth_texture, gui_params_ir.res1, gui_params_ir.res2, motion_pixelwise);
-		else
-			ir_mipmap(fbo_res1->color_textures[0], fbo_res1->depth_texture, gui_params_ir.res1, gui_params_ir.res2);
-		fbo_res2->unbind();
-
-		fbo_res3->bind();
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		if (gui_params_ir.mipmap_motion)
-			ir_mipmap_with_motion(fbo_res2->color_textures[0], fbo_res2->color_textures[2], fbo_res2->color_textures[3], fbo_res2->color_textures[4], fbo_res2->color_textures[5], fbo_res2->color_textures[6], fbo_res2->color_textures[7], fbo_res2->depth_texture, gui_params_ir.res2, gui_params_ir.res3, motion_pixelwise);
-		else
-			ir_mipmap(fbo_res2->color_textures[0], fbo_res2->depth_texture, gui_params_ir.res2, gui_params_ir.res3);
-		fbo_res3->unbind();
+		if (render_graph.enabled("mip1")) {
+			fbo_res1->bind();
+			ir_draw_buffers(fbo_res1, 2, gui_params_ir.mipmap_motion && motion_level >= 1 ? motion_count : 0);
+			glViewport(0, 0, gui_params_ir.res1.x, gui_params_ir.res1.y);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			if (gui_params_ir.mipmap_motion && motion_level >= 1)
+				ir_mipmap_with_motion(fbo_res0->color_textures[0], fbo_res0->color_textures[2], fbo_res0->color_textures[3], fbo_res0->color_textures[4], fbo_res0->color_textures[5], fbo_res0->color_textures[6], fbo_res0->color_textures[7], fbo_res0->depth_texture, gui_params_ir.res0, gui_params_ir.res1, motion_pixelwise, motion_count);
+			else
+				ir_mipmap(fbo_res0->color_textures[0], fbo_res0->depth_texture, gui_params_ir.res0, gui_params_ir.res1);
+			fbo_res1->unbind();
+		}
+		if (render_graph.enabled("mip2")) {
+			fbo_res2->bind();
+			ir_draw_buffers(fbo_res2, 2, gui_params_ir.mipmap_motion && motion_level >= 2 ? motion_count : 0);
+			glViewport(0, 0, gui_params_ir.res2.x, gui_params_ir.res2.y);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			if (gui_params_ir.mipmap_motion && motion_level >= 2)
+				ir_mipmap_with_motion(fbo_res1->color_textures[0], fbo_res1->color_textures[2], fbo_res1->color_textures[3], fbo_res1->color_textures[4], fbo_res1->color_textures[5], fbo_res1->color_textures[6], fbo_res1->color_textures[7], fbo_res1->depth_texture, gui_params_ir.res1, gui_params_ir.res2, motion_pixelwise, motion_count);
+			else
+				ir_mipmap(fbo_res1->color_textures[0], fbo_res1->depth_texture, gui_params_ir.res1, gui_params_ir.res2);
+			fbo_res2->unbind();
+		}
+		if (render_graph.enabled("mip3")) {
+			fbo_res3->bind();
+			ir_draw_buffers(fbo_res3, 2, gui_params_ir.mipmap_motion && motion_level >= 3 ? motion_count : 0);
+			glViewport(0, 0, gui_params_ir.res3.x, gui_params_ir.res3.y);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			if (gui_params_ir.mipmap_motion && motion_level >= 3)
+				ir_mipmap_with_motion(fbo_res2->color_textures[0], fbo_res2->color_textures[2], fbo_res2->color_textures[3], fbo_res2->color_textures[4], fbo_res2->color_textures[5], fbo_res2->color_textures[6], fbo_res2->color_textures[7], fbo_res2->depth_texture, gui_params_ir.res2, gui_params_ir.res3, motion_pixelwise, motion_count);
+			else
+				ir_mipmap(fbo_res2->color_textures[0], fbo_res2->depth_texture, gui_params_ir.res2, gui_params_ir.res3);
+			fbo_res3->unbind();
+		}
 
 
 		timerMipMap->end();
@@ -1803,127 +2169,211 @@ void InferenceRenderer::run(int argc, char** argv) {
 		//----------------------------------------------------------------------
 		// Inference of the CNN
 
+		// output of this frame for the precision report, compared with the fp32 reference after the inference timing
+		torch::Tensor precision_output;
+		std::shared_ptr<NetworkLoader::Network> precision_network;
 		timerInference->begin();
 		if (doInference)
 		{
-			if ((gui_params_ir.displayMode == 0 && gui_params_ir.currentRenderInfo == 17) || (gui_params_ir.displayMode == 1 && gui_params_ir.currentRenderInfo >= 2)) {
+			const bool inference_needed = (gui_params_ir.displayMode == 0 && gui_params_ir.currentRenderInfo == 17) || (gui_params_ir.displayMode == 1 && gui_params_ir.currentRenderInfo >= 2);
+			if (!gui_params_ir.pipelined_inference && pipeline.in_flight() > 0) pipeline.flush(); // pipelining was switched off
+			// the selected network is loaded in the background on first use, no inference until it is ready (offline: waits for it)
+			std::shared_ptr<NetworkLoader::Network> loaded_network = offline_job ? network_loader.wait(gui_params_ir.network_id) : network_loader.get(gui_params_ir.network_id);
+			gui_params_ir.network_loading = network_loader.loading(gui_params_ir.network_id);
+			gui_params_ir.network_error = network_loader.error(gui_params_ir.network_id);
+			const size_t network_capacity = size_t(gui_params_ir.network_memory_mb) << 20;
+			network_loader.set_capacity(network_capacity);
+			// the optimized copies of the network cache count towards the same limit
+			const size_t loaded_bytes = network_loader.loaded_bytes();
+			network_cache.set_capacity_bytes(network_capacity - std::min(network_capacity, loaded_bytes));
+			gui_params_ir.network_memory_info = glm::ivec2(network_loader.loaded_count(), int((loaded_bytes + network_cache.bytes) >> 20));
+			for (int evicted : network_loader.take_evicted())
+				network_cache.erase(evicted);
+			const bool batched = ir_capture_batched();
+			if (!batched && !batched_inference.empty()) batched_inference.clear(); // capture was stopped within a batch
+			if ((inference_needed || batched) && loaded_network) {
 				try {
-					using namespace torch::indexing;
+					const int groundtruth_amount = gui_params_ir.network_groundtruth_amount[gui_params_ir.network_id];
+					if (groundtruth_amount < 1) {
+						std::cerr << "[InferenceRenderer] FATAL ERROR: amount of ground truth imges not supported: " << groundtruth_amount << ", should be at least 1." << std::endl;
+						return;
+					}
+					auto motion_fbo = gui_params_ir.mipmap_motion ? Framebuffer::find("fbo_res" + std::to_string(gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id])) : fbo_motion;
+					int motion_offset = gui_params_ir.mipmap_motion ? 2 : 0;
+					int start_i = (gui_params_ir.use_taa) ? 1 : 0; // if taa, use nearest images [0:gta-1] and corresponding movecs: [1:gta] 
+					const bool split = !gui_params_ir.network_encoder_filenames[gui_params_ir.network_id].empty();
+
 					//---------------------------------------------------------------------------
-					// create input for different resolutions
-					torch::Tensor tensor_res0_rgb = texture2D_to_tensor(fbo_res0->color_textures[0], -1, -1, -1);
-					torch::Tensor tensor_res1_rgb = texture2D_to_tensor(fbo_res1->color_textures[0], -1, -1, -1);
-					torch::Tensor tensor_res2_rgb = texture2D_to_tensor(fbo_res2->color_textures[0], -1, -1, -1);
-					torch::Tensor tensor_res3_rgb = texture2D_to_tensor(fbo_res3->color_textures[0], -1, -1, -1);
-					torch::Tensor tensor_res0_depth = texture2D_to_tensor(fbo_res0->color_textures[1], -1, -1, -1);
-					torch::Tensor tensor_res1_depth = texture2D_to_tensor(fbo_res1->color_textures[1], -1, -1, -1);
-					torch::Tensor tensor_res2_depth = texture2D_to_tensor(fbo_res2->color_textures[1], -1, -1, -1);
-					torch::Tensor tensor_res3_depth = texture2D_to_tensor(fbo_res3->color_textures[1], -1, -1, -1);
-
-					tensor_res0_rgb = tensor_res0_rgb.index({ Slice(0,3),Slice(),Slice() }).unsqueeze(0);
-					tensor_res1_rgb = tensor_res1_rgb.index({ Slice(0,3),Slice(),Slice() }).unsqueeze(0);
-					tensor_res2_rgb = tensor_res2_rgb.index({ Slice(0,3),Slice(),Slice() }).unsqueeze(0);
-					tensor_res3_rgb = tensor_res3_rgb.index({ Slice(0,3),Slice(),Slice() }).unsqueeze(0);
-					tensor_res0_depth = tensor_res0_depth.index({ Slice(0,1),Slice(),Slice() }).unsqueeze(0);
-					tensor_res1_depth = tensor_res1_depth.index({ Slice(0,1),Slice(),Slice() }).unsqueeze(0);
-					tensor_res2_depth = tensor_res2_depth.index({ Slice(0,1),Slice(),Slice() }).unsqueeze(0);
-					tensor_res3_depth = tensor_res3_depth.index({ Slice(0,1),Slice(),Slice() }).unsqueeze(0);
-
-					torch::Tensor tensor_res0 = torch::cat({ tensor_res0_rgb,tensor_res0_depth }, 1);
-					torch::Tensor tensor_res1 = torch::cat({ tensor_res1_rgb,tensor_res1_depth }, 1);
-					torch::Tensor tensor_res2 = torch::cat({ tensor_res2_rgb,tensor_res2_depth }, 1);
-					torch::Tensor tensor_res3 = torch::cat({ tensor_res3_rgb,tensor_res3_depth }, 1);
-
-					std::vector <torch::Tensor> tensors_groundtruth;
-					std::vector <torch::Tensor> tensors_motion;
-
-					torch::Tensor output_tensor;
-					std::vector<torch::jit::IValue> inputs;
-					if (gui_params_ir.use_taa) {
-						tensors_groundtruth.push_back(texture2D_to_tensor(fbo_prev->color_textures[0], -1, -1, -1)); // rgb output
-						tensors_groundtruth[0] = tensors_groundtruth[0].index({ Slice(0,3),Slice(),Slice() }).unsqueeze(0); // crop to 3 channels
-
-						torch::Tensor tensor_groundtruth_depth = texture2D_to_tensor(fbo_prev->color_textures[1], -1, -1, -1); // depth of previous image
-						tensor_groundtruth_depth = tensor_groundtruth_depth.index({ Slice(0,1),Slice(),Slice() }).unsqueeze(0); // crop to 1 channel
-
-						tensors_groundtruth[0] = torch::cat({ tensors_groundtruth[0],tensor_groundtruth_depth }, 1); // cat prev rgb and depth
-
-						if (gui_params_ir.mipmap_motion) {
-							auto cur_fbo = Framebuffer::find("fbo_res" + std::to_string(gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id]));
-							tensors_motion.push_back(texture2D_to_tensor(cur_fbo->color_textures[2], -1, -1, -1));
+					// without interop: queue all downloads before the first readback, so the transfers are pipelined
+					// the motion of the cpu mip map is downsampled from res0
+					auto motion_source = cpu_mipmap && gui_params_ir.mipmap_motion ? fbo_res0 : motion_fbo;
+					if (!inference_device.is_cuda()) {
+						for (auto& fbo : { fbo_res0, fbo_res1, fbo_res2, fbo_res3 }) {
+							texture2D_request_readback(fbo->color_textures[0]);
+							texture2D_request_readback(fbo->color_textures[1]);
+							if (cpu_mipmap) break;
 						}
-						else {
-							tensors_motion.push_back(texture2D_to_tensor(fbo_motion->color_textures[0], -1, -1, -1));
+						if (gui_params_ir.use_taa) {
+							texture2D_request_readback(fbo_prev->color_textures[0]);
+							texture2D_request_readback(fbo_prev->color_textures[1]);
 						}
+						for (int i = 0; i < groundtruth_amount; ++i) {
+							texture2D_request_readback(motion_source->color_textures[motion_offset + i]);
+							if (i >= start_i) {
+								const int view_id = nearest_views[i + int(gui_params_ir.skipNearest) - start_i].id;
+								const Texture2D& tex = dataset.cam_views[view_id].tex_gpu;
+								if (!split || !feature_cache.contains(gui_params_ir.network_id, view_id, glm::ivec2(tex->w, tex->h)))
+									texture2D_request_readback(tex);
+							}
+						}
+					}
 
-						tensors_motion[0] = tensors_motion[0].index({ Slice(0,gui_params_ir.network_movec_channels[gui_params_ir.network_id]),Slice(),Slice() }).unsqueeze(0).contiguous();
+					//---------------------------------------------------------------------------
+					// pack the inputs in place into the persistent arena (of the next pipeline slot if pipelined)
+					InferencePipeline::Slot* slot = (gui_params_ir.pipelined_inference && !batched) ? &pipeline.acquire() : nullptr;
+					if (batched && batched_inference.empty())
+						batched_inference.configure(BatchedInference::batch_size_from_budget(size_t(gui_params_ir.batch_memory_mb) << 20,
+							gui_params_ir.network_memory_per_pixel[gui_params_ir.network_id], gui_params_ir.res0, gui_params_ir.batch_max));
+					NetworkInputArena& arena = batched ? batched_inference.next("./out/neural_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/neural/" + dataset.cam_names[gui_params_ir.captureByIndexCurrent] + ".png")
+						: slot ? slot->arena : input_arena;
+					arena.configure(groundtruth_amount, gui_params_ir.network_movec_channels[gui_params_ir.network_id], inference_device, gui_params_ir.channels_last, split, gui_params_ir.preInitMV);
+					// render targets only use the part of the current render scale
+					const ivec2 motion_res = ir_level_resolution(gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id]);
+					const bool pyramid_motion = cpu_mipmap && gui_params_ir.mipmap_motion;
+					if (cpu_mipmap) {
+						std::vector<Texture2D> motion_tex;
+						for (int i = 0; pyramid_motion && i < groundtruth_amount; ++i)
+							motion_tex.push_back(fbo_res0->color_textures[motion_offset + i]);
+						arena.pack_pyramid(fbo_res0->color_textures[0], fbo_res0->color_textures[1], motion_tex,
+							{ gui_params_ir.res0, gui_params_ir.res1, gui_params_ir.res2, gui_params_ir.res3 }, gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id]);
+					}
+					else {
+						arena.pack_resolution(0, fbo_res0->color_textures[0], fbo_res0->color_textures[1], gui_params_ir.res0);
+						arena.pack_resolution(1, fbo_res1->color_textures[0], fbo_res1->color_textures[1], gui_params_ir.res1);
+						arena.pack_resolution(2, fbo_res2->color_textures[0], fbo_res2->color_textures[1], gui_params_ir.res2);
+						arena.pack_resolution(3, fbo_res3->color_textures[0], fbo_res3->color_textures[1], gui_params_ir.res3);
+					}
+					if (gui_params_ir.use_taa)
+						arena.pack_groundtruth(0, fbo_prev->color_textures[0], fbo_prev->color_textures[1], gui_params_ir.res0); // rgb and depth of the previous output
+					for (int i = 0; i < groundtruth_amount; ++i) {
+						if (i >= start_i && !split)
+							arena.pack_groundtruth(i, dataset.cam_views[nearest_views[i + int(gui_params_ir.skipNearest) - start_i].id].tex_gpu);
+						if (!pyramid_motion)
+							arena.pack_motion(i, motion_fbo->color_textures[motion_offset + i], motion_res, gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id]);
+					}
+					if (split) {
+						// split network: the auxiliary views are encoded once and taken from the cache, the previous output (taa) every frame
+						auto encode = [&](int i) {
+							torch::NoGradGuard no_grad;
+							PrecisionGuard precision_guard(gui_params_ir.network_precision[gui_params_ir.network_id], inference_device);
+							return loaded_network->encoder.forward({ arena.groundtruth[i] }).toTensor();
+						};
+						feature_cache.capacity_bytes = size_t(gui_params_ir.feature_cache_mb) << 20;
+						feature_cache.trim();
+						for (int i = 0; i < groundtruth_amount; ++i) {
+							if (i < start_i) {
+								arena.set_features(i, encode(i));
+								continue;
+							}
+							const int view_id = nearest_views[i + int(gui_params_ir.skipNearest) - start_i].id;
+							const Texture2D& tex = dataset.cam_views[view_id].tex_gpu;
+							arena.set_features(i, feature_cache.get(gui_params_ir.network_id, view_id, glm::ivec2(tex->w, tex->h), [&]() {
+								arena.pack_groundtruth(i, tex);
+								return encode(i);
+							}));
+						}
 					}
-					int start_i = (gui_params_ir.use_taa) ? 1 : 0; // if taa, use nearest images [0:gta-1] and corresponding movecs: [1:gta] 
-					for (int i = start_i; i < gui_params_ir.network_groundtruth_amount[gui_params_ir.network_id]; ++i) {
-						tensors_groundtruth.push_back(texture2D_to_tensor(dataset.cam_views[nearest_views[i + int(gui_params_ir.skipNearest) - start_i].id].tex_gpu, -1, -1, -1).unsqueeze(0).contiguous());
 
-						if (gui_params_ir.mipmap_motion) {
-							auto cur_fbo = Framebuffer::find("fbo_res" + std::to_string(gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id]));
-							tensors_motion.push_back(texture2D_to_tensor(cur_fbo->color_textures[2 + i], -1, -1, -1));
+					//---------------------------------------------------------------------------
+					// optimized network, warmed up on its first use with each input resolution and tiling (the executor specializes per shape)
+					NetworkPrecision precision = gui_params_ir.network_precision[gui_params_ir.network_id];
+					// tile size from the memory budget, the halo covers the receptive field of the network
+					const int halo = gui_params_ir.network_receptive_field[gui_params_ir.network_id];
+					const int tile_size = TiledInference::tile_size_from_budget(size_t(gui_params_ir.tile_memory_budget_mb) << 20, gui_params_ir.network_memory_per_pixel[gui_params_ir.network_id], halo,
+						TiledInference::parallel_tiles(gui_params_ir.tile_threads, inference_device));
+					if (network_cache.optimize != gui_params_ir.optimize_networks) {
+						network_cache.optimize = gui_params_ir.optimize_networks;
+						network_cache.clear();
+					}
+					network_cache.warmup_passes = gui_params_ir.warmup_passes;
+					torch::jit::script::Module& network = network_cache.get(gui_params_ir.network_id, loaded_network->module, loaded_network->module_bytes);
+					const bool tiled = gui_params_ir.tiled_inference && !slot && !batched;
+					const std::vector<int64_t> shape = { gui_params_ir.res0.x, gui_params_ir.res0.y, tiled ? tile_size : 0 };
+					network_cache.warm_up(gui_params_ir.network_id, shape, [&](torch::jit::script::Module& module) {
+						if (tiled) {
+							tiled_inference.run(module, arena, precision, inference_device, tile_size, halo, std::min(32, halo), gui_params_ir.tile_threads);
 						}
 						else {
-							tensors_motion.push_back(texture2D_to_tensor(fbo_motion->color_textures[i], -1, -1, -1));
+							PrecisionGuard precision_guard(precision, inference_device);
+							module.forward(arena.inputs());
 						}
-
-						tensors_motion[i] = tensors_motion[i].index({ Slice(0,gui_params_ir.network_movec_channels[gui_params_ir.network_id]),Slice(),Slice() }).unsqueeze(0).contiguous();
-					}
-
-					inputs.push_back(c10::ivalue::Tuple::create(tensor_res0, tensor_res1, tensor_res2, tensor_res3));
-					switch (gui_params_ir.network_groundtruth_amount[gui_params_ir.network_id]) {
-					case 1:
-						inputs.push_back(c10::ivalue::Tuple::create(tensors_groundtruth[0]));
-						inputs.push_back(c10::ivalue::Tuple::create(tensors_motion[0]));
-						break;
-					case 2:
-						inputs.push_back(c10::ivalue::Tuple::create(tensors_groundtruth[0], tensors_groundtruth[1]));
-						inputs.push_back(c10::ivalue::Tuple::create(tensors_motion[0], tensors_motion[1]));
-						break;
-					case 3:
-						inputs.push_back(c10::ivalue::Tuple::create(tensors_groundtruth[0], tensors_groundtruth[1], tensors_groundtruth[2]));
-						inputs.push_back(c10::ivalue::Tuple::create(tensors_motion[0], tensors_motion[1], tensors_motion[2]));
-						break;
-					case 4:
-						inputs.push_back(c10::ivalue::Tuple::create(tensors_groundtruth[0], tensors_groundtruth[1], tensors_groundtruth[2], tensors_groundtruth[3]));
-						inputs.push_back(c10::ivalue::Tuple::create(tensors_motion[0], tensors_motion[1], tensors_motion[2], tensors_motion[3]));
-						break;
-					case 5:
-						inputs.push_back(c10::ivalue::Tuple::create(tensors_groundtruth[0], tensors_groundtruth[1], tensors_groundtruth[2], tensors_groundtruth[3], tensors_groundtruth[4]));
-						inputs.push_back(c10::ivalue::Tuple::create(tensors_motion[0], tensors_motion[1], tensors_motion[2], tensors_motion[3], tensors_motion[4]));
-						break;
-					case 6:
-						inputs.push_back(c10::ivalue::Tuple::create(tensors_groundtruth[0], tensors_groundtruth[1], tensors_groundtruth[2], tensors_groundtruth[3], tensors_groundtruth[4], tensors_groundtruth[5]));
-						inputs.push_back(c10::ivalue::Tuple::create(tensors_motion[0], tensors_motion[1], tensors_motion[2], tensors_motion[3], tensors_motion[4], tensors_motion[5]));
-						break;
-					default:
-						std::cerr << "[InferenceRenderer] FATAL ERROR: amount of ground truth imges not supported: " << gui_params_ir.network_groundtruth_amount[gui_params_ir.network_id] << ", should be in [1,2,3,4,5,6]." << std::endl;
-						return;
-
+					});
+					gui_params_ir.warmup_ms = network_cache.last_warmup_ms;
+					if (split) {
+						uint64_t lookups = feature_cache.hits + feature_cache.misses;
+						gui_params_ir.feature_cache_info = glm::vec3(float(feature_cache.size()), float(feature_cache.bytes >> 20), lookups > 0 ? float(feature_cache.hits) / float(lookups) : 0.f);
 					}
 
 					//---------------------------------------------------------------------------
 					// do the inference
-					output_tensor = renderer_traces[gui_params_ir.network_id].forward(inputs).toTensor();
-					output_tensor = output_tensor.squeeze(0).contiguous();
-					output_tensor = torch::cat({ output_tensor, torch::ones({1, output_tensor.sizes()[1], output_tensor.sizes()[2]}).to(torch::kCUDA) }, 0);
-					tensor_to_texture2D(output_tensor.contiguous(), fbo_out->color_textures[0], gui_params_ir.res0.y, gui_params_ir.res0.x, false);
-					//---------------------------------------------------------------------------
-
-
-					//---------------------------------------------------------------------------
-					// Copy Point Rendered Depth to fbo_out for TAA
-					texture_to_texture(fbo_res0->color_textures[1]->id, fbo_out->color_textures[1]->id, gui_params_ir.res0.y, gui_params_ir.res0.x);
-					//---------------------------------------------------------------------------
-
+					if (batched) {
+						// offline: the inputs of this pose wait in their slot until the batch is full or the capture ends
+						const int next_index = gui_params_ir.captureByIndexCurrent + gui_params_ir.captureByIndexStep;
+						const bool last_pose = next_index >= dataset.camCount || next_index > gui_params_ir.captureByIndexEnd;
+						if (batched_inference.full() || last_pose) {
+							torch::Tensor output_tensor = batched_inference.run(network, precision, inference_device);
+							forward_ms = batched_inference.last.forward_ms;
+							if (gui_params_ir.batch_benchmark && gui_params_ir.batch_sweep.empty() && batched_inference.filled > 1) {
+								batched_inference.benchmark(network, precision, inference_device);
+								for (const auto& t : batched_inference.sweep)
+									gui_params_ir.batch_sweep.push_back(glm::vec2(float(t.batch_size), float(t.frames_per_second)));
+							}
+							for (int b = 0; b < batched_inference.filled; ++b) {
+								BatchedInference::Slot& batch_slot = batched_inference.slot(b);
+								batch_slot.arena.unpack_output(output_tensor[b], fbo_out->color_textures[0], gui_params_ir.res0);
+								if (!std::filesystem::exists(batch_slot.tag))
+									capture_writer.write(fbo_out->color_textures[0], batch_slot.tag, CaptureWriter::PNG_RGB);
+							}
+							gui_params_ir.batch_info = glm::vec2(float(batched_inference.last.batch_size), float(batched_inference.last.frames_per_second));
+							batched_inference.clear();
+							texture_to_texture(fbo_res0->color_textures[1]->id, fbo_out->color_textures[1]->id, gui_params_ir.res0.y, gui_params_ir.res0.x);
+							out_view = current_camera()->view;
+						}
+					}
+					else if (slot) {
+						// pipelined (always full frame): the worker runs the forward pass while the next frame is rendered
+						texture_to_texture(fbo_res0->color_textures[1]->id, fbo_pipeline_depth->color_textures[slot->index]->id, gui_params_ir.res0.y, gui_params_ir.res0.x);
+						slot->view = current_camera()->view;
+						slot->resolution = gui_params_ir.res0;
+						pipeline.submit(*slot, network, precision, inference_device);
+					}
+					else {
+						torch::Tensor output_tensor;
+						auto forward_start = std::chrono::steady_clock::now();
+						if (gui_params_ir.tiled_inference) {
+							output_tensor = tiled_inference.run(network, input_arena, precision, inference_device, tile_size, halo, std::min(32, halo), gui_params_ir.tile_threads,
+								gui_params_ir.tile_selective_update, gui_params_ir.tile_change_tolerance);
+							gui_params_ir.tile_info = glm::ivec2(int(tiled_inference.tiles.size()), tiled_inference.tile_size);
+							gui_params_ir.tile_skipped_fraction = tiled_inference.tiles.empty() ? 0.f : 1.f - float(tiled_inference.tiles_inferred) / float(tiled_inference.tiles.size());
+							gui_params_ir.tile_time_saved_ms = float(tiled_inference.time_saved_ms);
+						}
+						else {
+							PrecisionGuard precision_guard(precision, inference_device);
+							output_tensor = network.forward(input_arena.inputs()).toTensor();
+						}
+						forward_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - forward_start).count();
+						if (gui_params_ir.precision_report && loaded_network->has_reference) {
+							precision_output = output_tensor;
+							precision_network = loaded_network;
+						}
+						input_arena.unpack_output(output_tensor, fbo_out->color_textures[0], gui_params_ir.res0);
 
+						//---------------------------------------------------------------------------
+						// Copy Point Rendered Depth to fbo_out for TAA
+						texture_to_texture(fbo_res0->color_textures[1]->id, fbo_out->color_textures[1]->id, gui_params_ir.res0.y, gui_params_ir.res0.x);
+						out_view = current_camera()->view;
+					}
 					//---------------------------------------------------------------------------
-					// transform output back to opengl format
-
-
 				}
 				catch (const c10::Error& e) {
 					std::cerr << "error loading the model\n";
@@ -1932,9 +2382,39 @@ void InferenceRenderer::run(int argc, char** argv) {
 					return;
 				}
 			}
+
+			//---------------------------------------------------------------------------
+			// pipelined: present the output of the previous frame, keep the current frame in flight
+			if (gui_params_ir.pipelined_inference) {
+				InferencePipeline::Slot* result = pipeline.pop_result(inference_needed ? 1 : 0);
+				if (result) {
+					forward_ms = result->forward_ms;
+					if (!result->error.empty()) {
+						std::cerr << "[InferenceRenderer] FATAL ERROR: pipelined inference failed: " << result->error << std::endl;
+						return;
+					}
+					// frames rendered before a resize are dropped
+					if (result->resolution == gui_params_ir.res0) {
+						result->arena.unpack_output(result->output, fbo_out->color_textures[0], result->resolution);
+						texture_to_texture(fbo_pipeline_depth->color_textures[result->index]->id, fbo_out->color_textures[1]->id, gui_params_ir.res0.y, gui_params_ir.res0.x);
+						out_view = result->view;
+					}
+				}
+			}
 		}
 		timerInference->end();
 
+		// fp32 reference pass of the precision report, not part of the inference time
+		if (precision_output.defined()) {
+			try {
+				torch::Tensor reference_tensor = precision_network->reference.forward(input_arena.inputs()).toTensor();
+				gui_params_ir.precision_psnr = network_psnr(precision_output, reference_tensor);
+			}
+			catch (const c10::Error& e) {
+				std::cerr << "[InferenceRenderer] WARNING: fp32 reference inference failed: " << e.what_without_backtrace() << std::endl;
+			}
+		}
+
 		//----------------------------------------------------------------------
 
 		timer->end();
@@ -1945,6 +2425,7 @@ void InferenceRenderer::run(int argc, char** argv) {
         // render debug frustum to neural view
         glLineWidth(2);
         fbo_res0->bind();
+        glViewport(0, 0, gui_params_ir.res0.x, gui_params_ir.res0.y);
         if (gui_params_ir.debug_camera_frustum_size_adjusted){
             frustum.frustum_data(dataset.gt_proj, gui_params_ir.debug_camera_frustum_size);
             gui_params_ir.debug_camera_frustum_size_adjusted = false;
@@ -2013,6 +2494,7 @@ void InferenceRenderer::run(int argc, char** argv) {
         fbo_res0->unbind();
         glDisable(GL_DEPTH_TEST);
         fbo_out_1->bind();
+        glViewport(0, 0, gui_params_ir.res0.x, gui_params_ir.res0.y);
         if (gui_params_ir.debug_camera_frustum_size_adjusted){
             frustum.frustum_data(dataset.gt_proj, gui_params_ir.debug_camera_frustum_size);
             gui_params_ir.debug_camera_frustum_size_adjusted = false;
@@ -2080,6 +2562,7 @@ void InferenceRenderer::run(int argc, char** argv) {
         }
         fbo_out_1->unbind();
         fbo_out_2->bind();
+        glViewport(0, 0, gui_params_ir.res0.x, gui_params_ir.res0.y);
         if (gui_params_ir.debug_camera_frustum_size_adjusted){
             frustum.frustum_data(dataset.gt_proj, gui_params_ir.debug_camera_frustum_size);
             gui_params_ir.debug_camera_frustum_size_adjusted = false;
@@ -2150,165 +2633,20 @@ void InferenceRenderer::run(int argc, char** argv) {
         glEnable(GL_DEPTH_TEST);
 
 		// draw
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);		
-		//ir_blit(fbo_res0->color_textures[0]);
-		ivec2 tmp_context_res = Context::resolution();
-		glViewport(0, 0, tmp_context_res.x, tmp_context_res.y);
-		if (gui_params_ir.displayMode == 0) { // Single output "0 Color Res0, 1:Color Res1, 2:Color Res2, 3:Color Res3, 4:Depth Res0, 5:Depth Res1, 6:Depth Res2, 7:Depth Res3, 8:Motion1, 9:Motion2, 10:Motion3, 11:Groundtruth1, 12:Groundtruth2, 13:Groundtruth3, 14:Output"
-			switch (gui_params_ir.currentRenderInfo) {
-			case 0: // Color Res0
-				ir_blit(fbo_res0->color_textures[0]);
-				break;
-			case 1: // Color Res1
-				ir_blit(fbo_res1->color_textures[0]);
-				break;
-			case 2: // Color Res2
-				ir_blit(fbo_res2->color_textures[0]);
-				break;
-			case 3: // Color Res3
-				ir_blit(fbo_res3->color_textures[0]);
-				break;
-			case 4: // Depth Res0
-				if(gui_params_ir.show_depth_bg_white)
-					ir_blit(fbo_res0->depth_texture);
-				else
-					ir_blit(fbo_res0->color_textures[1]);
-				break;
-			case 5: // Depth Res1
-				if (gui_params_ir.show_depth_bg_white)
-					ir_blit(fbo_res1->depth_texture);
-				else
-					ir_blit(fbo_res1->color_textures[1]);
-				break;
-			case 6: // Depth Res2
-				if (gui_params_ir.show_depth_bg_white)
-					ir_blit(fbo_res2->depth_texture);
-				else
-					ir_blit(fbo_res2->color_textures[1]);
-				break;
-			case 7: // Depth Res3
-				if (gui_params_ir.show_depth_bg_white)
-					ir_blit(fbo_res3->depth_texture);
-				else
-					ir_blit(fbo_res3->color_textures[1]);
-				break;
-			case 8: // Motion1
-				if(gui_params_ir.mipmap_motion) {
-					Framebuffer fbo = Framebuffer::find("fbo_res" + std::to_string(gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id]));
-					ir_blit(fbo->color_textures[2]);
-				}
-				else
-					ir_blit(fbo_motion->color_textures[0]);
-				break;
-			case 9: // Motion2
-				if (gui_params_ir.mipmap_motion) {
-					Framebuffer fbo = Framebuffer::find("fbo_res" + std::to_string(gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id]));
-					ir_blit(fbo->color_textures[3]);
-				}
-				else
-					ir_blit(fbo_motion->color_textures[1]);
-				break;
-			case 10: // Motion3
-				if (gui_params_ir.mipmap_motion) {
-					Framebuffer fbo = Framebuffer::find("fbo_res" + std::to_string(gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id]));
-					ir_blit(fbo->color_textures[4]);
-				}	
-				else
-					ir_blit(fbo_motion->color_textures[2]);
-				break;
-			case 11: // Groundtruth1
-				ir_blit(dataset.cam_views[nearest_views[0 + int(gui_params_ir.skipNearest)].id].tex_gpu);
-				break;
-			case 12: // Groundtruth2
-				ir_blit(dataset.cam_views[nearest_views[1 + int(gui_params_ir.skipNearest)].id].tex_gpu);
-				break;
-			case 13: // Groundtruth3
-				ir_blit(dataset.cam_views[nearest_views[2 + int(gui_params_ir.skipNearest)].id].tex_gpu);
-				break;
-			case 14: // Groundtruth Depth 1
-				ir_blit_depth(dataset.cam_views[nearest_views[0 + int(gui_params_ir.skipNearest)].id].tex_gpu);
-				break;
-			case 15: // Groundtruth Depth 2
-				ir_blit_depth(dataset.cam_views[nearest_views[1 + int(gui_params_ir.skipNearest)].id].tex_gpu);
-				break;
-			case 16: // Groundtruth Depth 3
-				ir_blit_depth(dataset.cam_views[nearest_views[2 + int(gui_params_ir.skipNearest)].id].tex_gpu);
-				break;
-			case 17: // Output
-				ir_blit(fbo_out->color_textures[0]);
-				break;
-			}
-		}
-		else { // Multi Output "0:Color, 1:Depth, 2:Motion, 3:Groundtruth, 4:Output"
-			switch (gui_params_ir.currentRenderInfo) {
-			case 0: // Color
-				ir_blit_multi(fbo_res0->color_textures[0], fbo_res1->color_textures[0], fbo_res2->color_textures[0], fbo_res3->color_textures[0]);
-				break;
-			case 1: // Depth
-				if (gui_params_ir.show_depth_bg_white) {
-					ir_blit_multi(fbo_res0->depth_texture, fbo_res1->depth_texture, fbo_res2->depth_texture, fbo_res3->depth_texture);
-				}
-				else {
-					ir_blit_multi(fbo_res0->color_textures[1], fbo_res1->color_textures[1], fbo_res2->color_textures[1], fbo_res3->color_textures[1]);
-				}
-				break;
-			case 2: // Motion
-				if (gui_params_ir.mipmap_motion) {
-					Framebuffer fbo = Framebuffer::find("fbo_res" + std::to_string(gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id]));
-					ir_blit_multi(fbo_out->color_textures[0], fbo->color_textures[2], fbo->color_textures[3], fbo->color_textures[4]);
-				}
-				else
-					ir_blit_multi(fbo_out->color_textures[0], fbo_motion->color_textures[0], fbo_motion->color_textures[1], fbo_motion->color_textures[2]);
-				break;
-			case 3: // Motion 2
-				if (gui_params_ir.mipmap_motion) {
-					Framebuffer fbo = Framebuffer::find("fbo_res" + std::to_string(gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id]));
-					ir_blit_multi(fbo_out->color_textures[0], fbo->color_textures[5], fbo->color_textures[6], fbo->color_textures[7]);
-				}
-				else
-					ir_blit_multi(fbo_out->color_textures[0], fbo_motion->color_textures[3], fbo_motion->color_textures[4], fbo_motion->color_textures[5]);
-				break;
-			case 4: // Groundtruth
-				if (gui_params_ir.use_taa) {
-					ir_blit_multi(fbo_out->color_textures[0], fbo_prev->color_textures[0], dataset.cam_views[nearest_views[0 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[1 + int(gui_params_ir.skipNearest)].id].tex_gpu);
-				}
-				else {
-					ir_blit_multi(fbo_out->color_textures[0], dataset.cam_views[nearest_views[0 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[1 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[2 + int(gui_params_ir.skipNearest)].id].tex_gpu);
-				}
-				break;
-			case 5: // Groundtruth 2
-				if (gui_params_ir.use_taa) {
-					ir_blit_multi(fbo_out->color_textures[0], dataset.cam_views[nearest_views[2 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[3 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[4 + int(gui_params_ir.skipNearest)].id].tex_gpu);
-				}
-				else {
-					ir_blit_multi(fbo_out->color_textures[0], dataset.cam_views[nearest_views[3 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[4 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[5 + int(gui_params_ir.skipNearest)].id].tex_gpu);
-				}
-				break;
-			case 6: // Groundtruth Depth
-				if (gui_params_ir.use_taa) {
-					ir_blit_multi_depth(fbo_out->color_textures[0], fbo_prev->color_textures[1], dataset.cam_views[nearest_views[0 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[1 + int(gui_params_ir.skipNearest)].id].tex_gpu);
-				}
-				else {
-					ir_blit_multi_depth(fbo_out->color_textures[0], dataset.cam_views[nearest_views[0 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[1 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[2 + int(gui_params_ir.skipNearest)].id].tex_gpu);
-				}
-				break;
-			case 7: // Groundtruth Depth 2
-				if (gui_params_ir.use_taa) {
-					ir_blit_multi_depth(fbo_out->color_textures[0], dataset.cam_views[nearest_views[2 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[3 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[4 + int(gui_params_ir.skipNearest)].id].tex_gpu);
-				}
-				else {
-					ir_blit_multi_depth(fbo_out->color_textures[0], dataset.cam_views[nearest_views[3 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[4 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[5 + int(gui_params_ir.skipNearest)].id].tex_gpu);
-				}
-				break;
-			case 8: // Output
-				ir_blit_multi(fbo_res0->color_textures[0], dataset.cam_views[nearest_views[0 + int(gui_params_ir.skipNearest)].id].tex_gpu, fbo_res3->color_textures[0], fbo_out->color_textures[0]);
-				break;
-			
+		if (offline_job) {
+			// offline: write the output instead of presenting it
+			const auto write_start = std::chrono::steady_clock::now();
+			if (offline_job->save_images) {
+				std::string id = std::to_string(offline_frame);
+				while (id.size() < 5) id = "0" + id;
+				capture_writer.write(fbo_out->color_textures[0], offline_job->output_dir + "/neural/" + id + ".png", CaptureWriter::PNG_RGB);
 			}
-			
+			offline_write_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - write_start).count();
 		}
+		else
+			present_output(fbo_out, fbo_prev);
 		if (takeScreenshot) {
-			fbo_out->color_textures[0]->save_png(lastCubePos + "_Cube.png");
+			capture_writer.write(fbo_out->color_textures[0], lastCubePos + "_Cube.png", CaptureWriter::PNG);
 			takeScreenshot = false;
 		}
 		if (gui_params_ir.capturing) { // create data here if specified in the previous frame
@@ -2336,24 +2674,517 @@ void InferenceRenderer::run(int argc, char** argv) {
 		}
 
 		//swap out and previous and old view matrix
+		out_swapped = false;
 		if (!gui_params_ir.taa_update_on_move || current_camera()->moved) {
-			view_old = current_camera()->view;
+			// the motion of the next frame refers to the camera of the image that becomes fbo_prev
+			view_old = gui_params_ir.pipelined_inference ? out_view : current_camera()->view;
 			//swap fbo variable references 
 			Framebuffer fbo_tmp = fbo_out;
 			fbo_out = fbo_prev;
 			fbo_prev = fbo_tmp;
 			cur_out_fbo = fbo_out->name;
 			current_camera()->clear_moved();
+			out_swapped = true;
 		}
 
 		// finish frame
 		Context::swap_buffers();
 
+		if (offline_job) {
+			// the gl timers of a frame are read in the next frame
+			offline_report.frame(int(offline_frame), std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame_start).count(), forward_ms, offline_write_ms);
+			offline_report.gpu_stages(int(offline_frame) - 1, timerRenderPC->last(), timerMipMap->last(), timerInference->last());
+			++offline_frame;
+		}
+
 		//----------------------------------------------------------------------
 		//break;
 	}
 	//----------------------------------------------------------------------
+	// every queued capture is on disk before the context goes away
+	capture_writer.clear();
+	capture_shards.close();
+	// the texture handles are made non resident while the context exists
+	groundtruth_views.clear();
+	occlusion_culler.clear();
+	release_texture_transfers();
+
+	if (offline_job) {
+		// one more query per timer reads the gl timings of the last frame
+		for (auto timer_gl : { timerRenderPC, timerMipMap, timerInference }) {
+			timer_gl->begin();
+			timer_gl->end();
+		}
+		offline_report.gpu_stages(int(offline_frame) - 1, timerRenderPC->last(), timerMipMap->last(), timerInference->last());
+		offline_report.write(offline_job->output_dir + "/timings.csv");
+	}
+}
+
+void InferenceRenderer::run_offline(const OfflineRenderJob& job) {
+	offline_job = &job;
+	run(0, nullptr);
+	offline_job = nullptr;
+}
+
+// dataset and network of the offline job by name, instead of the selection gui
+bool InferenceRenderer::select_offline_job() {
+	auto set = std::find(setName.begin(), setName.end(), offline_job->dataset);
+	if (set == setName.end()) {
+		std::cerr << "[InferenceRenderer] FATAL ERROR: dataset not found: " << offline_job->dataset << "." << std::endl;
+		return false;
+	}
+	dataset_id = int(set - setName.begin());
+	targetWidth = setWidth[dataset_id];
+	targetHeight = setHeight[dataset_id];
+	keepCpuPoints = offline_job->cpu_rasterizer;
+	if (!offline_job->network.empty()) {
+		auto network = std::find(gui_params_ir.network_filenames.begin(), gui_params_ir.network_filenames.end(), offline_job->network);
+		if (network == gui_params_ir.network_filenames.end()) {
+			std::cerr << "[InferenceRenderer] FATAL ERROR: network not found: " << offline_job->network << "." << std::endl;
+			return false;
+		}
+		gui_params_ir.network_id = int(network - gui_params_ir.network_filenames.begin());
+	}
+	return true;
+}
+
+// passes of the frame with the targets they read and write, in the order of run(). the targets of present_output and the
+// captures are read by passes with side effects, every pass nothing of them depends on is culled
+void InferenceRenderer::declare_frame_graph(bool cpu_mipmap, int motion_count, int motion_level) {
+	const int depth = gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id];
+	const int groundtruth_amount = gui_params_ir.network_groundtruth_amount[gui_params_ir.network_id];
+	const bool mipmap_motion = gui_params_ir.mipmap_motion;
+	const auto level = [](int l) { return "res" + std::to_string(l); };
+	const auto level_motion = [](int l, int i) { return "res" + std::to_string(l) + "/motion" + std::to_string(i); };
+	// motion vectors as read by the network and the displays (i from 1)
+	const auto motion = [&](int i) { return mipmap_motion ? level_motion(depth, i) : "motion/" + std::to_string(i); };
+	// color, depth color and depth buffer
+	const auto target_bytes = [](Framebuffer fbo, int colors) {
+		size_t bytes = fbo->depth_texture ? RenderGraph::bytes_per_pixel(fbo->depth_texture->internal_format) : 0;
+		for (int i = 0; i < colors; ++i) bytes += RenderGraph::bytes_per_pixel(fbo->color_textures[i]->internal_format);
+		return bytes * size_t(fbo->w) * size_t(fbo->h);
+	};
+
+	render_graph.reset();
+	for (int l = 0; l < 4; ++l)
+		render_graph.persistent(level(l), target_bytes(Framebuffer::find("fbo_res" + std::to_string(l)), 2));
+	render_graph.persistent("out", target_bytes(Framebuffer::find("fbo_out_1"), 2));
+	render_graph.persistent("prev", target_bytes(Framebuffer::find("fbo_out_2"), 2));
+	render_graph.persistent("pipeline_depth", target_bytes(Framebuffer::find("fbo_pipeline_depth"), 2));
+
+	RenderGraph::Target motion_target;
+	motion_target.internal_format = halfMotionTargets ? GL_RG16F : GL_RG32F;
+	motion_target.format = GL_RG;
+	motion_target.type = halfMotionTargets ? GL_HALF_FLOAT : GL_FLOAT;
+	motion_target.swizzle[2] = motion_target.swizzle[3] = GL_ONE; // like ir_motion_target
+	for (int l = 0; l < 4; ++l) {
+		Framebuffer fbo = Framebuffer::find("fbo_res" + std::to_string(l));
+		motion_target.size = glm::ivec2(fbo->w, fbo->h);
+		for (int i = 1; i <= 6; ++i)
+			render_graph.transient(level_motion(l, i), motion_target);
+	}
+	Framebuffer fbo_motion = Framebuffer::find("fbo_motion");
+	RenderGraph::Target rgba_target;
+	rgba_target.size = glm::ivec2(fbo_motion->w, fbo_motion->h);
+	for (int i = 1; i <= 6; ++i)
+		render_graph.transient("motion/" + std::to_string(i), rgba_target);
+	render_graph.transient("motion/depth", RenderGraph::Target{ GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT, rgba_target.size });
+	Framebuffer fbo_capture_motion = Framebuffer::find("fbo_capture_motion");
+	rgba_target.size = glm::ivec2(fbo_capture_motion->w, fbo_capture_motion->h);
+	render_graph.transient("capture/motion", rgba_target);
+
+	// point rendering
+	std::vector<std::string> writes;
+	if (!mipmap_motion) {
+		writes = { "motion/depth" };
+		for (int i = 1; i <= motion_count; ++i) writes.push_back("motion/" + std::to_string(i));
+		render_graph.add_pass("motion", {}, writes);
+	}
+	writes = { level(0) };
+	for (int i = 1; mipmap_motion && i <= motion_count; ++i) writes.push_back(level_motion(0, i));
+	render_graph.add_pass("points", {}, writes);
+
+	// mip maps, with motion down to the level the network reads it from
+	for (int l = 1; l < 4; ++l) {
+		std::vector<std::string> reads = { level(l - 1) };
+		writes = { level(l) };
+		for (int i = 1; mipmap_motion && l <= motion_level && i <= motion_count; ++i) {
+			reads.push_back(level_motion(l - 1, i));
+			writes.push_back(level_motion(l, i));
+		}
+		render_graph.add_pass("mip" + std::to_string(l), reads, writes);
+	}
 
+	// inference (side effects: pipelined outputs and batched captures)
+	const bool inference_needed = ir_shows_network_output_only() || (gui_params_ir.displayMode == 1 && gui_params_ir.currentRenderInfo >= 2);
+	if (doInference && (inference_needed || ir_capture_batched())) {
+		std::vector<std::string> reads = { level(0) };
+		for (int l = 1; !cpu_mipmap && l < 4; ++l) reads.push_back(level(l));
+		for (int i = 1; i <= groundtruth_amount; ++i)
+			reads.push_back(cpu_mipmap && mipmap_motion ? level_motion(0, i) : motion(i));
+		if (gui_params_ir.use_taa) reads.push_back("prev");
+		if (gui_params_ir.pipelined_inference) reads.push_back("pipeline_depth");
+		render_graph.add_pass("inference", reads, { "out" }, true);
+	}
+
+	// present_output (or the output of the offline renderer)
+	std::vector<std::string> shown;
+	const int info = gui_params_ir.currentRenderInfo;
+	if (offline_job)
+		shown = { "out" };
+	else if (gui_params_ir.displayMode == 0) {
+		if (info < 8) shown = { level(info % 4) };
+		else if (info < 11) shown = { motion(info - 7) };
+		else if (info == 17) shown = { "out" };
+	}
+	else {
+		if (info < 2) shown = { level(0), level(1), level(2), level(3) };
+		else if (info < 4) shown = { "out", motion(3 * (info - 2) + 1), motion(3 * (info - 2) + 2), motion(3 * (info - 2) + 3) };
+		else if (info < 8) shown = { "out", "prev" };
+		else shown = { level(0), level(3), "out" };
+	}
+	render_graph.add_pass("present", shown, {}, true);
+
+	// captures of training data, the motion is expanded into capture/motion
+	if (gui_params_ir.capturing) {
+		std::vector<std::string> reads = { level(0), level(1), level(2), level(3), "out", "capture/motion" };
+		for (int i = 1; i <= gui_params_ir.captureGroundtruthAmount; ++i) reads.push_back(level_motion(0, i));
+		render_graph.add_pass("capture", reads, { "capture/motion" }, true);
+	}
+
+	render_graph.compile();
+}
+
+// camera of the frame for the FrameCamera block of the point shaders, one upload and bind instead of ten matrices per shader.
+// the nearest ground truth views go into groundtruth_views, the buffer is only rewritten if they changed
+void InferenceRenderer::upload_frame_camera() {
+	// the views of the motion vectors, the network inputs and the displays
+	const int amount = std::max(6, gui_params_ir.network_groundtruth_amount[gui_params_ir.network_id]) + int(gui_params_ir.skipNearest);
+	const int count = std::min(amount, int(nearest_views.size()));
+	std::vector<glm::mat4> views(count);
+	std::vector<Texture2D> textures(count);
+	for (int i = 0; i < count; ++i) {
+		views[i] = getView(nearest_views[i].id);
+		textures[i] = dataset.cam_views[nearest_views[i].id].tex_gpu;
+	}
+	groundtruth_views.update(views, textures);
+	groundtruth_views.bind();
+
+	frame_camera.proj = current_camera()->proj;
+	frame_camera.view = current_camera()->view;
+	frame_camera.view_normal = current_camera()->view_normal;
+	frame_camera.proj_old = dataset.gt_proj;
+	// with taa the first motion vectors point into the previous frame, the nearest views follow
+	frame_camera.view_prev = view_old;
+	frame_camera.use_prev_view = gui_params_ir.use_taa;
+	frame_camera.groundtruth_first = int(gui_params_ir.skipNearest) - int(gui_params_ir.use_taa);
+	frameCameraBuffer->upload_subdata(&frame_camera, 0, sizeof(FrameCamera));
+	frameCameraBuffer->bind_base(0);
+}
+
+// view of the motion vectors i, as view_old_n() of shader/__frame_camera_include.glsl
+glm::mat4 InferenceRenderer::motion_view(int i) const {
+	if (frame_camera.use_prev_view && i == 0)
+		return frame_camera.view_prev;
+	const int v = frame_camera.groundtruth_first + i;
+	return v >= 0 && v < groundtruth_views.count() ? groundtruth_views[v].view : glm::mat4(1);
+}
+
+// the uniforms of the point and motion shaders besides the frame camera, the shader has to be bound
+void InferenceRenderer::set_motion_uniforms(const Shader& shader, const glm::ivec2& resolution, int motion_count) {
+	shader->uniform("use_taa", gui_params_ir.use_taa);
+	shader->uniform("resolution", resolution);
+	shader->uniform("motion_count", motion_count);
+	shader->uniform("gt_timestamp_max", gt_timestamp_max);
+	shader->uniform("gt_timestamp_min", gt_timestamp_min);
+	shader->uniform("use_timestamp", gui_params_ir.use_timestamp);
+	shader->uniform("motion_limit", halfMotionTargets ? half_motion_limit : 0.f);
+}
+
+// the uniform setup of the motion and point shaders of a frame, repeated with the cached locations and with a
+// glGetUniformLocation per upload as before the cache. e.g. LIBGL_ALWAYS_SOFTWARE=1 measures the driver overhead on llvmpipe
+void InferenceRenderer::benchmark_uniforms(int motion_count) {
+	const int iterations = 1000;
+	const std::vector<Shader> shaders = { Shader::find("initMoVecsOnly"), Shader::find("drawPCmultiMotionOnly"), Shader::find("initMoVecs"), Shader::find("drawPCmultiMotion") };
+	const size_t uniform_calls = ShaderImpl::uniform_calls;
+	const size_t location_queries = ShaderImpl::location_queries;
+	for (int cached = 1; cached >= 0; --cached) {
+		ShaderImpl::cache_locations = cached;
+		ShaderImpl::uniform_calls = 0;
+		ShaderImpl::location_queries = 0;
+		glFinish();
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; ++i) {
+			upload_frame_camera();
+			for (const auto& shader : shaders) {
+				shader->bind();
+				set_motion_uniforms(shader, gui_params_ir.res0, motion_count);
+			}
+		}
+		glFinish();
+		const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+		// uploads, location queries and the two calls of the camera buffer
+		const float calls = float(ShaderImpl::uniform_calls + ShaderImpl::location_queries) / iterations + 2.f;
+		gui_params_ir.uniform_benchmark_info[cached ? 0 : 1] = float(us);
+		gui_params_ir.uniform_benchmark_info[cached ? 2 : 3] = calls;
+	}
+	glUseProgram(0);
+	ShaderImpl::cache_locations = true;
+	ShaderImpl::uniform_calls = uniform_calls;
+	ShaderImpl::location_queries = location_queries;
+	std::cout << "[InferenceRenderer] uniform setup of " << shaders.size() << " shaders: cached " << gui_params_ir.uniform_benchmark_info.x << " us, "
+		<< gui_params_ir.uniform_benchmark_info.z << " gl calls per frame, queried " << gui_params_ir.uniform_benchmark_info.y << " us, "
+		<< gui_params_ir.uniform_benchmark_info.w << " gl calls per frame" << std::endl;
+}
+
+// culling and drawing of pc into fbo_res0 with every voxel split into 1 - 32 draw commands (same visibility, more commands)
+// modes: no culling | gpu culling, compacted with indirect count, compacted with the count read back | cpu culling, compacted
+void InferenceRenderer::benchmark_culling(PointCloud pc, const Shader& computeShader, const Shader& drawShader, int motion_count) {
+	const std::vector<PointCloudVoxel> voxels = pc->bounding_structure;
+	if (voxels.empty()) return;
+	const int iterations = 50;
+	Camera cam = current_camera();
+	const float aspect = dataset.camera_aspect_ratio;
+	auto fbo_res0 = Framebuffer::find("fbo_res0");
+	gui_params_ir.culling_benchmark_info.clear();
+	for (uint32_t split = 1; split <= 32; split *= 2) {
+		std::vector<PointCloudVoxel> split_voxels;
+		split_voxels.reserve(voxels.size() * split);
+		for (const auto& v : voxels) {
+			const uint32_t pieces = std::max(1u, std::min(split, v.size));
+			for (uint32_t i = 0; i < pieces; ++i) {
+				PointCloudVoxel piece = v;
+				piece.start = v.start + uint32_t(uint64_t(v.size) * i / pieces);
+				piece.size = v.start + uint32_t(uint64_t(v.size) * (i + 1) / pieces) - piece.start;
+				split_voxels.push_back(piece);
+			}
+		}
+		pc->add_bounding_structure(split_voxels);
+
+		std::array<float, 7> row = { float(split_voxels.size()), 0, 0, 0, 0, 0, 0 };
+		fbo_res0->bind();
+		ir_draw_buffers(fbo_res0, 2, 0);
+		glViewport(0, 0, gui_params_ir.res0.x, gui_params_ir.res0.y);
+		drawShader->bind();
+		set_motion_uniforms(drawShader, gui_params_ir.res0, motion_count);
+		pc->bind(drawShader);
+		for (int mode = 0; mode < 6; ++mode) {
+			PointCloudImpl::use_indirect_count = mode != 3;
+			glFinish();
+			const auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < iterations; ++i) {
+				if (mode >= 4)
+					pc->cull_cpu(cam->pos, cam->dir, cam->up, cam->near, cam->far, cam->fov_degree, aspect, mode == 5);
+				else if (mode >= 1)
+					pc->cull(computeShader, cam->pos, cam->dir, cam->up, cam->near, cam->far, cam->fov_degree, aspect, mode >= 2);
+				drawShader->bind();
+				pc->draw();
+			}
+			glFinish();
+			row[1 + mode] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+		}
+		pc->unbind();
+		drawShader->unbind();
+		fbo_res0->unbind();
+		gui_params_ir.culling_benchmark_info.push_back(row);
+		std::cout << "[InferenceRenderer] culling benchmark, " << row[0] << " draw commands: none " << row[1] << " ms, gpu " << row[2]
+			<< " ms, gpu compacted " << row[3] << " ms (count read back " << row[4] << " ms), cpu " << row[5] << " ms, cpu compacted " << row[6] << " ms" << std::endl;
+	}
+	PointCloudImpl::use_indirect_count = true;
+	pc->add_bounding_structure(voxels);
+	if (!PointCloudImpl::indirect_count())
+		std::cout << "[InferenceRenderer] culling benchmark: no glMultiDrawElementsIndirectCount, compacted gpu culling reads the count back" << std::endl;
+}
+
+// blit the selected render targets to the screen. fbo_out holds the network output, fbo_prev the previous output (taa)
+void InferenceRenderer::present_output(Framebuffer fbo_out, Framebuffer fbo_prev) {
+	auto fbo_res0 = Framebuffer::find("fbo_res0");
+	auto fbo_res1 = Framebuffer::find("fbo_res1");
+	auto fbo_res2 = Framebuffer::find("fbo_res2");
+	auto fbo_res3 = Framebuffer::find("fbo_res3");
+	auto fbo_motion = Framebuffer::find("fbo_motion");
+	// render targets only use the part of the current render scale, it is upsampled to the window
+	const vec2 s0 = vec2(gui_params_ir.res0) / vec2(fbo_res0->w, fbo_res0->h);
+	const vec2 s1 = vec2(gui_params_ir.res1) / vec2(fbo_res1->w, fbo_res1->h);
+	const vec2 s2 = vec2(gui_params_ir.res2) / vec2(fbo_res2->w, fbo_res2->h);
+	const vec2 s3 = vec2(gui_params_ir.res3) / vec2(fbo_res3->w, fbo_res3->h);
+	const int motion_level = gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id];
+	const vec2 s_motion = vec2(ir_level_resolution(motion_level)) / vec2(fbo_motion->w, fbo_motion->h);
+	const vec2 s_level = motion_level == 1 ? s1 : motion_level == 2 ? s2 : motion_level == 3 ? s3 : s0;
+	const int skip = int(gui_params_ir.skipNearest);
+	// ground truth view i after the skipped one, through its bindless handle if available
+	const auto blit_groundtruth = [&](int i, bool depth) {
+		if (GroundtruthViews::bindless())
+			ir_blit_groundtruth(i + skip, 1, depth);
+		else if (depth)
+			ir_blit_depth(dataset.cam_views[nearest_views[i + skip].id].tex_gpu);
+		else
+			ir_blit(dataset.cam_views[nearest_views[i + skip].id].tex_gpu);
+	};
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);		
+	//ir_blit(fbo_res0->color_textures[0]);
+	ivec2 tmp_context_res = Context::resolution();
+	glViewport(0, 0, tmp_context_res.x, tmp_context_res.y);
+	if (gui_params_ir.displayMode == 0) { // Single output "0 Color Res0, 1:Color Res1, 2:Color Res2, 3:Color Res3, 4:Depth Res0, 5:Depth Res1, 6:Depth Res2, 7:Depth Res3, 8:Motion1, 9:Motion2, 10:Motion3, 11:Groundtruth1, 12:Groundtruth2, 13:Groundtruth3, 14:Output"
+		switch (gui_params_ir.currentRenderInfo) {
+		case 0: // Color Res0
+			ir_blit(fbo_res0->color_textures[0], s0);
+			break;
+		case 1: // Color Res1
+			ir_blit(fbo_res1->color_textures[0], s1);
+			break;
+		case 2: // Color Res2
+			ir_blit(fbo_res2->color_textures[0], s2);
+			break;
+		case 3: // Color Res3
+			ir_blit(fbo_res3->color_textures[0], s3);
+			break;
+		case 4: // Depth Res0
+			if(gui_params_ir.show_depth_bg_white)
+				ir_blit(fbo_res0->depth_texture, s0);
+			else
+				ir_blit(fbo_res0->color_textures[1], s0);
+			break;
+		case 5: // Depth Res1
+			if (gui_params_ir.show_depth_bg_white)
+				ir_blit(fbo_res1->depth_texture, s1);
+			else
+				ir_blit(fbo_res1->color_textures[1], s1);
+			break;
+		case 6: // Depth Res2
+			if (gui_params_ir.show_depth_bg_white)
+				ir_blit(fbo_res2->depth_texture, s2);
+			else
+				ir_blit(fbo_res2->color_textures[1], s2);
+			break;
+		case 7: // Depth Res3
+			if (gui_params_ir.show_depth_bg_white)
+				ir_blit(fbo_res3->depth_texture, s3);
+			else
+				ir_blit(fbo_res3->color_textures[1], s3);
+			break;
+		case 8: // Motion1
+			if(gui_params_ir.mipmap_motion) {
+				Framebuffer fbo = Framebuffer::find("fbo_res" + std::to_string(gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id]));
+				ir_blit(fbo->color_textures[2], s_level);
+			}
+			else
+				ir_blit(fbo_motion->color_textures[0], s_motion);
+			break;
+		case 9: // Motion2
+			if (gui_params_ir.mipmap_motion) {
+				Framebuffer fbo = Framebuffer::find("fbo_res" + std::to_string(gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id]));
+				ir_blit(fbo->color_textures[3], s_level);
+			}
+			else
+				ir_blit(fbo_motion->color_textures[1], s_motion);
+			break;
+		case 10: // Motion3
+			if (gui_params_ir.mipmap_motion) {
+				Framebuffer fbo = Framebuffer::find("fbo_res" + std::to_string(gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id]));
+				ir_blit(fbo->color_textures[4], s_level);
+			}	
+			else
+				ir_blit(fbo_motion->color_textures[2], s_motion);
+			break;
+		case 11: // Groundtruth1
+			blit_groundtruth(0, false);
+			break;
+		case 12: // Groundtruth2
+			blit_groundtruth(1, false);
+			break;
+		case 13: // Groundtruth3
+			blit_groundtruth(2, false);
+			break;
+		case 14: // Groundtruth Depth 1
+			blit_groundtruth(0, true);
+			break;
+		case 15: // Groundtruth Depth 2
+			blit_groundtruth(1, true);
+			break;
+		case 16: // Groundtruth Depth 3
+			blit_groundtruth(2, true);
+			break;
+		case 17: // Output
+			ir_blit(fbo_out->color_textures[0], s0);
+			break;
+		}
+	}
+	else { // Multi Output "0:Color, 1:Depth, 2:Motion, 3:Groundtruth, 4:Output"
+		switch (gui_params_ir.currentRenderInfo) {
+		case 0: // Color
+			ir_blit_multi(fbo_res0->color_textures[0], fbo_res1->color_textures[0], fbo_res2->color_textures[0], fbo_res3->color_textures[0], s0, s1, s2, s3);
+			break;
+		case 1: // Depth
+			if (gui_params_ir.show_depth_bg_white) {
+				ir_blit_multi(fbo_res0->depth_texture, fbo_res1->depth_texture, fbo_res2->depth_texture, fbo_res3->depth_texture, s0, s1, s2, s3);
+			}
+			else {
+				ir_blit_multi(fbo_res0->color_textures[1], fbo_res1->color_textures[1], fbo_res2->color_textures[1], fbo_res3->color_textures[1], s0, s1, s2, s3);
+			}
+			break;
+		case 2: // Motion
+			if (gui_params_ir.mipmap_motion) {
+				Framebuffer fbo = Framebuffer::find("fbo_res" + std::to_string(gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id]));
+				ir_blit_multi(fbo_out->color_textures[0], fbo->color_textures[2], fbo->color_textures[3], fbo->color_textures[4], s0, s_level, s_level, s_level);
+			}
+			else
+				ir_blit_multi(fbo_out->color_textures[0], fbo_motion->color_textures[0], fbo_motion->color_textures[1], fbo_motion->color_textures[2], s0, s_motion, s_motion, s_motion);
+			break;
+		case 3: // Motion 2
+			if (gui_params_ir.mipmap_motion) {
+				Framebuffer fbo = Framebuffer::find("fbo_res" + std::to_string(gui_params_ir.network_feature_extraction_depth[gui_params_ir.network_id]));
+				ir_blit_multi(fbo_out->color_textures[0], fbo->color_textures[5], fbo->color_textures[6], fbo->color_textures[7], s0, s_level, s_level, s_level);
+			}
+			else
+				ir_blit_multi(fbo_out->color_textures[0], fbo_motion->color_textures[3], fbo_motion->color_textures[4], fbo_motion->color_textures[5], s0, s_motion, s_motion, s_motion);
+			break;
+		case 4: // Groundtruth
+			if (GroundtruthViews::bindless() && !gui_params_ir.use_taa) {
+				// every ground truth view of the network
+				ir_blit_groundtruth(skip, gui_params_ir.network_groundtruth_amount[gui_params_ir.network_id]);
+			}
+			else if (gui_params_ir.use_taa) {
+				ir_blit_multi(fbo_out->color_textures[0], fbo_prev->color_textures[0], dataset.cam_views[nearest_views[0 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[1 + int(gui_params_ir.skipNearest)].id].tex_gpu, s0, s0);
+			}
+			else {
+				ir_blit_multi(fbo_out->color_textures[0], dataset.cam_views[nearest_views[0 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[1 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[2 + int(gui_params_ir.skipNearest)].id].tex_gpu, s0);
+			}
+			break;
+		case 5: // Groundtruth 2
+			if (gui_params_ir.use_taa) {
+				ir_blit_multi(fbo_out->color_textures[0], dataset.cam_views[nearest_views[2 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[3 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[4 + int(gui_params_ir.skipNearest)].id].tex_gpu, s0);
+			}
+			else {
+				ir_blit_multi(fbo_out->color_textures[0], dataset.cam_views[nearest_views[3 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[4 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[5 + int(gui_params_ir.skipNearest)].id].tex_gpu, s0);
+			}
+			break;
+		case 6: // Groundtruth Depth
+			if (GroundtruthViews::bindless() && !gui_params_ir.use_taa) {
+				ir_blit_groundtruth(skip, gui_params_ir.network_groundtruth_amount[gui_params_ir.network_id], true);
+			}
+			else if (gui_params_ir.use_taa) {
+				ir_blit_multi_depth(fbo_out->color_textures[0], fbo_prev->color_textures[1], dataset.cam_views[nearest_views[0 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[1 + int(gui_params_ir.skipNearest)].id].tex_gpu, s0, s0);
+			}
+			else {
+				ir_blit_multi_depth(fbo_out->color_textures[0], dataset.cam_views[nearest_views[0 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[1 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[2 + int(gui_params_ir.skipNearest)].id].tex_gpu, s0);
+			}
+			break;
+		case 7: // Groundtruth Depth 2
+			if (gui_params_ir.use_taa) {
+				ir_blit_multi_depth(fbo_out->color_textures[0], dataset.cam_views[nearest_views[2 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[3 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[4 + int(gui_params_ir.skipNearest)].id].tex_gpu, s0);
+			}
+			else {
+				ir_blit_multi_depth(fbo_out->color_textures[0], dataset.cam_views[nearest_views[3 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[4 + int(gui_params_ir.skipNearest)].id].tex_gpu, dataset.cam_views[nearest_views[5 + int(gui_params_ir.skipNearest)].id].tex_gpu, s0);
+			}
+			break;
+		case 8: // Output
+			ir_blit_multi(fbo_res0->color_textures[0], dataset.cam_views[nearest_views[0 + int(gui_params_ir.skipNearest)].id].tex_gpu, fbo_res3->color_textures[0], fbo_out->color_textures[0], s0, vec2(1), s3, s0);
+			break;
+		
+		}
+		
+	}
 }
 
 void InferenceRenderer::startCapture() {
@@ -2370,7 +3201,10 @@ void InferenceRenderer::startCapture() {
 		lod_description = "lod0";
 	}
 	// create folders if not present. location: "../../neural-point-rendering-training/data/
-	if (!gui_params_ir.cycleTestImages) {
+	if (!gui_params_ir.cycleTestImages && gui_params_ir.capture_shards) {
+		capture_shards.open("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/shards", size_t(gui_params_ir.capture_shard_mb) << 20, gui_params_ir.capture_shard_compress);
+	}
+	else if (!gui_params_ir.cycleTestImages) {
 		std::filesystem::create_directory("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/");
 		std::filesystem::create_directory("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/depth_0_" + lod_description);
 		if (!gui_params_ir.captureDepthOnly) {
@@ -2411,58 +3245,96 @@ void InferenceRenderer::capture() {
 	if (gui_params_ir.cycleTestImages) {
 		// write out rendered result
 		if (!std::filesystem::exists(gui_params_ir.network_filenames[gui_params_ir.network_id] + "/" + dataset.cam_names_test[dataset.currentCam] + "_napr_full.png"))
-			fbo_out->color_textures[0]->save_png("./out/" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/" + dataset.cam_names_test[dataset.currentCam] + "_napr_full.png");
+			capture_writer.write(fbo_out->color_textures[0], "./out/" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/" + dataset.cam_names_test[dataset.currentCam] + "_napr_full.png", CaptureWriter::PNG);
+	}
+	else if (capture_shards.is_open()) {
+		captureShardSample(img_prefix, lod_description);
 	}
 	else {
 		if (!std::filesystem::exists("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/depth_0_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png"))
-			fbo_res0->color_textures[1]->save_png("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/depth_0_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png");
+			capture_writer.write(fbo_res0->color_textures[1], "../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/depth_0_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png", CaptureWriter::PNG);
 		if (!gui_params_ir.captureDepthOnly) {
 			// write out input data 0 col 1 depthcol 2 motion1 3 motion2 4 motion3
 			if (!std::filesystem::exists("../../neural-point-rendering-training/" + setName[dataset_id] + "_new/data/input_0_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png"))
-				fbo_res0->color_textures[0]->save_png("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/input_0_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png");
+				capture_writer.write(fbo_res0->color_textures[0], "../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/input_0_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png", CaptureWriter::PNG);
 			if (!std::filesystem::exists("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/input_1_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png"))
-				fbo_res1->color_textures[0]->save_png("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/input_1_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png");
+				capture_writer.write(fbo_res1->color_textures[0], "../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/input_1_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png", CaptureWriter::PNG);
 			if (!std::filesystem::exists("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/input_2_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png"))
-				fbo_res2->color_textures[0]->save_png("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/input_2_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png");
+				capture_writer.write(fbo_res2->color_textures[0], "../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/input_2_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png", CaptureWriter::PNG);
 			if (!std::filesystem::exists("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/input_3_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png"))
-				fbo_res3->color_textures[0]->save_png("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/input_3_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png");
+				capture_writer.write(fbo_res3->color_textures[0], "../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/input_3_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png", CaptureWriter::PNG);
 
 
 			if (!std::filesystem::exists("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/depth_1_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png"))
-				fbo_res1->color_textures[1]->save_png("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/depth_1_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png");
+				capture_writer.write(fbo_res1->color_textures[1], "../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/depth_1_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png", CaptureWriter::PNG);
 			if (!std::filesystem::exists("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/depth_2_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png"))
-				fbo_res2->color_textures[1]->save_png("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/depth_2_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png");
+				capture_writer.write(fbo_res2->color_textures[1], "../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/depth_2_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png", CaptureWriter::PNG);
 			if (!std::filesystem::exists("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/depth_3_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png"))
-				fbo_res3->color_textures[1]->save_png("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/depth_3_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png");
+				capture_writer.write(fbo_res3->color_textures[1], "../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/depth_3_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png", CaptureWriter::PNG);
 
 			for (int gt_i = 0; gt_i < gui_params_ir.captureGroundtruthAmount; ++gt_i) {
 				if (!std::filesystem::exists("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/nearest" + std::to_string(gt_i + 1) + "_groundtruth_0/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png"))
-					dataset.cam_views[nearest_views[gt_i + int(gui_params_ir.skipNearest)].id].tex_gpu->save_png_rgb("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/nearest" + std::to_string(gt_i + 1) + "_groundtruth_0/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png");
+					capture_writer.write(dataset.cam_views[nearest_views[gt_i + int(gui_params_ir.skipNearest)].id].tex_gpu, "../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/nearest" + std::to_string(gt_i + 1) + "_groundtruth_0/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png", CaptureWriter::PNG_RGB);
 				if (!std::filesystem::exists("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/nearest" + std::to_string(gt_i + 1) + "_depth_0_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png"))
-					dataset.cam_views[nearest_views[gt_i + int(gui_params_ir.skipNearest)].id].tex_gpu->save_png_depth_to_bw("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/nearest" + std::to_string(gt_i + 1) + "_depth_0_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png");
+					capture_writer.write(dataset.cam_views[nearest_views[gt_i + int(gui_params_ir.skipNearest)].id].tex_gpu, "../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/nearest" + std::to_string(gt_i + 1) + "_depth_0_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png", CaptureWriter::PNG_DEPTH_TO_BW);
 				if (!std::filesystem::exists("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/nearest" + std::to_string(gt_i + 1) + "_motion_0_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png"))
-					fbo_res0->color_textures[gt_i + 2]->save_binary("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/nearest" + std::to_string(gt_i + 1) + "_motion_0_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".bin");
+					capture_writer.write(ir_expand_motion(fbo_res0->color_textures[gt_i + 2], fbo_res0->color_textures[1], gui_params_ir.preInitMV), "../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/nearest" + std::to_string(gt_i + 1) + "_motion_0_" + lod_description + "/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".bin", CaptureWriter::BINARY);
 			}
 
 			//save groundtruth
 			if (!std::filesystem::exists("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/groundtruth/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png"))
-				dataset.cam_views[dataset.currentCam].tex_gpu->save_png_rgb("../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/groundtruth/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png");
+				capture_writer.write(dataset.cam_views[dataset.currentCam].tex_gpu, "../../neural-point-rendering-training/data/" + setName[dataset_id] + "_new/groundtruth/" + img_prefix + dataset.cam_names[dataset.currentCam] + ".png", CaptureWriter::PNG_RGB);
 
 
 			// write out rendered result
 			if (!std::filesystem::exists(gui_params_ir.network_filenames[gui_params_ir.network_id] + "/" + dataset.cam_names[dataset.currentCam] + "_napr_full.png"))
-				fbo_out->color_textures[0]->save_png("./out/" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/" + dataset.cam_names[dataset.currentCam] + "_napr_full.png");
+				capture_writer.write(fbo_out->color_textures[0], "./out/" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/" + dataset.cam_names[dataset.currentCam] + "_napr_full.png", CaptureWriter::PNG);
 			std::cout << "used fbo as out: " << fbo_out->name << std::endl;
 		}
 	}
 	dataset.currentCam += 1;
 	if (dataset.currentCam >= (gui_params_ir.cycleTestImages ? dataset.cam_names_test.size() :  dataset.camCount)) {
 		gui_params_ir.capturing = false;
+		if (capture_shards.is_open()) {
+			// the index of the last shard is written once all of its images are appended
+			capture_writer.flush();
+			capture_shards.close();
+			std::cout << "Captured " << capture_shards.entry_count() << " images into " << capture_shards.shard_count() << " shards" << std::endl;
+		}
 	}
 
 	setCurrentCam(dataset.currentCam, gui_params_ir.cycleTestImages);
 }
 
+void InferenceRenderer::captureShardSample(const std::string& img_prefix, const std::string& lod_description) {
+	auto fbo_res0 = Framebuffer::find("fbo_res0");
+	auto fbo_res1 = Framebuffer::find("fbo_res1");
+	auto fbo_res2 = Framebuffer::find("fbo_res2");
+	auto fbo_res3 = Framebuffer::find("fbo_res3");
+	auto fbo_out = Framebuffer::find(cur_out_fbo);
+	// features are named like the folders of the png capture
+	const std::string sample = img_prefix + dataset.cam_names[dataset.currentCam];
+	capture_writer.write(fbo_res0->color_textures[1], capture_shards, sample, "depth_0_" + lod_description, CaptureWriter::PNG);
+	if (gui_params_ir.captureDepthOnly) return;
+	capture_writer.write(fbo_res0->color_textures[0], capture_shards, sample, "input_0_" + lod_description, CaptureWriter::PNG);
+	capture_writer.write(fbo_res1->color_textures[0], capture_shards, sample, "input_1_" + lod_description, CaptureWriter::PNG);
+	capture_writer.write(fbo_res2->color_textures[0], capture_shards, sample, "input_2_" + lod_description, CaptureWriter::PNG);
+	capture_writer.write(fbo_res3->color_textures[0], capture_shards, sample, "input_3_" + lod_description, CaptureWriter::PNG);
+	capture_writer.write(fbo_res1->color_textures[1], capture_shards, sample, "depth_1_" + lod_description, CaptureWriter::PNG);
+	capture_writer.write(fbo_res2->color_textures[1], capture_shards, sample, "depth_2_" + lod_description, CaptureWriter::PNG);
+	capture_writer.write(fbo_res3->color_textures[1], capture_shards, sample, "depth_3_" + lod_description, CaptureWriter::PNG);
+	for (int gt_i = 0; gt_i < gui_params_ir.captureGroundtruthAmount; ++gt_i) {
+		const Texture2D& aux = dataset.cam_views[nearest_views[gt_i + int(gui_params_ir.skipNearest)].id].tex_gpu;
+		const std::string nearest = "nearest" + std::to_string(gt_i + 1);
+		capture_writer.write(aux, capture_shards, sample, nearest + "_groundtruth_0", CaptureWriter::PNG_RGB);
+		capture_writer.write(aux, capture_shards, sample, nearest + "_depth_0_" + lod_description, CaptureWriter::PNG_DEPTH_TO_BW);
+		capture_writer.write(ir_expand_motion(fbo_res0->color_textures[gt_i + 2], fbo_res0->color_textures[1], gui_params_ir.preInitMV), capture_shards, sample, nearest + "_motion_0_" + lod_description, CaptureWriter::BINARY);
+	}
+	capture_writer.write(dataset.cam_views[dataset.currentCam].tex_gpu, capture_shards, sample, "groundtruth", CaptureWriter::PNG_RGB);
+	// the rendered result is no training data and stays a png
+	capture_writer.write(fbo_out->color_textures[0], "./out/" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/" + dataset.cam_names[dataset.currentCam] + "_napr_full.png", CaptureWriter::PNG);
+}
+
 void InferenceRenderer::startCaptureByIndex() {
 	std::filesystem::create_directory("./out");
 	std::filesystem::create_directory("./out/neural_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id]);
@@ -2470,16 +3342,18 @@ void InferenceRenderer::startCaptureByIndex() {
 	std::filesystem::create_directory("./out/neural_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/gt");
 	
 	gui_params_ir.captureByIndexCurrent = gui_params_ir.captureByIndexStart;
+	gui_params_ir.batch_sweep.clear();
 	setCurrentCam(gui_params_ir.captureByIndexCurrent, gui_params_ir.cycleTestImages);
 	gui_params_ir.captureByIndex = true;
 }
 
 void InferenceRenderer::captureByIndex() {
 	auto fbo_out = Framebuffer::find(cur_out_fbo);
-	if (!std::filesystem::exists("./out/neural_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/neural/" + dataset.cam_names[gui_params_ir.captureByIndexCurrent] + ".png"))
-		fbo_out->color_textures[0]->save_png_rgb("./out/neural_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/neural/" + dataset.cam_names[gui_params_ir.captureByIndexCurrent] + ".png");
+	// batched: the neural image is written once the batch of this pose is inferred
+	if (!ir_capture_batched() && !std::filesystem::exists("./out/neural_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/neural/" + dataset.cam_names[gui_params_ir.captureByIndexCurrent] + ".png"))
+		capture_writer.write(fbo_out->color_textures[0], "./out/neural_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/neural/" + dataset.cam_names[gui_params_ir.captureByIndexCurrent] + ".png", CaptureWriter::PNG_RGB);
 	if (!std::filesystem::exists("./out/neural_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/gt/" + dataset.cam_names[gui_params_ir.captureByIndexCurrent] + ".png"))
-		dataset.cam_views[nearest_views[0].id].tex_gpu->save_png_rgb("./out/neural_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/gt/" + dataset.cam_names[gui_params_ir.captureByIndexCurrent] + ".png");
+		capture_writer.write(dataset.cam_views[nearest_views[0].id].tex_gpu, "./out/neural_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/gt/" + dataset.cam_names[gui_params_ir.captureByIndexCurrent] + ".png", CaptureWriter::PNG_RGB);
 	gui_params_ir.captureByIndexCurrent += gui_params_ir.captureByIndexStep;
 	if (gui_params_ir.captureByIndexCurrent >= dataset.camCount || gui_params_ir.captureByIndexCurrent > gui_params_ir.captureByIndexEnd) {
 		gui_params_ir.captureByIndexCurrent = 0;
@@ -2545,27 +3419,27 @@ void InferenceRenderer::captureVideoFrame() {
 
 	// neural image
 	if (!std::filesystem::exists("./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/neural/" + id + ".png"))
-		fbo_out->color_textures[0]->save_png_rgb("./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/neural/" + id + ".png");
+		capture_writer.write(fbo_out->color_textures[0], "./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/neural/" + id + ".png", CaptureWriter::PNG_RGB);
 	/*// point renderings
 	if (!std::filesystem::exists("./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/pr_high/" + id + ".png"))
-		fbo_res0->color_textures[0]->save_png_rgb("./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/pr_high/" + id + ".png");
+		capture_writer.write(fbo_res0->color_textures[0], "./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/pr_high/" + id + ".png", CaptureWriter::PNG_RGB);
 	if (!std::filesystem::exists("./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/pr_low/" + id + ".png"))
-		fbo_res3->color_textures[0]->save_png_rgb("./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/pr_low/" + id + ".png");
+		capture_writer.write(fbo_res3->color_textures[0], "./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/pr_low/" + id + ".png", CaptureWriter::PNG_RGB);
 	// auxiliary images
 	int start_gt_i = gui_params_ir.use_taa ? 1 : 0;
 	for (int gt_i = start_gt_i; gt_i < gui_params_ir.network_groundtruth_amount[gui_params_ir.network_id]; ++gt_i) {
 		if (!std::filesystem::exists("./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/n" + std::to_string(gt_i+1) + "/" + id + ".png"))
-			dataset.cam_views[nearest_views[gt_i - start_gt_i + int(gui_params_ir.skipNearest)].id].tex_gpu->save_png_rgb("./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/n" + std::to_string(gt_i+1) + "/" + id + ".png");
+			capture_writer.write(dataset.cam_views[nearest_views[gt_i - start_gt_i + int(gui_params_ir.skipNearest)].id].tex_gpu, "./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/n" + std::to_string(gt_i+1) + "/" + id + ".png", CaptureWriter::PNG_RGB);
 	}
 	if (gui_params_ir.use_taa) {
 		if (!std::filesystem::exists("./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/n1/" + id + ".png"))
-			fbo_prev->color_textures[0]->save_png_rgb("./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/n1/" + id + ".png");
+			capture_writer.write(fbo_prev->color_textures[0], "./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/n1/" + id + ".png", CaptureWriter::PNG_RGB);
 	}*/
 
 
     if (!std::filesystem::exists("./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/original_input_video/" + id + ".png")){
         int original_input_video_id = std::lroundf(standardAnimation->time);
-        dataset.cam_views[original_input_video_id].tex_gpu->save_png_rgb("./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/original_input_video/" + id + ".png");
+        capture_writer.write(dataset.cam_views[original_input_video_id].tex_gpu, "./out/video_" + setName[dataset_id] + "_" + gui_params_ir.network_filenames[gui_params_ir.network_id] + "/original_input_video/" + id + ".png", CaptureWriter::PNG_RGB);
     }
 
 
@@ -2698,6 +3572,10 @@ void InferenceRenderer::custom_gui_select_dataset() {
 
 			ImGui::SetCursorPosX((windowWidth - textWidth) * 0.5f);
 			ImGui::Checkbox("Enforce Resolution", &enforceTargetResolution);
+			ImGui::SetCursorPosX((windowWidth - textWidth) * 0.5f);
+			ImGui::Checkbox("Keep CPU Points", &keepCpuPoints);
+			ImGui::SetCursorPosX((windowWidth - textWidth) * 0.5f);
+			ImGui::Checkbox("Half Float Motion", &halfMotionTargets);
 
 
 			tmpWidth = ImGui::CalcTextSize("Network Selection").x;
@@ -2767,6 +3645,25 @@ void InferenceRenderer::custom_gui_draw() {
 		ImGui::TextColored(ImVec4(1.0, 0.5, 0.5, 1.0), "Capture Settings");
 		ImGui::Checkbox("Depth Only", &gui_params_ir.captureDepthOnly);
 		ImGui::SliderInt("Number Aux Imgs", &gui_params_ir.captureGroundtruthAmount, 1, 6);
+		ImGui::Checkbox("Batched Capture", &gui_params_ir.batched_capture);
+		if (gui_params_ir.batched_capture) {
+			ImGui::SliderInt("Batch Memory (MB)", &gui_params_ir.batch_memory_mb, 256, 16384);
+			ImGui::SliderInt("Max Batch", &gui_params_ir.batch_max, 1, 64);
+			ImGui::Checkbox("Benchmark Batch Sizes", &gui_params_ir.batch_benchmark);
+			if (gui_params_ir.use_taa || gui_params_ir.pipelined_inference)
+				ImGui::TextColored(ImVec4(1.0, 0.5, 0.5, 1.0), "Not batched with TAA or pipelining");
+			ImGui::Text("Batch: %d, %.1f frames/s", int(gui_params_ir.batch_info.x), gui_params_ir.batch_info.y);
+			for (const auto& t : gui_params_ir.batch_sweep)
+				ImGui::Text("  batch %d: %.1f frames/s", int(t.x), t.y);
+		}
+		ImGui::Checkbox("Capture Shards", &gui_params_ir.capture_shards);
+		if (gui_params_ir.capture_shards) {
+			ImGui::SliderInt("Shard Size (MB)", &gui_params_ir.capture_shard_mb, 64, 8192);
+			ImGui::Checkbox("Compress Shards", &gui_params_ir.capture_shard_compress);
+		}
+		ImGui::SliderInt("Writer Threads", &gui_params_ir.capture_writer_threads, 0, 16);
+		ImGui::SliderInt("Writer Memory (MB)", &gui_params_ir.capture_writer_memory_mb, 64, 8192);
+		ImGui::Text("Writer: %d in flight, %.0f MB, %d written", capture_writer.frames_in_flight(), float(capture_writer.bytes_in_flight()) / float(1 << 20), int(capture_writer.frames_written()));
 
 		/*ImGui::Text("CaptureByIndex Settings");
 		ImGui::InputInt("Start", &gui_params_ir.captureByIndexStart );
@@ -2852,6 +3749,20 @@ void InferenceRenderer::custom_gui_draw() {
 		ImGui::Text("FBO res3: %d,%d", res.x, res.y);
 		res = glm::ivec2(Framebuffer::find("fbo_motion")->w, Framebuffer::find("fbo_motion")->h);
 		ImGui::Text("FBO motion: %d,%d", res.x, res.y);
+		ImGui::Text("Render targets: %.0f MB, peak %.0f MB", float(render_graph.persistent_bytes + render_graph.pool_bytes) / float(1 << 20), float(render_graph.peak_bytes) / float(1 << 20));
+		ImGui::Text("Transients: %.0f MB in %.0f MB, %d passes culled", float(render_graph.transient_bytes) / float(1 << 20), float(render_graph.pool_bytes) / float(1 << 20), render_graph.passes_culled);
+		ImGui::Text("Uniforms: %d uploads, %d location queries", gui_params_ir.uniform_info.x, gui_params_ir.uniform_info.y);
+		if (ImGui::Button("Benchmark Uniforms"))
+			gui_params_ir.uniform_benchmark = true;
+		if (gui_params_ir.uniform_benchmark_info.x > 0.f)
+			ImGui::Text("  cached %.1f us, %.0f calls\n  queried %.1f us, %.0f calls", gui_params_ir.uniform_benchmark_info.x, gui_params_ir.uniform_benchmark_info.z,
+				gui_params_ir.uniform_benchmark_info.y, gui_params_ir.uniform_benchmark_info.w);
+		ImGui::Checkbox("Dynamic Resolution", &gui_params_ir.dynamic_resolution);
+		if (gui_params_ir.dynamic_resolution) {
+			ImGui::SliderFloat("Target Frame Time (ms)", &gui_params_ir.drs_target_ms, 4.f, 100.f, "%.1f");
+			ImGui::SliderFloat("Min Scale", &gui_params_ir.drs_min_scale, 0.25f, 1.f, "%.2f");
+		}
+		ImGui::Text("Render res0: %d,%d (scale %.2f)", gui_params_ir.res0.x, gui_params_ir.res0.y, gui_params_ir.render_scale);
 		//reset button to get beack to default image resolution
 		/*if (ImGui::Button("Reset Res")) {		
 			std::cout << "Reset Resolution to Initial Value" << std::endl;
@@ -2887,6 +3798,7 @@ void InferenceRenderer::custom_gui_draw() {
 		/*if(ImGui::Checkbox("MipMap Motion", &gui_params_ir.mipmap_motion)) ir_resize_motion_buffer();*/
 		/*ImGui::Checkbox("Show Debug Diff", &gui_params_ir.show_diff);*/
 		ImGui::Checkbox("Pre Init MV", &gui_params_ir.preInitMV);
+		ImGui::Checkbox("CPU Mip Map", &gui_params_ir.cpu_mipmap);
 		// network used for inference
 		ImGui::Text("Network Type");
 		if (ImGui::BeginCombo("##Network Type", gui_params_ir.network_filenames[gui_params_ir.network_id].c_str())) {
@@ -2907,6 +3819,18 @@ void InferenceRenderer::custom_gui_draw() {
 			}
 			ImGui::EndCombo();
 		}
+		if (gui_params_ir.network_loading)
+			ImGui::TextColored(ImVec4(1.0, 0.8, 0.2, 1.0), "Loading %s ...", gui_params_ir.network_filenames[gui_params_ir.network_id].c_str());
+		else if (!gui_params_ir.network_error.empty())
+			ImGui::TextColored(ImVec4(1.0, 0.3, 0.3, 1.0), "Failed to load: %s", gui_params_ir.network_error.c_str());
+		ImGui::SliderInt("Network Memory (MB)", &gui_params_ir.network_memory_mb, 128, 16384);
+		ImGui::Text("Loaded networks: %d, %.0f MB", gui_params_ir.network_memory_info.x, float(gui_params_ir.network_memory_info.y));
+		ImGui::Text("Precision: %s", network_precision_name(gui_params_ir.network_precision[gui_params_ir.network_id]).c_str());
+		if (gui_params_ir.network_precision[gui_params_ir.network_id] != NetworkPrecision::FP32) {
+			ImGui::Checkbox("Precision Report", &gui_params_ir.precision_report);
+			if (gui_params_ir.precision_report)
+				ImGui::Text("PSNR vs fp32: %.2f dB", gui_params_ir.precision_psnr);
+		}
 
 
 		/*ImGui::Text("Resolution Modifier");
@@ -2925,12 +3849,67 @@ void InferenceRenderer::custom_gui_draw() {
 
 
 		// enable culling
-		/*ImGui::Checkbox("Culling", &gui_params_ir.enableCulling);*/
+		ImGui::Checkbox("Culling", &gui_params_ir.enableCulling);
+		if (gui_params_ir.enableCulling) {
+			ImGui::Checkbox("CPU Culling", &gui_params_ir.cpu_culling);
+			if (gui_params_ir.cpu_culling)
+				ImGui::Text("%.2f ms, %.0f of %.0f voxels visible, %.0f nodes tested", gui_params_ir.culling_info.x, gui_params_ir.culling_info.y,
+					gui_params_ir.culling_info.z, gui_params_ir.culling_info.w);
+			ImGui::Checkbox("Compact Draw Commands", &gui_params_ir.compact_draw_commands);
+			if (ImGui::Button("Benchmark Culling"))
+				gui_params_ir.culling_benchmark = true;
+			for (const auto& row : gui_params_ir.culling_benchmark_info)
+				ImGui::Text("  %.0f cmds: %.2f | %.2f %.2f %.2f | %.2f %.2f ms", row[0], row[1], row[2], row[3], row[4], row[5], row[6]);
+			if (ImGui::Button("Compare CPU/GPU Culling"))
+				gui_params_ir.culling_compare = true;
+			if (gui_params_ir.culling_compare_info.y > 0)
+				ImGui::Text("  %d of %d voxels differ", gui_params_ir.culling_compare_info.x, gui_params_ir.culling_compare_info.y);
+			ImGui::Checkbox("Occlusion Culling", &gui_params_ir.occlusion_culling);
+			if (gui_params_ir.occlusion_culling) {
+				ImGui::SliderInt("Occluder Voxels", &gui_params_ir.occluder_voxels, 0, 4096);
+				ImGui::Text("  points: %.0f in frustum, %.0f occluded, %.0f drawn (%.0f in pre-pass)", gui_params_ir.occlusion_info.x,
+					gui_params_ir.occlusion_info.y, gui_params_ir.occlusion_info.z, gui_params_ir.occlusion_info.w);
+			}
+		}
 
 		ImGui::Checkbox("Skip Nearest Groundtruth", &gui_params_ir.skipNearest);
+		if (!cpu_points.empty()) {
+			ImGui::Checkbox("CPU Rasterizer", &gui_params_ir.cpu_rasterizer);
+			if (gui_params_ir.cpu_rasterizer) {
+				ImGui::SliderInt("Rasterizer Threads", &gui_params_ir.cpu_rasterizer_threads, 0, 64);
+				ImGui::Text("%.2f ms, %zu of %zu points drawn", software_rasterizer.render_ms, software_rasterizer.points_drawn, software_rasterizer.points_visible);
+			}
+		}
 		ImGui::Checkbox("Use Prev as GT", &gui_params_ir.use_taa);
 		if(gui_params_ir.use_taa)
 			ImGui::Checkbox("Update on Move Only", &gui_params_ir.taa_update_on_move);
+		ImGui::Checkbox("Channels Last Inputs", &gui_params_ir.channels_last);
+		ImGui::Checkbox("Pipelined Inference", &gui_params_ir.pipelined_inference);
+		ImGui::Checkbox("Tiled Inference", &gui_params_ir.tiled_inference);
+		if (gui_params_ir.tiled_inference) {
+			ImGui::SliderInt("Tile Memory Budget (MB)", &gui_params_ir.tile_memory_budget_mb, 64, 8192);
+			if (torch::cuda::is_available())	// the inference device
+				ImGui::SliderInt("Tile Threads", &gui_params_ir.tile_threads, 1, 8);
+			ImGui::Text("Tiles: %d of size %d", gui_params_ir.tile_info.x, gui_params_ir.tile_info.y);
+			ImGui::Checkbox("Selective Update", &gui_params_ir.tile_selective_update);
+			if (gui_params_ir.tile_selective_update) {
+				ImGui::SliderFloat("Change Tolerance", &gui_params_ir.tile_change_tolerance, 0.0f, 0.1f, "%.4f");
+				ImGui::Text("Skipped: %.1f%%, saved: %.2f ms", 100.f * gui_params_ir.tile_skipped_fraction, gui_params_ir.tile_time_saved_ms);
+			}
+		}
+		if (!gui_params_ir.network_encoder_filenames.empty() && !gui_params_ir.network_encoder_filenames[gui_params_ir.network_id].empty()) {
+			ImGui::SliderInt("Feature Cache (MB)", &gui_params_ir.feature_cache_mb, 64, 4096);
+			ImGui::Text("Cached views: %d, %.0f MB, hit rate %.1f%%", gui_params_ir.feature_cache_info.x, gui_params_ir.feature_cache_info.y, 100.f * gui_params_ir.feature_cache_info.z);
+		}
+		ImGui::Checkbox("Optimize Networks", &gui_params_ir.optimize_networks);
+		ImGui::SliderInt("Warm-up Passes", &gui_params_ir.warmup_passes, 0, 10);
+		ImGui::Text("Last warm-up: %.1f ms", gui_params_ir.warmup_ms);
+		ImGui::Checkbox("Skip Idle Frames", &gui_params_ir.idle_skip);
+		if (gui_params_ir.idle_skip) {
+			if (gui_params_ir.use_taa)
+				ImGui::SliderInt("TAA Idle Frames", &gui_params_ir.taa_idle_frames, 0, 64);
+			ImGui::Text("Idle for %d frames", gui_params_ir.idle_frames);
+		}
 
 		// combo for LOD selection
 		/*ImGui::Text("LOD");
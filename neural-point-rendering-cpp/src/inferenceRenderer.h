@@ -16,12 +16,30 @@
 
 #include <torch/script.h>
 #include "texture_copy.h"
+#include "network_precision.h"
+#include "offline_render.h"
+#include "capture_writer.h"
+#include "software_rasterizer.h"
+#include "render_graph.h"
+#include "groundtruth_views.h"
 
 
 //#define LOD_LEVELS 6 //defines how many lod levels should be loaded
 
 
 // structs for config etc
+// FrameCamera uniform block of the point shaders (shader/__frame_camera_include.glsl), std140 packs the matrices without padding
+struct FrameCamera {
+	glm::mat4 proj = glm::mat4(1);
+	glm::mat4 view = glm::mat4(1);
+	glm::mat4 view_normal = glm::mat4(1);
+	glm::mat4 proj_old = glm::mat4(1);
+	glm::mat4 view_prev = glm::mat4(1);
+	int groundtruth_first = 0;			// groundtruth_views index of the motion vectors 0
+	int use_prev_view = 0;				// the motion vectors 0 use view_prev (taa)
+	int padding[2] = { 0, 0 };
+};
+
 struct GUI_Parameters_IR {
 	glm::ivec2 initial_resolution_default = ivec2(480, 272); // ivec2(640, 480);// ivec2(960, 544);// 540; // initial vertical res to go back to if wanted //768 // 0: 768; // 1: 384; // 2: 192; // 3: 96; // 4: 48;
 	int draw_gui = 1; // contains which guis should be drawn 0: no gui, 1: custom gui, 2: cppl gui, 3: both  
@@ -31,6 +49,21 @@ struct GUI_Parameters_IR {
 	// Contains the preset point sizes for each lod in oriented quad rendering
 	int resolution_modifier = 1;		// modifier on which resolution is used for the fbo and screenshots compared to the context/window size (0:2, 1:1, 2:0.5, 3:0.25, 4:0.125, 5:0.0625)
 	bool enableCulling = false;			// contains whether culling is used
+	bool cpu_culling = false;			// frustum culling on the cpu (FrustumCuller) instead of the compute shader
+	glm::vec4 culling_info = glm::vec4(0);	// cpu culling: ms, visible voxels, voxels and tested nodes of the last frame
+	bool culling_compare = false;		// run the cpu and the gpu culling once and count the voxels they decide differently
+	glm::ivec2 culling_compare_info = glm::ivec2(0);	// differing voxels and voxels of the last comparison
+	bool compact_draw_commands = true;	// culling writes only the visible draw commands, drawn with their count
+	bool culling_benchmark = false;		// time culling and drawing with the voxels split into more draw commands
+	std::vector<std::array<float, 7>> culling_benchmark_info{};	// per split: draw commands and ms of the culling modes
+	bool occlusion_culling = false;		// cull the voxels hidden behind a depth pre-pass of the nearest voxels (OcclusionCuller)
+	int occluder_voxels = 256;			// voxels drawn in the depth pre-pass
+	glm::vec4 occlusion_info = glm::vec4(0);	// points in the frustum, occluded and drawn of the last culling, points of the pre-pass
+	bool cpu_rasterizer = false;		// render the points with the software rasterizer instead of gl (needs the cpu copies of the clouds)
+	int cpu_rasterizer_threads = 0;		// threads of the software rasterizer, 0: all hardware threads
+	glm::ivec2 uniform_info = glm::ivec2(0);	// uniform uploads and glGetUniformLocation calls of the last frame
+	bool uniform_benchmark = false;		// time the uniform setup of the point shaders with cached vs queried locations
+	glm::vec4 uniform_benchmark_info = glm::vec4(0);	// us per frame and gl calls per frame, cached and queried
 	int lod = 0;						// contains the current lod level to be displayed -> set initial lod here
 	int lod_amount = -1;				// number of loaded lods. filled on startup
 	//bool alternatePointClouds = false;	// contains if pointclouds are alternated, i.e. different clouds of the same reolution are switched out each frame
@@ -55,6 +88,7 @@ struct GUI_Parameters_IR {
 	bool show_depth_bg_white = false;
 	bool show_diff = true;
 	bool mipmap_motion = true;
+	bool cpu_mipmap = true;				// cpu inference: downsample res1 - res3 (and the motion) on the host instead of the mip map passes
 	bool loadGroundtruth = true;
 	bool skipNearest = true;			// skip the nearest groundtruth image?
 	bool log_nearest_views = false;
@@ -64,6 +98,23 @@ struct GUI_Parameters_IR {
 	bool preInitMV = true;
 	bool use_taa = false;
 	bool taa_update_on_move = true;
+	bool channels_last = false;			// network inputs in channels last (NHWC) memory layout
+	bool pipelined_inference = false;	// forward pass on a worker thread, output is one frame behind
+	bool tiled_inference = false;		// run the network on overlapping tiles to bound the memory
+	int tile_memory_budget_mb = 1024;	// activation memory budget that determines the tile size
+	int tile_threads = 1;				// tiles processed in parallel (cuda only)
+	glm::ivec2 tile_info = glm::ivec2(0);	// tile amount and core size of the last tiled inference
+	bool tile_selective_update = false;	// only infer tiles whose inputs changed since the last frame
+	float tile_change_tolerance = 0.002f;	// max abs input difference that counts as unchanged
+	float tile_skipped_fraction = 0.f;	// of the last tiled inference
+	float tile_time_saved_ms = 0.f;		// estimated, of the last tiled inference
+	bool optimize_networks = true;		// freeze and optimize_for_inference the networks, one copy per network for all resolutions
+	int warmup_passes = 3;				// forward passes on the first use of a network with a resolution
+	double warmup_ms = 0.0;				// duration of the last warm-up
+	bool idle_skip = true;				// present the last output again if nothing changed instead of rendering
+	int taa_idle_frames = 16;			// frames taa keeps accumulating after the last change before the renderer goes idle
+	int idle_frames = 0;				// consecutive frames the last output was presented again
+	bool redraw_requested = false;		// set by input callbacks, forces the next frame to be rendered
 
 	int network_id = 0;					// 0: napr2, 1: aliev
 	int prev_network_id = 0;				// previous network_id. for switching between the last two networks
@@ -72,6 +123,12 @@ struct GUI_Parameters_IR {
 	glm::ivec2 res1 = initial_resolution_default/2;
 	glm::ivec2 res2 = initial_resolution_default/4;
 	glm::ivec2 res3 = initial_resolution_default/8;
+	glm::ivec2 res_max = initial_resolution_default;	// allocated size of the render targets. res0 - res3 are sub-rectangles of them at render_scale
+	float render_scale = 1.f;			// current scale of res0 relative to res_max
+	bool dynamic_resolution = false;	// adjust render_scale to hold drs_target_ms
+	float drs_target_ms = 33.3f;		// target frame time of the dynamic resolution
+	float drs_min_scale = 0.5f;			// lower bound of render_scale
+	int drs_alignment = 16;				// res0 below full scale is a multiple of this, so every level divides evenly
 
 	std::vector<std::string> network_filenames{}; // filename of the cloud without the '.pt' after
 
@@ -79,6 +136,19 @@ struct GUI_Parameters_IR {
 	std::vector<int> network_movec_channels{};
 	std::vector<int> network_groundtruth_amount{};
 	std::vector<int> network_prevInitMV{};
+	std::vector<NetworkPrecision> network_precision{};
+	std::vector<int> network_receptive_field{};	// halo of tiles in pixels
+	std::vector<int> network_memory_per_pixel{};	// estimated activation bytes per input pixel
+	std::vector<std::string> network_encoder_filenames{};	// auxiliary image encoder of split networks, empty otherwise
+	std::vector<std::string> network_decoder_filenames{};	// per frame decoder of split networks, empty otherwise
+	int feature_cache_mb = 512;			// memory of the encoded auxiliary images of split networks
+	glm::vec3 feature_cache_info = glm::vec3(0);	// cached views, MB and hit rate
+	bool network_loading = false;		// the selected network is loaded in the background
+	std::string network_error = "";		// message if the selected network failed to load
+	int network_memory_mb = 2048;		// capacity of the loaded networks, least recently used ones are dropped
+	glm::ivec2 network_memory_info = glm::ivec2(0);	// loaded networks and their MB
+	bool precision_report = false;		// run the fp32 reference next to reduced precision networks and report the psnr
+	double precision_psnr = 0.0;		// psnr of the last output vs the fp32 reference
 	bool increment_image = false; // dummy to tell the renderer to use the next image in the dataset
 	bool decrement_image = false; // dummy to tell the renderer to use the previous image in the dataset
 	// capture stuff 
@@ -96,6 +166,17 @@ struct GUI_Parameters_IR {
 	int captureByIndexStep = 1;
 	int captureByIndexEnd = 0;
 	int captureByIndexCurrent = 0;
+	bool batched_capture = false;		// capture by index runs the network once per batch of poses (no taa, no pipelining)
+	int batch_memory_mb = 2048;			// activation memory budget that determines the batch size
+	int batch_max = 16;					// upper bound of the batch size
+	bool batch_benchmark = false;		// sweep the batch sizes on the first full batch of a capture
+	glm::vec2 batch_info = glm::vec2(0);	// batch size and frames/s of the last batched forward pass
+	std::vector<glm::vec2> batch_sweep{};	// batch size and frames/s of the last benchmark
+	int capture_writer_threads = 0;		// encoder threads of the capture writer, 0: half of the hardware threads
+	int capture_writer_memory_mb = 1024;	// captured frames in flight before the capture waits for the encoders
+	bool capture_shards = false;		// capture the training dataset into shard files instead of one png per image
+	int capture_shard_mb = 1024;		// size of a shard
+	bool capture_shard_compress = false;	// zlib compressed shards, smaller but not readable without decoding
 
 	bool startCaptureVideo = false;
 	bool captureVideo = false;
@@ -125,18 +206,49 @@ class InferenceRenderer {
 private:
 	// if false, the inference is not done. Used for e.g. displaying gt images in its native resolution or creating depth images from the point cloud for gt sizes that are not divisible by 16
 	bool doInference = true;
+	// set by run_offline: headless, dataset, network and camera path from the job instead of the gui
+	const OfflineRenderJob* offline_job = nullptr;
+	// captures are read back and encoded asynchronously. declared after the shards, the writer drains into them on destruction
+	CaptureShards capture_shards;
+	CaptureWriter capture_writer;
+	// cpu copies of the point clouds for the software rasterizer, only kept if keepCpuPoints is set before loading
+	bool keepCpuPoints = false;
+	std::vector<SoftwareRasterizer::Points> cpu_points;
+	SoftwareRasterizer software_rasterizer{ 1 };
+	// motion targets of fbo_res0 - fbo_res3 as rg16f instead of rg32f, set before the render targets are created
+	bool halfMotionTargets = false;
+	// the motion written into half float targets is clamped to +-half_motion_limit ndc instead of overflowing to inf
+	static constexpr float half_motion_limit = 1024.f;
+	// passes and render targets of a frame: passes nothing depends on are culled, the motion targets are pooled transients
+	RenderGraph render_graph;
+	// camera of the frame, shared by the point shaders through one uniform buffer
+	FrameCamera frame_camera;
+	UBO frameCameraBuffer;
+	// nearest ground truth views with their view matrices and bindless texture handles, the old views of the motion vectors
+	GroundtruthViews groundtruth_views;
+	// depth pre-pass and max depth pyramid of the occlusion culling
+	OcclusionCuller occlusion_culler;
 
 	void setCurrentCam(int id, bool test = false);
 	glm::mat4 getView(int id, bool test = false);
 	void loadPointClouds(std::vector<PointCloud>& pcs, std::vector<std::string> files);
 	//void loadPointCloudParts(std::vector<PointCloud>& pcm);
 	void custom_gui_select_dataset();
+	bool select_offline_job();
 	void custom_gui_draw();
+	void declare_frame_graph(bool cpu_mipmap, int motion_count, int motion_level);
+	void upload_frame_camera();
+	glm::mat4 motion_view(int i) const;
+	void set_motion_uniforms(const Shader& shader, const glm::ivec2& resolution, int motion_count);
+	void benchmark_uniforms(int motion_count);
+	void benchmark_culling(PointCloud pc, const Shader& computeShader, const Shader& drawShader, int motion_count);
+	void present_output(Framebuffer fbo_out, Framebuffer fbo_prev);
 	void createRandomAnimation(glm::vec3 endpos, glm::quat endrot);
 
 	// data capturing sstuff for training
 	void startCapture(); // init capturing data and set first pos
 	void capture(); //advance counter and set next campos
+	void captureShardSample(const std::string& img_prefix, const std::string& lod_description); // capture() into the shards
 
 	void startCaptureVideo();
 	void captureVideoFrame();
@@ -206,6 +318,8 @@ public:
 	~InferenceRenderer(){}
 
 	void run(int argc, char** argv);
+	// render the frames of the job headless and exit
+	void run_offline(const OfflineRenderJob& job);
 
 	
 };
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "inference_pipeline.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include <ATen/cuda/CUDAContext.h>
+#include <c10/cuda/CUDAGuard.h>
+
+InferencePipeline::InferencePipeline() {
+	for (int i = 0; i < int(slots.size()); ++i) slots[i].index = i;
+	worker = std::thread(&InferencePipeline::work, this);
+}
+
+InferencePipeline::~InferencePipeline() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		running = false;
+	}
+	cv_work.notify_all();
+	if (worker.joinable()) worker.join();
+}
+
+InferencePipeline::Slot& InferencePipeline::acquire() {
+	bool still_pending;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		still_pending = std::find(pending.begin(), pending.end(), next) != pending.end();
+	}
+	// only happens if results were not popped, the old job of the slot is dropped
+	if (still_pending) flush();
+	return slots[next];
+}
+
+void InferencePipeline::submit(Slot& slot, const torch::jit::script::Module& module, NetworkPrecision precision, torch::Device device) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		slot.inputs = slot.arena.inputs();
+		slot.module = module;
+		slot.precision = precision;
+		slot.device = device;
+		// the inputs were packed on the current stream of the gl thread
+		if (device.is_cuda()) slot.inputs_ready.record(at::cuda::getCurrentCUDAStream(device.index()));
+		done[slot.index] = false;
+		queue.push_back(slot.index);
+		pending.push_back(slot.index);
+		next = (slot.index + 1) % int(slots.size());
+	}
+	cv_work.notify_one();
+}
+
+InferencePipeline::Slot* InferencePipeline::pop_result(int keep_in_flight) {
+	std::unique_lock<std::mutex> lock(mutex);
+	if (int(pending.size()) <= keep_in_flight) return nullptr;
+	int i = pending.front();
+	cv_done.wait(lock, [&] { return done[i]; });
+	pending.pop_front();
+	done[i] = false;
+	Slot& slot = slots[i];
+	if (slot.device.is_cuda() && slot.output.defined()) {
+		// the caller reads the output on its current stream
+		const c10::cuda::CUDAStream current = at::cuda::getCurrentCUDAStream(slot.device.index());
+		slot.output_ready.block(current);
+		slot.output.record_stream(current);
+	}
+	return &slot;
+}
+
+void InferencePipeline::flush() {
+	while (pop_result(0));
+}
+
+int InferencePipeline::in_flight() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return int(pending.size());
+}
+
+void InferencePipeline::work() {
+	// grad mode and autocast are thread local
+	torch::NoGradGuard no_grad;
+	while (true) {
+		int i;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			cv_work.wait(lock, [&] { return !queue.empty() || !running; });
+			if (queue.empty()) return;
+			i = queue.front();
+			queue.pop_front();
+		}
+		Slot& slot = slots[i];
+		auto start = std::chrono::steady_clock::now();
+		try {
+			std::optional<c10::cuda::CUDAStreamGuard> stream_guard;
+			if (slot.device.is_cuda()) {
+				if (!stream) stream = c10::cuda::getStreamFromPool(false, slot.device.index());
+				stream_guard.emplace(*stream);
+				slot.inputs_ready.block(*stream);
+			}
+			PrecisionGuard precision_guard(slot.precision, slot.device);
+			slot.output = slot.module.forward(slot.inputs).toTensor();
+			if (slot.device.is_cuda()) {
+				// waits for the inference stream only, not for the gl thread's work on the device
+				slot.output_ready.record(*stream);
+				slot.output_ready.synchronize();
+			}
+			slot.error.clear();
+		}
+		catch (const c10::Error& e) {
+			slot.output = torch::Tensor();
+			slot.error = e.what_without_backtrace();
+		}
+		slot.forward_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			done[i] = true;
+		}
+		cv_done.notify_all();
+	}
+}
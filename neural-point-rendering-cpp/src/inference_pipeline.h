@@ -0,0 +1,87 @@
+#pragma once
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <torch/script.h>
+#include <ATen/cuda/CUDAEvent.h>
+#include <c10/cuda/CUDAStream.h>
+
+#include "network_input.h"
+#include "network_precision.h"
+
+/*  Inference Pipeline: runs the forward pass on a worker thread, one frame behind the gl thread
+	Two slots, each with its own input arena. The gl thread packs frame N into one slot and submits it,
+	then presents the output of frame N-1 from the other slot while the worker is busy with frame N.
+	Common usage:
+		per frame:
+			slot = acquire()					free slot for the next frame
+			slot.arena.pack_...(...)			on the gl thread (transfers need the context)
+			submit(slot, module, ...)
+			result = pop_result(1)				waits for the previous frame, nullptr if nothing is pending
+			result->arena.unpack_output(result->output, tex)
+	The worker never touches gl. On cuda it runs on its own stream, which waits for the inputs with an event recorded at submit.
+	The worker waits for an event after the forward pass (only its stream, the device stays busy with the gl thread's work),
+	and pop_result() makes the current stream of the caller wait on the same event before the output is read.
+*/
+class InferencePipeline {
+//structs
+public:
+	struct Slot {
+		int index = 0;
+		NetworkInputArena arena;
+		std::vector<torch::jit::IValue> inputs;
+		torch::jit::script::Module module;
+		NetworkPrecision precision = NetworkPrecision::FP32;
+		torch::Device device = torch::kCUDA;
+
+		torch::Tensor output;
+		std::string error;						// message of a failed forward pass, empty otherwise
+		double forward_ms = 0.0;				// forward time on the worker
+		glm::mat4 view = glm::mat4(1);			// camera the inputs were rendered with
+		glm::ivec2 resolution = glm::ivec2(0);	// res0 the inputs were rendered with
+		at::cuda::CUDAEvent inputs_ready;		// recorded on the stream of the gl thread at submit
+		at::cuda::CUDAEvent output_ready;		// recorded on the inference stream after the forward pass
+	};
+
+//data
+public:
+	std::array<Slot, 2> slots;
+
+//methods
+public:
+	InferencePipeline();
+	~InferencePipeline();
+
+	// slot to pack the next frame into
+	Slot& acquire();
+	// hand a packed slot to the worker
+	void submit(Slot& slot, const torch::jit::script::Module& module, NetworkPrecision precision, torch::Device device);
+	// oldest submitted slot if more than keep_in_flight jobs are pending, waits for its forward pass. nullptr otherwise
+	Slot* pop_result(int keep_in_flight);
+	// wait for all pending jobs and drop their results
+	void flush();
+	int in_flight();
+
+	InferencePipeline(const InferencePipeline&) = delete;
+	InferencePipeline& operator=(const InferencePipeline&) = delete;
+
+private:
+	void work();
+
+	std::thread worker;
+	std::optional<c10::cuda::CUDAStream> stream;	// inference stream of the worker, created on the first cuda job
+	std::mutex mutex;
+	std::condition_variable cv_work, cv_done;
+	std::deque<int> queue;		// submitted jobs the worker did not start yet
+	std::deque<int> pending;	// submitted jobs whose result was not popped yet
+	std::array<bool, 2> done{};
+	int next = 0;
+	bool running = true;
+};
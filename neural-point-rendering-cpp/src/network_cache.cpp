@@ -0,0 +1,82 @@
+#include "network_cache.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include <torch/cuda.h>
+
+// without optimization the loaded trace is shared (modules are handles), no copy of its weights is made
+torch::jit::script::Module NetworkCache::optimized(const torch::jit::script::Module& module) {
+	if (!optimize) return module;
+	torch::jit::script::Module frozen;
+	try {
+		frozen = torch::jit::freeze(module);
+	}
+	catch (const c10::Error& e) {
+		std::cerr << "[NetworkCache] WARNING: freezing failed, using the unoptimized network: " << e.what_without_backtrace() << std::endl;
+		return module;
+	}
+	try {
+		return torch::jit::optimize_for_inference(frozen);
+	}
+	catch (const c10::Error& e) {
+		std::cerr << "[NetworkCache] WARNING: optimize_for_inference failed, using the frozen network: " << e.what_without_backtrace() << std::endl;
+		return frozen;
+	}
+}
+
+void NetworkCache::evict_oldest() {
+	auto oldest = entries.begin();
+	for (auto e = entries.begin(); e != entries.end(); ++e)
+		if (e->second.last_use < oldest->second.last_use) oldest = e;
+	bytes -= oldest->second.bytes;
+	entries.erase(oldest);
+}
+
+torch::jit::script::Module& NetworkCache::get(int network, const torch::jit::script::Module& trace, size_t trace_bytes) {
+	auto it = entries.find(network);
+	if (it == entries.end()) {
+		Entry entry;
+		entry.module = optimized(trace);
+		entry.bytes = entry.module._ivalue() == trace._ivalue() ? 0 : trace_bytes;
+		// evict the least recently used modules
+		while (!entries.empty() && (entries.size() >= capacity || bytes + entry.bytes > capacity_bytes))
+			evict_oldest();
+		bytes += entry.bytes;
+		it = entries.emplace(network, std::move(entry)).first;
+	}
+	it->second.last_use = ++use_counter;
+	return it->second.module;
+}
+
+void NetworkCache::warm_up(int network, const std::vector<int64_t>& shape, const std::function<void(torch::jit::script::Module&)>& forward) {
+	Entry& entry = entries.at(network);
+	if (std::find(entry.warm.begin(), entry.warm.end(), shape) != entry.warm.end()) return;
+	if (entry.warm.size() >= std::max<size_t>(1, warm_shapes))
+		entry.warm.erase(entry.warm.begin());
+	entry.warm.push_back(shape);
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < warmup_passes; ++i)
+		forward(entry.module);
+	if (torch::cuda::is_available()) torch::cuda::synchronize();
+	last_warmup_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "[NetworkCache] warm-up of network " << network << " for shape " << c10::IntArrayRef(shape) << ": " << warmup_passes << " passes, " << last_warmup_ms << " ms" << std::endl;
+}
+
+void NetworkCache::erase(int network) {
+	auto it = entries.find(network);
+	if (it == entries.end()) return;
+	bytes -= it->second.bytes;
+	entries.erase(it);
+}
+
+void NetworkCache::clear() {
+	entries.clear();
+	bytes = 0;
+}
+
+void NetworkCache::set_capacity_bytes(size_t bytes) {
+	capacity_bytes = bytes;
+	while (entries.size() > 1 && this->bytes > capacity_bytes)
+		evict_oldest();
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <functional>
+#include <map>
+#include <vector>
+
+#include <torch/script.h>
+
+/*  Network Cache: inference ready modules per network
+	The loaded traces are frozen (parameters inlined as constants) and passed through optimize_for_inference
+	(conv-bn folding, fusions) on first use. The modules do not depend on the input shape, one copy per network
+	serves every resolution, so a resize or a step of the dynamic resolution does not optimize again. The profiling
+	executor specializes the graph per input shape though, so the warm-up runs again for every new shape.
+	Common usage:
+		per frame:
+			module = get(network, loaded_trace, trace_bytes)
+			warm_up(network, shape, forward)	runs forward warmup_passes times on the first use of the network with shape
+			module.forward(...)
+	Least recently used modules are dropped beyond capacity or capacity_bytes. The memory of a copy is estimated by the
+	size of its trace, shared traces (optimize off) count 0.
+*/
+class NetworkCache {
+//data
+public:
+	bool optimize = true;			// freeze and optimize_for_inference, otherwise the loaded traces are shared as they are
+	int warmup_passes = 3;			// forward passes on the first use of a network with an input shape
+	size_t warm_shapes = 16;		// shapes remembered as warm per network (covers the levels of ResolutionController), the oldest is warmed up again when it returns
+	size_t capacity = 8;			// max cached modules
+	size_t capacity_bytes = ~size_t(0);	// max memory of the cached copies, see set_capacity_bytes
+	size_t bytes = 0;				// memory of the cached copies
+	double last_warmup_ms = 0.0;	// duration of the last warm-up
+
+//methods
+public:
+	// module of network, optimized from trace (of trace_bytes) on the first call
+	torch::jit::script::Module& get(int network, const torch::jit::script::Module& trace, size_t trace_bytes);
+	// runs forward warmup_passes times if the module was not warmed up with the input shape yet (any key of the shape)
+	void warm_up(int network, const std::vector<int64_t>& shape, const std::function<void(torch::jit::script::Module&)>& forward);
+	// drop all optimized modules of a network, e.g. after its trace was unloaded
+	void erase(int network);
+	// drop all optimized modules, e.g. after changing optimize
+	void clear();
+	// drops least recently used modules beyond bytes, except the last used one
+	void set_capacity_bytes(size_t bytes);
+
+private:
+	struct Entry {
+		torch::jit::script::Module module;
+		std::vector<std::vector<int64_t>> warm;	// warmed up shapes, oldest first
+		uint64_t last_use = 0;
+		size_t bytes = 0;
+	};
+	torch::jit::script::Module optimized(const torch::jit::script::Module& module);
+	void evict_oldest();
+
+	std::map<int, Entry> entries;
+	uint64_t use_counter = 0;
+};
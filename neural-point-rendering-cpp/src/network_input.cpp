@@ -0,0 +1,177 @@
+#include "network_input.h"
+#include "pixel_transfer.h"
+#include "cpu_mipmap.h"
+
+NetworkInputArena::NetworkInputArena() {}
+
+void NetworkInputArena::configure(int groundtruth_amount, int movec_channels, torch::Device device, bool channels_last, bool encoded_groundtruth, bool pre_init_motion) {
+	this->pre_init_motion = pre_init_motion;
+	if (device != this->device || channels_last != this->channels_last || movec_channels != this->movec_channels) {
+		clear();
+		this->device = device;
+		this->channels_last = channels_last;
+		this->movec_channels = movec_channels;
+	}
+	if (int(groundtruth.size()) != groundtruth_amount) {
+		groundtruth.resize(groundtruth_amount);
+		motion.resize(groundtruth_amount);
+		features.resize(groundtruth_amount);
+		dirty = true;
+	}
+	if (encoded_groundtruth != this->encoded_groundtruth) {
+		this->encoded_groundtruth = encoded_groundtruth;
+		dirty = true;
+	}
+}
+
+torch::Tensor& NetworkInputArena::ensure(torch::Tensor& t, int channels, int height, int width) {
+	if (t.defined() && t.size(1) == channels && t.size(2) == height && t.size(3) == width) return t;
+	auto options = torch::TensorOptions().device(device).dtype(torch::kFloat32);
+	t = torch::empty({ 1, channels, height, width }, options.memory_format(channels_last ? torch::MemoryFormat::ChannelsLast : torch::MemoryFormat::Contiguous));
+	dirty = true;
+	return t;
+}
+
+const torch::Tensor& NetworkInputArena::flip_index(int height) {
+	auto it = flip_indices.find(height);
+	if (it == flip_indices.end())
+		it = flip_indices.emplace(height, torch::arange(height - 1, -1, -1, torch::TensorOptions().device(device).dtype(torch::kLong))).first;
+	return it->second;
+}
+
+static glm::ivec2 used_size(const Texture2D& tex, glm::ivec2 size) {
+	return size.x > 0 && size.y > 0 ? size : glm::ivec2(tex->w, tex->h);
+}
+
+// copy the first channels of tex into dst (1xCxHxW view into the arena), flipping y on the way
+// only the HxW part at the origin of tex is used (the first rows in gl layout)
+void NetworkInputArena::pack(torch::Tensor dst, const Texture2D& tex, int channels) {
+	torch::Tensor src = texture2D_to_staging(tex, staging[{ tex->w, tex->h, get_transfer_channels(tex) }]);
+	const int height = int(dst.size(2));
+	src = src.narrow(0, 0, height).narrow(1, 0, dst.size(3)).narrow(2, 0, channels).permute({ 2,0,1 }).unsqueeze(0);
+	if (src.device() != device || src.scalar_type() != dst.scalar_type())
+		src = src.to(device, dst.scalar_type()); // only if texture and arena disagree, allocates
+	torch::index_select_out(dst, src, 2, flip_index(height));
+}
+
+void NetworkInputArena::pack_resolution(int level, const Texture2D& rgb, const Texture2D& depth, glm::ivec2 size) {
+	size = used_size(rgb, size);
+	torch::Tensor& t = ensure(resolutions[level], 4, size.y, size.x);
+	pack(t.narrow(1, 0, 3), rgb, 3);
+	pack(t.narrow(1, 3, 1), depth, 1);
+}
+
+void NetworkInputArena::pack_groundtruth(int i, const Texture2D& rgb, const Texture2D& depth, glm::ivec2 size) {
+	size = used_size(rgb, size);
+	torch::Tensor& t = ensure(groundtruth[i], 4, size.y, size.x);
+	pack(t.narrow(1, 0, 3), rgb, 3);
+	pack(t.narrow(1, 3, 1), depth, 1);
+}
+
+void NetworkInputArena::pack_groundtruth(int i, const Texture2D& rgbd) {
+	pack(ensure(groundtruth[i], 4, rgbd->h, rgbd->w), rgbd, 4);
+}
+
+// the channels of the motion vectors (x, y, 1, 1) a compact target does not store: the third channel is 1 where a point was rendered
+// (or everywhere for pre-initialized motion), the fourth is 1
+void NetworkInputArena::pack_motion_channels(torch::Tensor dst, const Texture2D& motion_tex, int level) {
+	const int channels = int(dst.size(1));
+	const int stored = std::min(channels, get_transfer_channels(motion_tex));
+	pack(dst.narrow(1, 0, stored), motion_tex, stored);
+	for (int c = stored; c < channels; ++c) {
+		torch::Tensor channel = dst.narrow(1, c, 1);
+		const torch::Tensor& depth = resolutions[level];
+		if (c != 2 || pre_init_motion)
+			channel.fill_(1.f);
+		else if (!depth.defined() || depth.size(2) != dst.size(2) || depth.size(3) != dst.size(3)) {
+			std::cerr << "[NetworkInputArena] WARNING: no depth of level " << level << " for the motion of size " << dst.sizes() << ", every pixel is rendered" << std::endl;
+			channel.fill_(1.f);
+		}
+		else {
+			// rendered pixels have a depth in (0,1), empty ones 0 (res0) or 1 (mip levels): sign(d * (1 - d)), in place
+			const torch::Tensor d = depth.narrow(1, 3, 1);
+			channel.copy_(d).sub_(1.f).mul_(d).neg_().sign_();
+		}
+	}
+}
+
+void NetworkInputArena::pack_motion(int i, const Texture2D& motion_tex, glm::ivec2 size, int level) {
+	size = used_size(motion_tex, size);
+	pack_motion_channels(ensure(motion[i], movec_channels, size.y, size.x), motion_tex, level);
+}
+
+void NetworkInputArena::pack_pyramid(const Texture2D& rgb, const Texture2D& depth, const std::vector<Texture2D>& motion_tex, const std::array<glm::ivec2, 4>& sizes, int motion_level) {
+	pack_resolution(0, rgb, depth, sizes[0]);
+	const int n = int(motion_tex.size());
+	std::vector<torch::Tensor> motion_high, motion_low;
+	if (motion_level <= 0)
+		for (int i = 0; i < n; ++i) pack_motion(i, motion_tex[i], sizes[0]);
+	else {
+		motion_levels[0].resize(n);
+		motion_levels[1].resize(n);
+		for (int i = 0; i < n; ++i) {
+			motion_high.push_back(ensure(motion_levels[0][i], movec_channels, sizes[0].y, sizes[0].x));
+			pack_motion_channels(motion_high.back(), motion_tex[i], 0);
+		}
+	}
+	for (int level = 1; level < 4; ++level) {
+		torch::Tensor& low = ensure(resolutions[level], 4, sizes[level].y, sizes[level].x);
+		motion_low.clear();
+		if (level <= motion_level)
+			for (int i = 0; i < n; ++i)
+				motion_low.push_back(ensure(level == motion_level ? motion[i] : motion_levels[level % 2][i], movec_channels, sizes[level].y, sizes[level].x));
+		cpu_mipmap(resolutions[level - 1], low, motion_high, motion_low);
+		motion_high = motion_low;
+	}
+}
+
+void NetworkInputArena::set_features(int i, const torch::Tensor& encoded) {
+	if (features[i].is_same(encoded)) return;
+	features[i] = encoded;
+	dirty = true;
+}
+
+const std::vector<torch::jit::IValue>& NetworkInputArena::inputs() {
+	if (dirty) {
+		// the tuples reference the arena tensors, in place updates are visible without rebuilding
+		input_values.clear();
+		input_values.push_back(c10::ivalue::Tuple::create(std::vector<torch::jit::IValue>(resolutions.begin(), resolutions.end())));
+		const std::vector<torch::Tensor>& gt = groundtruth_inputs();
+		input_values.push_back(c10::ivalue::Tuple::create(std::vector<torch::jit::IValue>(gt.begin(), gt.end())));
+		input_values.push_back(c10::ivalue::Tuple::create(std::vector<torch::jit::IValue>(motion.begin(), motion.end())));
+		dirty = false;
+	}
+	return input_values;
+}
+
+void NetworkInputArena::unpack_output(const torch::Tensor& network_output, const Texture2D& tex, glm::ivec2 size) {
+	size = used_size(tex, size);
+	torch::Tensor src = network_output.dim() == 4 ? network_output.squeeze(0) : network_output;
+	if (src.size(0) < 3 || src.size(1) != size.y || src.size(2) != size.x) {
+		std::cerr << "[NetworkInputArena] WARNING: network output of size " << network_output.sizes() << " does not match texture " << tex->name << " [" << size.y << ", " << size.x << "]" << std::endl;
+		return;
+	}
+	if (!output.defined() || output.size(0) != tex->h || output.size(1) != tex->w) {
+		output = torch::ones({ tex->h, tex->w, 4 }, torch::TensorOptions().device(device).dtype(torch::kFloat32));
+	}
+	src = src.narrow(0, 0, 3).permute({ 1,2,0 });
+	if (src.scalar_type() != output.scalar_type())
+		src = src.to(output.scalar_type());
+	// alpha channel of output is never written -> stays one. the unused part of tex keeps older outputs
+	torch::Tensor output_rgb = output.narrow(0, 0, size.y).narrow(1, 0, size.x).narrow(2, 0, 3);
+	torch::index_select_out(output_rgb, src, 0, flip_index(size.y));
+	staging_to_texture2D(output, tex);
+}
+
+void NetworkInputArena::clear() {
+	for (auto& t : resolutions) t = torch::Tensor();
+	for (auto& t : groundtruth) t = torch::Tensor();
+	for (auto& t : motion) t = torch::Tensor();
+	for (auto& t : features) t = torch::Tensor();
+	output = torch::Tensor();
+	staging.clear();
+	flip_indices.clear();
+	for (auto& levels : motion_levels) levels.clear();
+	input_values.clear();
+	dirty = true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cppgl.h>
+#include <array>
+#include <map>
+#include <vector>
+
+#include <torch/script.h>
+#include "texture_copy.h"
+
+/*  Network Input Arena: persistent, preallocated network inputs and output
+	Layout (1xCxHxW each, optionally channels last):
+		resolutions:	4 tensors, rgb + depth of fbo_res0 - fbo_res3
+		groundtruth:	N tensors, rgb + depth of the auxiliary views (or of the previous output for taa)
+		motion:			N tensors, the first movec_channels channels of the motion targets. Compact (rg) targets only store x and y,
+						the third channel is restored: 1 where a point was rendered (depth in (0,1)), everywhere for pre-initialized motion
+		features:		N tensors, encoded groundtruth of networks split into encoder and decoder. Replace groundtruth in inputs()
+	Common usage:
+		per frame:
+			configure(...)						keeps all allocations if nothing changed
+			pack_resolution/groundtruth/motion	fused copy + channel crop + y flip from the texture into the arena
+			or pack_pyramid instead of pack_resolution/motion	only res0 is read back, the lower resolutions are downsampled on the host
+			forward(inputs())					the ivalue tuples are only rebuilt if an input was reallocated
+			unpack_output(output, tex)			flips the output into a persistent rgba buffer (alpha stays one) and copies it into tex
+	In the steady state no tensor storage is allocated, apart from the output of the network itself.
+	Render targets at a dynamic resolution only use the size x size part at their origin, zero uses the whole texture.
+*/
+class NetworkInputArena {
+//data
+public:
+	std::array<torch::Tensor, 4> resolutions;
+	std::vector<torch::Tensor> groundtruth;
+	std::vector<torch::Tensor> motion;
+	std::vector<torch::Tensor> features;
+	torch::Tensor output;						// HxWx4 in gl layout
+
+//methods
+public:
+	NetworkInputArena();
+
+	// (re-)configure the input amount/layout. inputs are only reallocated if the configuration changed
+	void configure(int groundtruth_amount, int movec_channels, torch::Device device, bool channels_last, bool encoded_groundtruth = false, bool pre_init_motion = true);
+
+	void pack_resolution(int level, const Texture2D& rgb, const Texture2D& depth, glm::ivec2 size = glm::ivec2(0));
+	// rgb from the first, depth from the first channel of the second texture
+	void pack_groundtruth(int i, const Texture2D& rgb, const Texture2D& depth, glm::ivec2 size = glm::ivec2(0));
+	// rgb + depth in alpha
+	void pack_groundtruth(int i, const Texture2D& rgbd);
+	// level: resolution of the motion target, its packed depth restores the channels of compact targets (pack_resolution first)
+	void pack_motion(int i, const Texture2D& motion_tex, glm::ivec2 size = glm::ivec2(0), int level = 0);
+	// cpu devices: res0 (and the motion targets at res0) packed, res1 - res3 (and the motion of motion_level) downsampled on the host
+	// like the mip map passes (see cpu_mipmap.h), instead of packing the lower resolution targets
+	void pack_pyramid(const Texture2D& rgb, const Texture2D& depth, const std::vector<Texture2D>& motion_tex, const std::array<glm::ivec2, 4>& sizes, int motion_level);
+	// encoder output for groundtruth i, referenced instead of copied (e.g. from the feature cache)
+	void set_features(int i, const torch::Tensor& encoded);
+
+	// groundtruth or its features, depending on the configuration
+	const std::vector<torch::Tensor>& groundtruth_inputs() const { return encoded_groundtruth ? features : groundtruth; }
+
+	// (res0, res1, res2, res3), (gt_0, ..., gt_N-1) or (features_0, ..., features_N-1), (motion_0, ..., motion_N-1)
+	const std::vector<torch::jit::IValue>& inputs();
+
+	// network output 1x3xHxW (or 3xHxW) -> tex (rgba, alpha = 1)
+	void unpack_output(const torch::Tensor& network_output, const Texture2D& tex, glm::ivec2 size = glm::ivec2(0));
+
+	// drop all allocations, e.g. after switching networks
+	void clear();
+
+private:
+	torch::Tensor& ensure(torch::Tensor& t, int channels, int height, int width);
+	const torch::Tensor& flip_index(int height);
+	void pack(torch::Tensor dst, const Texture2D& tex, int channels);
+	void pack_motion_channels(torch::Tensor dst, const Texture2D& motion_tex, int level);
+
+	torch::Device device = torch::kCUDA;
+	bool channels_last = false;
+	int movec_channels = 0;
+	bool encoded_groundtruth = false;
+	bool pre_init_motion = true;
+	bool dirty = true;				// an input was reallocated -> rebuild input_values
+
+	std::vector<torch::jit::IValue> input_values;
+	std::map<std::array<int, 3>, torch::Tensor> staging;	// transfer buffers per texture size (interop only), consumed right away
+	std::map<int, torch::Tensor> flip_indices;	// reversed row indices per height
+	std::array<std::vector<torch::Tensor>, 2> motion_levels;	// motion of the levels between res0 and motion_level (pack_pyramid)
+};
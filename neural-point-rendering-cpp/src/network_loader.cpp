@@ -0,0 +1,173 @@
+#include "network_loader.h"
+#include <filesystem>
+#include <iostream>
+
+NetworkLoader::NetworkLoader(torch::Device device) : device(device) {
+	worker = std::thread(&NetworkLoader::work, this);
+}
+
+NetworkLoader::~NetworkLoader() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		running = false;
+	}
+	cv_work.notify_all();
+	cv_loaded.notify_all();
+	if (worker.joinable()) worker.join();
+}
+
+int NetworkLoader::add(const Paths& paths) {
+	std::lock_guard<std::mutex> lock(mutex);
+	Entry entry;
+	entry.paths = paths;
+	entries.push_back(entry);
+	return int(entries.size()) - 1;
+}
+
+std::shared_ptr<NetworkLoader::Network> NetworkLoader::get(int network) {
+	bool queued = false;
+	std::shared_ptr<Network> result;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		Entry& entry = entries[network];
+		entry.last_use = ++use_counter;
+		if (entry.state == State::UNLOADED) {
+			entry.state = State::QUEUED;
+			queue.push_back(network);
+			queued = true;
+		}
+		result = entry.network;
+	}
+	if (queued) cv_work.notify_one();
+	return result;
+}
+
+std::shared_ptr<NetworkLoader::Network> NetworkLoader::wait(int network) {
+	std::shared_ptr<Network> result = get(network);
+	if (result) return result;
+	std::unique_lock<std::mutex> lock(mutex);
+	cv_loaded.wait(lock, [&] { return entries[network].state != State::QUEUED || !running; });
+	return entries[network].network;
+}
+
+bool NetworkLoader::loading(int network) {
+	std::lock_guard<std::mutex> lock(mutex);
+	return entries[network].state == State::QUEUED;
+}
+
+std::string NetworkLoader::error(int network) {
+	std::lock_guard<std::mutex> lock(mutex);
+	return entries[network].error;
+}
+
+void NetworkLoader::set_capacity(size_t bytes) {
+	std::lock_guard<std::mutex> lock(mutex);
+	capacity_bytes = bytes;
+}
+
+size_t NetworkLoader::loaded_bytes() {
+	std::lock_guard<std::mutex> lock(mutex);
+	size_t bytes = 0;
+	for (const auto& entry : entries)
+		if (entry.network) bytes += entry.network->bytes;
+	return bytes;
+}
+
+int NetworkLoader::loaded_count() {
+	std::lock_guard<std::mutex> lock(mutex);
+	int count = 0;
+	for (const auto& entry : entries)
+		if (entry.network) ++count;
+	return count;
+}
+
+std::vector<int> NetworkLoader::take_evicted() {
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<int> result;
+	result.swap(evicted);
+	return result;
+}
+
+torch::jit::script::Module NetworkLoader::load(const std::string& path) {
+	std::cout << "\tload Net: " << path << std::endl;
+	torch::jit::script::Module module = torch::jit::load(path, device);
+	module.eval();
+	return module;
+}
+
+void NetworkLoader::evict(int keep) {
+	// never drop the network that was just loaded or the one that was requested last
+	int most_recent = -1;
+	size_t bytes = 0;
+	for (int i = 0; i < int(entries.size()); ++i) {
+		if (!entries[i].network) continue;
+		bytes += entries[i].network->bytes;
+		if (most_recent < 0 || entries[i].last_use > entries[most_recent].last_use) most_recent = i;
+	}
+	while (bytes > capacity_bytes) {
+		int oldest = -1;
+		for (int i = 0; i < int(entries.size()); ++i) {
+			if (!entries[i].network || i == keep || i == most_recent) continue;
+			if (oldest < 0 || entries[i].last_use < entries[oldest].last_use) oldest = i;
+		}
+		if (oldest < 0) break;
+		std::cout << "[NetworkLoader] drop network " << oldest << " (" << (entries[oldest].network->bytes >> 20) << " MB)" << std::endl;
+		bytes -= entries[oldest].network->bytes;
+		entries[oldest].network.reset();
+		entries[oldest].state = State::UNLOADED;
+		evicted.push_back(oldest);
+	}
+}
+
+void NetworkLoader::work() {
+	while (true) {
+		int i;
+		Paths paths;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			cv_work.wait(lock, [&] { return !queue.empty() || !running; });
+			if (!running) return;
+			i = queue.front();
+			queue.pop_front();
+			paths = entries[i].paths;
+		}
+		auto network = std::make_shared<Network>();
+		std::string error;
+		try {
+			network->module = load(paths.module);
+			network->module_bytes = std::filesystem::file_size(paths.module);
+			network->bytes = network->module_bytes;
+			if (!paths.encoder.empty()) {
+				network->encoder = load(paths.encoder);
+				network->has_encoder = true;
+				network->bytes += std::filesystem::file_size(paths.encoder);
+			}
+			if (!paths.reference.empty()) {
+				network->reference = load(paths.reference);
+				network->has_reference = true;
+				network->bytes += std::filesystem::file_size(paths.reference);
+			}
+		}
+		catch (const c10::Error& e) {
+			error = e.what_without_backtrace();
+		}
+		catch (const std::filesystem::filesystem_error& e) {
+			error = e.what();
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			Entry& entry = entries[i];
+			if (error.empty()) {
+				entry.network = network;
+				entry.state = State::LOADED;
+				evict(i);
+			}
+			else {
+				std::cerr << "[NetworkLoader] FATAL ERROR: failed to load " << paths.module << ": " << error << std::endl;
+				entry.error = error;
+				entry.state = State::FAILED;
+			}
+		}
+		cv_loaded.notify_all();
+	}
+}
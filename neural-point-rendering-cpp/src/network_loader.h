@@ -0,0 +1,93 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <torch/script.h>
+
+/*  Network Loader: loads the traces of a network on first use on a background thread
+	Networks are registered with their file paths at startup, nothing is loaded until get() asks for one.
+	Loaded networks are kept in an LRU cache. If their memory exceeds the capacity, the least recently used
+	networks are dropped (never the one that was just requested) and loaded again on their next use.
+	The memory of a network is estimated by the file sizes of its traces, the frozen traces keep their weights as constants.
+	Common usage:
+		on startup:
+			add({ path, encoder_path, reference_path })
+		per frame:
+			network = get(network_id)		nullptr while loading -> skip the inference
+	Modules handed out stay valid after eviction until the last copy is released (e.g. by the inference pipeline).
+*/
+class NetworkLoader {
+//structs
+public:
+	struct Paths {
+		std::string module;			// full trace or decoder of split networks
+		std::string encoder;		// auxiliary image encoder of split networks, empty otherwise
+		std::string reference;		// fp32 reference of reduced precision networks, empty otherwise
+	};
+	struct Network {
+		torch::jit::script::Module module, encoder, reference;	// encoder and reference are only set if their path is
+		bool has_encoder = false;
+		bool has_reference = false;
+		size_t bytes = 0;
+		size_t module_bytes = 0;	// of module alone, the part the network cache copies
+	};
+
+//methods
+public:
+	NetworkLoader(torch::Device device);
+	~NetworkLoader();
+
+	// register a network, returns its index
+	int add(const Paths& paths);
+	size_t size() const { return entries.size(); }
+
+	// the loaded network, nullptr while it is loading. the first call queues the network for loading
+	std::shared_ptr<Network> get(int network);
+	// like get(), but blocks until the network is loaded. nullptr if it failed (offline rendering)
+	std::shared_ptr<Network> wait(int network);
+	bool loading(int network);
+	// message of a failed load, empty otherwise. a failed network is not loaded again
+	std::string error(int network);
+	// memory limit of the loaded networks, applied when the next network finished loading
+	void set_capacity(size_t bytes);
+	// memory of all loaded networks and their amount
+	size_t loaded_bytes();
+	int loaded_count();
+	// ids of networks that were dropped since the last call, to release caches that depend on them
+	std::vector<int> take_evicted();
+
+	NetworkLoader(const NetworkLoader&) = delete;
+	NetworkLoader& operator=(const NetworkLoader&) = delete;
+
+private:
+	enum class State { UNLOADED, QUEUED, LOADED, FAILED };
+	struct Entry {
+		Paths paths;
+		State state = State::UNLOADED;
+		std::shared_ptr<Network> network;
+		std::string error;
+		uint64_t last_use = 0;
+	};
+
+	void work();
+	torch::jit::script::Module load(const std::string& path);
+	void evict(int keep);	// expects the mutex to be locked
+
+	torch::Device device;
+	size_t capacity_bytes = size_t(2048) << 20;
+	std::vector<Entry> entries;
+	std::vector<int> evicted;
+	uint64_t use_counter = 0;
+
+	std::thread worker;
+	std::mutex mutex;
+	std::condition_variable cv_work;
+	std::condition_variable cv_loaded;
+	std::deque<int> queue;
+	bool running = true;
+};
@@ -0,0 +1,82 @@
+#include "network_precision.h"
+#include <ATen/autocast_mode.h>
+#include <torch/version.h>
+#include <cmath>
+#include <iostream>
+
+// autocast api became device generic with libtorch 2.4
+#if TORCH_VERSION_MAJOR > 2 || (TORCH_VERSION_MAJOR == 2 && TORCH_VERSION_MINOR >= 4)
+#define NPR_AUTOCAST_DEVICE_API 1
+#endif
+
+NetworkPrecision parse_network_precision(const std::string& value) {
+	if (value == "fp32") return NetworkPrecision::FP32;
+	if (value == "bf16") return NetworkPrecision::BF16;
+	if (value == "int8") return NetworkPrecision::INT8;
+	std::cerr << "[NetworkPrecision] WARNING: unknown precision " << value << ", should be in [fp32, bf16, int8]. Using fp32." << std::endl;
+	return NetworkPrecision::FP32;
+}
+
+std::string network_precision_name(NetworkPrecision precision) {
+	switch (precision) {
+	case NetworkPrecision::BF16: return "bf16";
+	case NetworkPrecision::INT8: return "int8";
+	default: return "fp32";
+	}
+}
+
+std::string network_trace_path(const std::string& networks_path, const std::string& name, NetworkPrecision precision) {
+	if (precision == NetworkPrecision::INT8) return networks_path + name + "_int8.pt";
+	return networks_path + name + ".pt";
+}
+
+PrecisionGuard::PrecisionGuard(NetworkPrecision precision, torch::Device device) {
+	if (precision != NetworkPrecision::BF16) return;
+	active = true;
+	cuda = device.is_cuda();
+#ifdef NPR_AUTOCAST_DEVICE_API
+	const at::DeviceType type = cuda ? at::kCUDA : at::kCPU;
+	prev_enabled = at::autocast::is_autocast_enabled(type);
+	prev_dtype = at::autocast::get_autocast_dtype(type);
+	at::autocast::set_autocast_enabled(type, true);
+	at::autocast::set_autocast_dtype(type, at::kBFloat16);
+#else
+	prev_enabled = cuda ? at::autocast::is_enabled() : at::autocast::is_cpu_enabled();
+	prev_dtype = cuda ? at::autocast::get_autocast_gpu_dtype() : at::autocast::get_autocast_cpu_dtype();
+	if (cuda) {
+		at::autocast::set_enabled(true);
+		at::autocast::set_autocast_gpu_dtype(at::kBFloat16);
+	}
+	else {
+		at::autocast::set_cpu_enabled(true);
+		at::autocast::set_autocast_cpu_dtype(at::kBFloat16);
+	}
+#endif
+	at::autocast::increment_nesting();
+}
+
+PrecisionGuard::~PrecisionGuard() {
+	if (!active) return;
+	// casted weights are cached while autocast is nested
+	if (at::autocast::decrement_nesting() == 0) at::autocast::clear_cache();
+#ifdef NPR_AUTOCAST_DEVICE_API
+	const at::DeviceType type = cuda ? at::kCUDA : at::kCPU;
+	at::autocast::set_autocast_enabled(type, prev_enabled);
+	at::autocast::set_autocast_dtype(type, prev_dtype);
+#else
+	if (cuda) {
+		at::autocast::set_enabled(prev_enabled);
+		at::autocast::set_autocast_gpu_dtype(prev_dtype);
+	}
+	else {
+		at::autocast::set_cpu_enabled(prev_enabled);
+		at::autocast::set_autocast_cpu_dtype(prev_dtype);
+	}
+#endif
+}
+
+double network_psnr(const torch::Tensor& output, const torch::Tensor& reference) {
+	double mse = (output.to(torch::kFloat32) - reference.to(torch::kFloat32)).pow(2).mean().item<double>();
+	if (mse <= 0.0) return 100.0;
+	return 10.0 * std::log10(1.0 / mse);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+
+#include <torch/torch.h>
+
+/*  Network Precision: per network inference precision, selected with 'precision: <fp32|bf16|int8>' in the networks .txt
+		fp32: the trace as exported
+		bf16: the fp32 trace, run with bf16 autocast on the inference device (PrecisionGuard)
+		int8: the statically quantized trace <name>_int8.pt, calibrated on captured frames during export (cpu only)
+*/
+enum class NetworkPrecision {
+	FP32 = 0,
+	BF16 = 1,
+	INT8 = 2
+};
+
+// unknown values fall back to fp32 with a warning
+NetworkPrecision parse_network_precision(const std::string& value);
+std::string network_precision_name(NetworkPrecision precision);
+// file of the trace that is loaded for the precision
+std::string network_trace_path(const std::string& networks_path, const std::string& name, NetworkPrecision precision);
+
+// enables bf16 autocast on the device for its lifetime, no-op for fp32 and int8
+class PrecisionGuard {
+public:
+	PrecisionGuard(NetworkPrecision precision, torch::Device device);
+	~PrecisionGuard();
+
+	PrecisionGuard(const PrecisionGuard&) = delete;
+	PrecisionGuard& operator=(const PrecisionGuard&) = delete;
+
+private:
+	bool active = false;
+	bool cuda = false;
+	bool prev_enabled = false;
+	at::ScalarType prev_dtype = at::kBFloat16;
+};
+
+// psnr in db of output vs reference, both in [0,1]
+double network_psnr(const torch::Tensor& output, const torch::Tensor& reference);
@@ -0,0 +1,244 @@
+#include "occlusion_culler.h"
+#include <ATen/Parallel.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+// ------------------------------------------
+// helper funcs
+
+static glm::ivec2 level_size(const glm::ivec2& size, int level) {
+	return glm::max(glm::ivec2(1), glm::ivec2(size.x >> level, size.y >> level));
+}
+
+// ------------------------------------------
+// OcclusionCuller
+
+void OcclusionCuller::select(FrustumCuller& culler, const std::vector<PointCloudVoxel>& voxels, const glm::vec3& cam_pos, const glm::vec3& cam_dir,
+	const glm::vec3& cam_up, float cam_near, float cam_far, float cam_fov, float cam_aspect) {
+	frustum.resize(voxels.size());
+	culler.cull(cam_pos, cam_dir, cam_up, cam_near, cam_far, cam_fov, cam_aspect, frustum.data());
+	candidates.clear();
+	for (uint32_t i = 0; i < uint32_t(voxels.size()); ++i)
+		if (frustum[i].count > 0)
+			candidates.emplace_back(glm::distance(voxels[i].center, cam_pos) - voxels[i].radius, i);
+	const size_t count = std::min(candidates.size(), size_t(std::max(0, occluder_voxels)));
+	std::nth_element(candidates.begin(), candidates.begin() + count, candidates.end());
+
+	occluder_list.clear();
+	occluder_points = 0;
+	for (size_t k = 0; k < count; ++k) {
+		const PointCloudVoxel& v = voxels[candidates[k].second];
+		DrawElementsIndirectCommand command;
+		command.count = v.size;
+		command.instanceCount = 1;
+		command.first = v.start;
+		command.baseVertex = 0;
+		command.baseInstance = 0;
+		occluder_list.push_back(command);
+		occluder_points += v.size;
+	}
+	const size_t bytes = sizeof(DrawElementsIndirectCommand) * occluder_list.size();
+	if (!occluders) occluders = DIBO("occlusion/occluders");
+	if (occluders->size_bytes < bytes) occluders->resize(bytes);
+	if (bytes > 0) occluders->upload_subdata(occluder_list.data(), 0, bytes);
+}
+
+void OcclusionCuller::begin_prepass(const glm::ivec2& resolution, const glm::mat4& view_proj, int point_size) {
+	this->view_proj = view_proj;
+	this->point_size = point_size;
+	size = glm::max(resolution, glm::ivec2(1));
+	levels = 1;
+	while ((std::max(size.x, size.y) >> levels) > 0) ++levels;
+
+	// same depth format as the point pass, the pre-pass depths are the ones it writes
+	if (!prepass || int(prepass->w) < size.x || int(prepass->h) < size.y) {
+		const glm::ivec2 alloc = prepass ? glm::max(size, glm::ivec2(prepass->w, prepass->h)) : size;
+		if (prepass) {
+			Texture2D::erase(prepass->depth_texture->name);
+			Framebuffer::erase(prepass->name);
+		}
+		prepass = Framebuffer("occlusion/prepass", alloc.x, alloc.y);
+		prepass->attach_depthbuffer(Texture2D("occlusion/prepass_depth", alloc.x, alloc.y, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT));
+		prepass->check();
+	}
+	prepass->bind();
+	glViewport(0, 0, size.x, size.y);
+	glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void OcclusionCuller::end_prepass() {
+	prepass->unbind();
+}
+
+void OcclusionCuller::build(const Shader& build_shader) {
+	if (hiz_size != size) {
+		if (hiz) glDeleteTextures(1, &hiz);
+		glCreateTextures(GL_TEXTURE_2D, 1, &hiz);
+		glTextureStorage2D(hiz, levels, GL_R32F, size.x, size.y);
+		glTextureParameteri(hiz, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTextureParameteri(hiz, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		hiz_size = size;
+	}
+	build_shader->bind();
+	build_shader->uniform("depth", prepass->depth_texture, 0);
+	for (int level = 0; level < levels; ++level) {
+		const glm::ivec2 dst = level_size(size, level);
+		build_shader->uniform("level", level);
+		build_shader->uniform("src_size", level_size(size, std::max(level - 1, 0)));
+		build_shader->uniform("dst_size", dst);
+		if (level > 0) glBindImageTexture(0, hiz, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+		glBindImageTexture(1, hiz, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		build_shader->dispatch_compute(dst.x, dst.y);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	}
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+	glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+	glBindImageTexture(1, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+	build_shader->unbind();
+}
+
+void OcclusionCuller::build_cpu() {
+	// the readback of the previous call, its fence has signaled by now in general
+	if (readback_fence) {
+		GLenum res = glClientWaitSync(readback_fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+		while (res == GL_TIMEOUT_EXPIRED)
+			res = glClientWaitSync(readback_fence, 0, 1000000); // 1ms
+		glDeleteSync(readback_fence);
+		readback_fence = 0;
+		cpu_view_proj = readback_view_proj;
+		cpu_size = readback_size;
+		cpu_point_size = readback_point_size;
+		cpu_occluders.swap(readback_occluders);
+		int cpu_level_count = 1;
+		while ((std::max(cpu_size.x, cpu_size.y) >> cpu_level_count) > 0) ++cpu_level_count;
+		cpu_levels.resize(cpu_level_count);
+		cpu_levels[0].resize(size_t(cpu_size.x) * size_t(cpu_size.y));
+		glGetNamedBufferSubData(readback->id, 0, GLsizeiptr(cpu_levels[0].size() * sizeof(float)), cpu_levels[0].data());
+		// same as hizBuild.glcs
+		for (int level = 1; level < cpu_level_count; ++level) {
+			const glm::ivec2 src = level_size(cpu_size, level - 1);
+			const glm::ivec2 dst = level_size(cpu_size, level);
+			const std::vector<float>& in = cpu_levels[level - 1];
+			std::vector<float>& out = cpu_levels[level];
+			out.resize(size_t(dst.x) * size_t(dst.y));
+			for (int y = 0; y < dst.y; ++y) {
+				const int y1 = y == dst.y - 1 ? src.y - 1 : 2 * y + 1;
+				for (int x = 0; x < dst.x; ++x) {
+					const int x1 = x == dst.x - 1 ? src.x - 1 : 2 * x + 1;
+					float d = 0.f;
+					for (int sy = std::min(2 * y, src.y - 1); sy <= y1; ++sy)
+						for (int sx = std::min(2 * x, src.x - 1); sx <= x1; ++sx)
+							d = std::max(d, in[size_t(sy) * src.x + sx]);
+					out[size_t(y) * dst.x + x] = d;
+				}
+			}
+		}
+	}
+
+	// start the readback of the current pre-pass into the pixel buffer, returns immediately
+	const size_t bytes = size_t(size.x) * size_t(size.y) * sizeof(float);
+	if (!readback) readback = PPBO("occlusion/readback");
+	if (readback->size_bytes < bytes) readback->resize(bytes, GL_STREAM_READ);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	readback->bind();
+	glGetTextureSubImage(prepass->depth_texture->id, 0, 0, 0, 0, size.x, size.y, 1, GL_DEPTH_COMPONENT, GL_FLOAT, GLsizei(bytes), 0);
+	readback->unbind();
+	readback_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	readback_view_proj = view_proj;
+	readback_size = size;
+	readback_point_size = point_size;
+	readback_occluders = occluder_list;
+}
+
+bool OcclusionCuller::cpu_valid() const {
+	return !cpu_levels.empty() && cpu_view_proj == view_proj && cpu_size == size && cpu_point_size == point_size
+		&& cpu_occluders.size() == occluder_list.size()
+		&& std::memcmp(cpu_occluders.data(), occluder_list.data(), sizeof(DrawElementsIndirectCommand) * occluder_list.size()) == 0;
+}
+
+void OcclusionCuller::bind(const Shader& cull_shader) const {
+	glBindTextureUnit(0, hiz);
+	cull_shader->uniform("occlusion", true);
+	cull_shader->uniform("hiz", 0);
+	cull_shader->uniform("hiz_size", size);
+	cull_shader->uniform("hiz_levels", levels);
+	cull_shader->uniform("hiz_view_proj", view_proj);
+	cull_shader->uniform("hiz_point_size", float(point_size));
+	cull_shader->uniform("hiz_depth_bias", depth_bias);
+}
+
+bool OcclusionCuller::occluded(const glm::vec3& aabb_min, const glm::vec3& aabb_max) const {
+	if (cpu_levels.empty()) return false;
+	const glm::ivec2 size = cpu_size;
+	const int levels = int(cpu_levels.size());
+	glm::vec2 rect_min = glm::vec2(1e30f), rect_max = glm::vec2(-1e30f);
+	float depth_min = 1e30f;
+	for (int i = 0; i < 8; ++i) {
+		const glm::vec3 corner = glm::vec3(i & 1 ? aabb_max.x : aabb_min.x, i & 2 ? aabb_max.y : aabb_min.y, i & 4 ? aabb_max.z : aabb_min.z);
+		const glm::vec4 clip = cpu_view_proj * glm::vec4(corner, 1);
+		if (clip.w <= 0.f) return false;
+		const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		const glm::vec2 window = (glm::vec2(ndc) * 0.5f + 0.5f) * glm::vec2(size);
+		rect_min = glm::min(rect_min, window);
+		rect_max = glm::max(rect_max, window);
+		depth_min = std::min(depth_min, ndc.z * 0.5f + 0.5f);
+	}
+	// pixels whose centers the points can reach
+	const float margin = float(cpu_point_size) * 0.5f + 1.f;
+	const glm::vec2 lo = glm::clamp(glm::floor(rect_min - margin), glm::vec2(-1), glm::vec2(size));
+	const glm::vec2 hi = glm::clamp(glm::floor(rect_max + margin), glm::vec2(-1), glm::vec2(size));
+	const glm::ivec2 p0 = glm::max(glm::ivec2(lo), glm::ivec2(0));
+	const glm::ivec2 p1 = glm::min(glm::ivec2(hi), size - 1);
+	if (p0.x > p1.x || p0.y > p1.y) return false;
+
+	int level = 0;
+	while (level < levels - 1 && ((p1.x >> level) - (p0.x >> level) > 1 || (p1.y >> level) - (p0.y >> level) > 1)) ++level;
+	const glm::ivec2 dim = level_size(size, level);
+	const glm::ivec2 t0 = glm::min(glm::ivec2(p0.x >> level, p0.y >> level), dim - 1);
+	const glm::ivec2 t1 = glm::min(glm::ivec2(p1.x >> level, p1.y >> level), dim - 1);
+	float depth_max = 0.f;
+	for (int y = t0.y; y <= t1.y; ++y)
+		for (int x = t0.x; x <= t1.x; ++x)
+			depth_max = std::max(depth_max, cpu_levels[level][size_t(y) * dim.x + x]);
+	return depth_min > depth_max + depth_bias;
+}
+
+size_t OcclusionCuller::cull_cpu(const std::vector<PointCloudVoxel>& voxels, DrawElementsIndirectCommand* commands) const {
+	if (!cpu_valid()) return 0;
+	std::atomic<size_t> points{ 0 };
+	at::parallel_for(0, int64_t(voxels.size()), 1024, [&](int64_t begin, int64_t end) {
+		size_t culled = 0;
+		for (int64_t i = begin; i < end; ++i) {
+			if (commands[i].count == 0 || !occluded(voxels[i].aabb_min, voxels[i].aabb_max)) continue;
+			culled += commands[i].count;
+			commands[i].count = 0;
+		}
+		points += culled;
+	});
+	return points;
+}
+
+void OcclusionCuller::clear() {
+	if (hiz) glDeleteTextures(1, &hiz);
+	hiz = 0;
+	hiz_size = glm::ivec2(0);
+	if (prepass) {
+		Texture2D::erase(prepass->depth_texture->name);
+		Framebuffer::erase(prepass->name);
+		prepass = Framebuffer();
+	}
+	if (occluders) {
+		DIBO::erase(occluders->name);
+		occluders = DIBO();
+	}
+	if (readback_fence) glDeleteSync(readback_fence);
+	readback_fence = 0;
+	if (readback) {
+		PPBO::erase(readback->name);
+		readback = PPBO();
+	}
+	cpu_levels.clear();
+	cpu_occluders.clear();
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cppgl.h>
+#include <vector>
+
+#include "PointCloudData.h"
+#include "frustum_culler.h"
+
+/*  Occlusion Culler: hierarchical z culling of the point voxels against a depth pre-pass of the nearest voxels
+	The occluders, the voxels in the frustum closest to the camera, are drawn first into a depth target, with the shader and the
+	uniforms of the point pass. These are the depths the point pass produces for them, so every covered pixel of the pre-pass
+	has a point at least as close in the final image. A max depth pyramid (empty pixels are 1) is built over the pre-pass, every
+	texel holds the farthest depth of its pixels, the last texel of a row/column of odd length also covers the odd pixel.
+	A voxel is occluded if its nearest box corner is behind the pyramid maximum (plus depth_bias) over every pixel its points can
+	cover: the projected box rectangle widened by half the point size and one pixel, read at the level where it spans at most
+	2x2 texels. Its points would fail the depth test everywhere, so the image does not change (no popping). Boxes reaching behind
+	the camera are never occluded, pixels outside of the screen are not tested (nothing is drawn there).
+	The pyramid and the test run in hizBuild.glcs and computeFrustumCulling.glcs (occludedHiZ in cullingHelper.glsl),
+	build_cpu() and occluded() are the cpu reference on the read back pre-pass, used by the cpu culling.
+	The cpu readback goes through a pixel buffer and is used one frame late, so the pipeline does not stall. The depths of an
+	older pre-pass only hold for the same camera, resolution, point size and occluders: the cpu pyramid is only tested while
+	all of them are unchanged (a still camera), otherwise cull_cpu() culls nothing that frame.
+	Common usage:
+		per frame, with the point shader bound and its uniforms set:
+			select(culler, voxels, camera)
+			begin_prepass(resolution, view_proj, point_size)
+			pc->draw(occluder_commands(), occluder_count())
+			end_prepass()
+			build(hizBuildShader)		and/or build_cpu() (pyramid of the previous pre-pass)
+			pc->cull(..., this) or pc->cull_cpu(..., this)
+*/
+class OcclusionCuller {
+//data
+public:
+	int occluder_voxels = 256;		// voxels drawn in the pre-pass
+	float depth_bias = 1e-5f;		// window depth a voxel has to be behind the pyramid, more than the depth buffer precision
+
+	// of the current pre-pass
+	glm::mat4 view_proj = glm::mat4(1);
+	glm::ivec2 size = glm::ivec2(0);
+	int point_size = 1;
+	int levels = 0;
+	size_t occluder_points = 0;
+
+	// cpu pyramid of build_cpu(), level l has max(1, cpu_size >> l) texels, of the pre-pass with the following state
+	std::vector<std::vector<float>> cpu_levels;
+	glm::mat4 cpu_view_proj = glm::mat4(1);
+	glm::ivec2 cpu_size = glm::ivec2(0);
+	int cpu_point_size = 1;
+
+//methods
+public:
+	// the occluder_voxels voxels in the frustum with the nearest bounding spheres (frustum tested with culler)
+	void select(FrustumCuller& culler, const std::vector<PointCloudVoxel>& voxels, const glm::vec3& cam_pos, const glm::vec3& cam_dir,
+		const glm::vec3& cam_up, float cam_near, float cam_far, float cam_fov, float cam_aspect);
+	const DIBO& occluder_commands() const { return occluders; }
+	GLsizei occluder_count() const { return GLsizei(occluder_list.size()); }
+
+	// binds and clears the pre-pass depth at resolution, the occluders are drawn in between
+	void begin_prepass(const glm::ivec2& resolution, const glm::mat4& view_proj, int point_size);
+	void end_prepass();
+
+	// max depth pyramid of the pre-pass on the gpu (hizBuild.glcs)
+	void build(const Shader& build_shader);
+	// the same pyramid on the cpu from the pre-pass of the previous call, starts the readback of the current one
+	void build_cpu();
+	// the cpu pyramid belongs to a pre-pass with the current camera, resolution, point size and occluders
+	bool cpu_valid() const;
+
+	// uniforms of the occlusion test in computeFrustumCulling.glcs, the pyramid is bound to texture unit 0
+	void bind(const Shader& cull_shader) const;
+	// cpu reference of occludedHiZ on the cpu pyramid
+	bool occluded(const glm::vec3& aabb_min, const glm::vec3& aabb_max) const;
+	// sets the count of the occluded voxels with commands to 0 (after the frustum culling), returns the occluded points
+	// nothing is culled if the cpu pyramid is not valid for the current pre-pass
+	size_t cull_cpu(const std::vector<PointCloudVoxel>& voxels, DrawElementsIndirectCommand* commands) const;
+
+	// frees the targets and buffers (needs the gl context)
+	void clear();
+
+private:
+	std::vector<DrawElementsIndirectCommand> frustum;			// per voxel, counts of the frustum culling
+	std::vector<std::pair<float, uint32_t>> candidates;
+	std::vector<DrawElementsIndirectCommand> occluder_list;
+	DIBO occluders;
+	Framebuffer prepass;
+	GLuint hiz = 0;
+	glm::ivec2 hiz_size = glm::ivec2(0);
+
+	// readback of the previous pre-pass and its state
+	PPBO readback;
+	GLsync readback_fence = 0;
+	glm::mat4 readback_view_proj = glm::mat4(1);
+	glm::ivec2 readback_size = glm::ivec2(0);
+	int readback_point_size = 1;
+	std::vector<DrawElementsIndirectCommand> readback_occluders;
+	std::vector<DrawElementsIndirectCommand> cpu_occluders;		// occluders of the cpu pyramid
+};
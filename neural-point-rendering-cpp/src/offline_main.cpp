@@ -0,0 +1,20 @@
+#include "inferenceRenderer.h"
+#include "offline_render.h"
+
+#include <torch/torch.h>
+
+#include <iostream>
+
+// headless renderer: renders a camera path without window and gui, see offline_render.h
+int main(int argc, char** argv) {
+	OfflineRenderJob job;
+	if (!job.parse(argc, argv)) return 1;
+
+	torch::NoGradGuard ngg;
+	std::cerr << "[offline_main] Create Inference Renderer" << std::endl;
+	InferenceRenderer ir;
+	std::cerr << "[offline_main] Render " << job.frames.size() << " frames of " << job.camera_path << std::endl;
+	ir.run_offline(job);
+	std::cerr << "[offline_main] Finished" << std::endl;
+	return 0;
+}
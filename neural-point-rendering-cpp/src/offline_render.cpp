@@ -0,0 +1,119 @@
+#include "offline_render.h"
+#include <cppgl.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+bool OfflineRenderJob::parse(int argc, char** argv) {
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		const bool has_value = i + 1 < argc;
+		if (arg == "--dataset" && has_value) dataset = argv[++i];
+		else if (arg == "--network" && has_value) network = argv[++i];
+		else if (arg == "--lod" && has_value) lod = std::stoi(argv[++i]);
+		else if (arg == "--path" && has_value) camera_path = argv[++i];
+		else if (arg == "--out" && has_value) output_dir = argv[++i];
+		else if (arg == "--subdivide" && has_value) subdivide = std::max(1, std::stoi(argv[++i]));
+		else if (arg == "--no-images") save_images = false;
+		else if (arg == "--taa") use_taa = true;
+		else if (arg == "--cpu-raster") cpu_rasterizer = true;
+		else {
+			std::cerr << "[OfflineRenderJob] FATAL ERROR: unknown or incomplete argument " << arg << "." << std::endl;
+			print_usage(argv[0]);
+			return false;
+		}
+	}
+	if (dataset.empty() || camera_path.empty()) {
+		std::cerr << "[OfflineRenderJob] FATAL ERROR: --dataset and --path are required." << std::endl;
+		print_usage(argv[0]);
+		return false;
+	}
+	return load_camera_path();
+}
+
+bool OfflineRenderJob::load_camera_path() {
+	std::ifstream path_stream(camera_path);
+	if (!path_stream.is_open()) {
+		std::cerr << "[OfflineRenderJob] FATAL ERROR: failed to open camera path: " << camera_path << "." << std::endl;
+		return false;
+	}
+	poses.clear();
+	std::string line;
+	while (std::getline(path_stream, line)) {
+		if (line.empty() || line[0] == '#') continue;
+		std::istringstream line_stream(line);
+		glm::vec3 pos;
+		glm::quat rot;
+		if (!(line_stream >> pos.x >> pos.y >> pos.z >> rot.w >> rot.x >> rot.y >> rot.z)) {
+			std::cerr << "[OfflineRenderJob] WARNING: skipping malformed pose: " << line << std::endl;
+			continue;
+		}
+		poses.emplace_back(pos, glm::normalize(rot));
+	}
+	if (poses.empty()) {
+		std::cerr << "[OfflineRenderJob] FATAL ERROR: no poses in camera path: " << camera_path << "." << std::endl;
+		return false;
+	}
+
+	frames.clear();
+	if (subdivide <= 1 || poses.size() < 2) {
+		frames = poses;
+		return true;
+	}
+	// sample the spline of the animations, time is in nodes
+	Animation path("offline_camera_path");
+	for (const auto& pose : poses)
+		path->push_node(pose.first, pose.second);
+	const int frame_count = int(poses.size() - 1) * subdivide + 1;
+	for (int f = 0; f < frame_count; ++f) {
+		path->time = float(f) / float(subdivide);
+		frames.emplace_back(path->eval_pos(), path->eval_rot());
+	}
+	return true;
+}
+
+void OfflineRenderJob::print_usage(const char* executable) {
+	std::cerr << "usage: " << executable << " --dataset <name> --path <camera path file> [--network <name>] [--lod <index>] [--out <dir>] [--subdivide <frames per segment>] [--no-images] [--taa] [--cpu-raster]" << std::endl;
+}
+
+void OfflineReport::frame(int index, double frame_ms, double forward_ms, double write_ms) {
+	if (int(rows.size()) <= index) rows.resize(index + 1);
+	Row& row = rows[index];
+	row.frame = index;
+	row.frame_ms = frame_ms;
+	row.forward_ms = forward_ms;
+	row.write_ms = write_ms;
+}
+
+void OfflineReport::gpu_stages(int index, float point_rendering_ms, float mipmap_ms, float inference_ms) {
+	if (index < 0 || index >= int(rows.size())) return;
+	rows[index].point_rendering_ms = point_rendering_ms;
+	rows[index].mipmap_ms = mipmap_ms;
+	rows[index].inference_ms = inference_ms;
+}
+
+bool OfflineReport::write(const std::string& path) const {
+	std::ofstream report(path);
+	if (!report.is_open()) {
+		std::cerr << "[OfflineReport] FATAL ERROR: failed to open filestream: " << path << "." << std::endl;
+		return false;
+	}
+	report << "Frame;Total;PointRendering;MipMapping;Inference;Forward;Write" << std::endl;
+	Row sum;
+	for (const Row& row : rows) {
+		report << row.frame << ";" << row.frame_ms << ";" << row.point_rendering_ms << ";" << row.mipmap_ms << ";" << row.inference_ms << ";" << row.forward_ms << ";" << row.write_ms << std::endl;
+		sum.frame_ms += row.frame_ms;
+		sum.forward_ms += row.forward_ms;
+		sum.write_ms += row.write_ms;
+		sum.point_rendering_ms += row.point_rendering_ms;
+		sum.mipmap_ms += row.mipmap_ms;
+		sum.inference_ms += row.inference_ms;
+	}
+	if (rows.empty()) return true;
+	const double n = double(rows.size());
+	std::cout << "[OfflineReport] " << rows.size() << " frames, avg ms: total " << sum.frame_ms / n << ", point rendering " << sum.point_rendering_ms / n
+		<< ", mip mapping " << sum.mipmap_ms / n << ", inference " << sum.inference_ms / n << ", forward " << sum.forward_ms / n << ", write " << sum.write_ms / n
+		<< " -> " << (sum.frame_ms > 0.0 ? 1000.0 * n / sum.frame_ms : 0.0) << " frames/s" << std::endl;
+	return true;
+}
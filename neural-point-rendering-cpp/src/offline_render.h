@@ -0,0 +1,74 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <utility>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+/*  Offline Render Job: command line of the headless renderer (InovisOffline)
+	Renders every frame of a camera path without window, gui and vsync as fast as possible, writes the network output
+	of each frame to <output_dir>/neural/ and the timings of each frame to <output_dir>/timings.csv.
+	Camera path file: one pose per line "px py pz qw qx qy qz", the rotation is the quaternion of the view matrix
+	(as in the animations and printed by "Print Cam"). Lines starting with # are ignored.
+	Common usage:
+		OfflineRenderJob job;
+		if (!job.parse(argc, argv)) return 1;
+		InferenceRenderer ir;
+		ir.run_offline(job);
+*/
+struct OfflineRenderJob {
+//data
+	std::string dataset;				// name of the dataset config (name: ...)
+	std::string network;				// name of the network config, the first network if empty
+	int lod = 0;
+	std::string camera_path;
+	std::string output_dir = "./out/offline";
+	int subdivide = 1;					// frames per segment of the path, > 1 interpolates between the poses with the camera spline
+	bool save_images = true;
+	bool use_taa = false;
+	bool cpu_rasterizer = false;		// points rendered by the software rasterizer
+
+	std::vector<std::pair<glm::vec3, glm::quat>> poses;		// of the camera path file
+	std::vector<std::pair<glm::vec3, glm::quat>> frames;	// poses to render, filled by load_camera_path()
+
+//methods
+	// parse the arguments and load the camera path, prints the usage on errors
+	bool parse(int argc, char** argv);
+	bool load_camera_path();
+	static void print_usage(const char* executable);
+};
+
+/*  Offline Report: per frame timings of the headless renderer
+	The gl timer queries of a frame are read one frame later, so the gpu stages of a frame are set after the next frame
+	(or after flushing the timers once the last frame is done).
+	Common usage:
+		per frame i:
+			frame(i, frame_ms, forward_ms, write_ms)
+			if (i > 0) gpu_stages(i - 1, timer_pc->last(), timer_mipmap->last(), timer_inference->last())
+		write(path)
+*/
+class OfflineReport {
+//structs
+public:
+	struct Row {
+		int frame = 0;
+		double frame_ms = 0.0;			// wall clock of the whole frame including the write
+		double forward_ms = 0.0;		// forward pass of the network
+		double write_ms = 0.0;			// queueing the output in the capture writer, including backpressure
+		float point_rendering_ms = 0.f;
+		float mipmap_ms = 0.f;
+		float inference_ms = 0.f;
+	};
+
+//data
+public:
+	std::vector<Row> rows;
+
+//methods
+public:
+	void frame(int index, double frame_ms, double forward_ms, double write_ms);
+	void gpu_stages(int index, float point_rendering_ms, float mipmap_ms, float inference_ms);
+	// csv with one row per frame, prints the averages
+	bool write(const std::string& path) const;
+};
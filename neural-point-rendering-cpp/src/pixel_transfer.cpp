@@ -0,0 +1,160 @@
+#include "pixel_transfer.h"
+#include "texture_copy.h"
+
+// ------------------------------------------
+// helper funcs
+
+int get_transfer_channels(const Texture2D& tex) {
+	return (tex->format == GL_RGBA || tex->format == GL_RGB) ? 4 : (tex->format == GL_RG ? 2 : 1);
+}
+
+GLenum get_transfer_format(const Texture2D& tex) {
+	return tex->format == GL_RGB ? GL_RGBA : tex->format;
+}
+
+// wait until the last transfer of the slot has finished
+template <typename Buffer>
+static void wait_slot(PixelTransferImpl::Slot<Buffer>& slot) {
+	if (!slot.fence) return;
+	GLenum res = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	while (res == GL_TIMEOUT_EXPIRED)
+		res = glClientWaitSync(slot.fence, 0, 1000000); // 1ms
+	if (res == GL_WAIT_FAILED)
+		std::cerr << "[PixelTransfer] WARNING: waiting for a pixel buffer transfer failed." << std::endl;
+	glDeleteSync(slot.fence);
+	slot.fence = 0;
+}
+
+template <typename Buffer>
+static void free_slot(PixelTransferImpl::Slot<Buffer>& slot) {
+	if (slot.fence) glDeleteSync(slot.fence);
+	slot.fence = 0;
+	if (slot.buffer) {
+		if (slot.mapped) {
+			slot.buffer->bind();
+			slot.buffer->unmap();
+		}
+		Buffer::erase(slot.buffer->name);
+		slot.buffer = Buffer();
+	}
+	slot.mapped = nullptr;
+}
+
+// (re-)create the buffer of the slot with immutable storage if it is too small and map it persistently
+template <typename Buffer>
+static void ensure_slot(PixelTransferImpl::Slot<Buffer>& slot, const std::string& name, GLenum target, GLbitfield access, size_t size_bytes) {
+	if (slot.buffer && slot.buffer->size_bytes >= size_bytes) return;
+	free_slot(slot);
+	const GLbitfield flags = access | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	slot.buffer = Buffer(name);
+	slot.buffer->bind();
+	glBufferStorage(target, size_bytes, nullptr, flags | (access == GL_MAP_READ_BIT ? GL_CLIENT_STORAGE_BIT : 0));
+	slot.buffer->size_bytes = size_bytes;
+	slot.mapped = glMapBufferRange(target, 0, size_bytes, flags);
+	slot.buffer->unbind();
+	if (!slot.mapped)
+		std::cerr << "[PixelTransfer] FATAL ERROR: failed to persistently map pixel buffer " << name << "." << std::endl;
+}
+
+// ------------------------------------------
+// PixelTransferImpl
+
+PixelTransferImpl::PixelTransferImpl(const std::string& name, uint32_t ring_size) : name(name), ring_size(std::max(1u, ring_size)) {}
+
+PixelTransferImpl::~PixelTransferImpl() {
+	clear();
+}
+
+void PixelTransferImpl::request_readback(const Texture2D& tex) {
+	auto& ring = readback_rings[tex->id];
+	if (ring.slots.size() != ring_size) ring.slots.resize(ring_size);
+	auto& slot = ring.slots[ring.next];
+
+	const int c = get_transfer_channels(tex);
+	const std::pair<torch::ScalarType, int> type_info = get_type_from_texture2D(tex);
+	const size_t size_bytes = size_t(tex->w) * size_t(tex->h) * c * type_info.second;
+	// a download of an older frame may still be in flight in this slot -> wait for it before the buffer is reused
+	if (slot.fence && glClientWaitSync(slot.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+		std::cerr << "[PixelTransfer] WARNING: all readback buffers of " << tex->name << " are in flight, waiting for the oldest one." << std::endl;
+	wait_slot(slot);
+	ensure_slot(slot, name + "/pack_" + std::to_string(buffer_counter++), GL_PIXEL_PACK_BUFFER, GL_MAP_READ_BIT, size_bytes);
+	slot.w = tex->w;
+	slot.h = tex->h;
+	slot.c = c;
+	slot.type = type_info.first;
+
+	// download into the pixel pack buffer, returns immediately
+	GLint pack_alignment = 4;
+	glGetIntegerv(GL_PACK_ALIGNMENT, &pack_alignment);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	slot.buffer->bind();
+	glGetTextureImage(tex->id, 0, get_transfer_format(tex), tex->type, GLsizei(slot.buffer->size_bytes), 0);
+	slot.buffer->unbind();
+	glPixelStorei(GL_PACK_ALIGNMENT, pack_alignment);
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	ring.latest = ring.next;
+	ring.next = (ring.next + 1) % ring_size;
+}
+
+torch::Tensor PixelTransferImpl::readback(const Texture2D& tex) {
+	auto it = readback_rings.find(tex->id);
+	if (it == readback_rings.end() || it->second.latest < 0) {
+		request_readback(tex);
+		it = readback_rings.find(tex->id);
+	}
+	auto& ring = it->second;
+	auto& slot = ring.slots[ring.latest];
+	// the request is consumed -> the next readback of this texture issues a new download
+	ring.latest = -1;
+	wait_slot(slot);
+	return torch::from_blob(slot.mapped, { slot.h, slot.w, slot.c }, torch::TensorOptions().dtype(slot.type));
+}
+
+void PixelTransferImpl::upload(const torch::Tensor& tensor, const Texture2D& tex) {
+	const int c = get_transfer_channels(tex);
+	// smaller tensors are written into the lower left part of the texture, e.g. a render resolution below the texture size
+	if (tensor.dim() != 3 || tensor.size(0) > tex->h || tensor.size(1) > tex->w || tensor.size(2) != c) {
+		std::cerr << "[PixelTransfer] Tensor of size " << tensor.sizes() << " does not fit into texture [" << tex->h << ", " << tex->w << ", " << c << "]" << std::endl;
+		std::cerr << "Aborting upload into: " << tex->name << std::endl;
+		return;
+	}
+	auto& ring = upload_rings[tex->id];
+	if (ring.slots.size() != ring_size) ring.slots.resize(ring_size);
+	auto& slot = ring.slots[ring.next];
+	// the slot may only be overwritten after its previous upload has finished
+	wait_slot(slot);
+
+	const std::pair<torch::ScalarType, int> type_info = get_type_from_texture2D(tex);
+	const int w = int(tensor.size(1)), h = int(tensor.size(0));
+	const size_t size_bytes = size_t(w) * size_t(h) * c * type_info.second;
+	ensure_slot(slot, name + "/unpack_" + std::to_string(buffer_counter++), GL_PIXEL_UNPACK_BUFFER, GL_MAP_WRITE_BIT, size_bytes);
+	slot.w = w;
+	slot.h = h;
+	slot.c = c;
+	slot.type = type_info.first;
+
+	// write directly into the mapped memory, copy_ handles strides, device and type conversion
+	torch::from_blob(slot.mapped, { slot.h, slot.w, slot.c }, torch::TensorOptions().dtype(slot.type)).copy_(tensor);
+
+	GLint unpack_alignment = 4;
+	glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpack_alignment);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	slot.buffer->bind();
+	glTextureSubImage2D(tex->id, 0, 0, 0, w, h, get_transfer_format(tex), tex->type, 0);
+	slot.buffer->unbind();
+	glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment);
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	ring.latest = ring.next;
+	ring.next = (ring.next + 1) % ring_size;
+}
+
+void PixelTransferImpl::clear() {
+	for (auto& [id, ring] : readback_rings)
+		for (auto& slot : ring.slots) free_slot(slot);
+	for (auto& [id, ring] : upload_rings)
+		for (auto& slot : ring.slots) free_slot(slot);
+	readback_rings.clear();
+	upload_rings.clear();
+}
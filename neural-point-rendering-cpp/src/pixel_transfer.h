@@ -0,0 +1,80 @@
+#pragma once
+#include <cppgl.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <torch/torch.h>
+
+/*  Pixel Transfer Manager: asynchronous texture <-> host memory transfers without cuda-gl interop
+	Every texture gets a small ring of persistently mapped pixel buffers (PPBO for readback, PUBO for upload).
+	Common usage:
+		per frame:
+			request_readback(tex) for all textures that are needed on the host
+			... do other work, the transfers run asynchronously ...
+			readback(tex): waits on the fence of the latest request and wraps the mapped memory in a tensor (no copy)
+
+			upload(tensor, tex): writes the tensor into the next unpack buffer and streams it into the texture
+
+	The tensor returned by readback() aliases the mapped buffer. It stays valid until the same slot is
+	reused, i.e. for ring_size - 1 further requests of that texture. Clone it if it has to live longer.
+*/
+class PixelTransferImpl {
+//structs
+public:
+	template <typename Buffer> struct Slot {
+		Buffer buffer;
+		void* mapped = nullptr;	// persistently mapped pointer into the buffer
+		GLsync fence = 0;		// signaled when the last transfer of this slot has finished
+		int w = 0, h = 0, c = 0;
+		torch::ScalarType type = torch::kFloat32;
+	};
+
+	template <typename Buffer> struct Ring {
+		std::vector<Slot<Buffer>> slots;
+		int next = 0;			// slot used by the next transfer
+		int latest = -1;		// slot of the latest issued transfer
+	};
+
+//data
+public:
+	const std::string name;
+	const uint32_t ring_size;
+
+	// rings are keyed by the gl id of the texture
+	std::map<GLuint, Ring<PPBO>> readback_rings;
+	std::map<GLuint, Ring<PUBO>> upload_rings;
+
+//methods
+public:
+	PixelTransferImpl(const std::string& name, uint32_t ring_size = 2);
+	virtual ~PixelTransferImpl();
+
+	// issue an asynchronous download of the texture into the next pixel pack buffer of its ring
+	void request_readback(const Texture2D& tex);
+	// returns a HxWxC tensor on the cpu that wraps the latest downloaded data of tex (y is not flipped)
+	// if no download was requested for tex yet, one is issued and waited for
+	torch::Tensor readback(const Texture2D& tex);
+
+	// upload a HxWxC tensor into tex through the next pixel unpack buffer of its ring (y is not flipped)
+	// H and W may be smaller than the texture, then only the lower left HxW part is written
+	void upload(const torch::Tensor& tensor, const Texture2D& tex);
+
+	// free all buffers, e.g. after the textures were resized
+	void clear();
+
+	// prevent copies and moves, since GL buffers aren't reference counted
+	PixelTransferImpl(const PixelTransferImpl&) = delete;
+	PixelTransferImpl& operator=(const PixelTransferImpl&) = delete;
+	PixelTransferImpl& operator=(const PixelTransferImpl&&) = delete;
+
+private:
+	uint32_t buffer_counter = 0; // used for unique buffer names
+};
+
+using PixelTransfer = NamedHandle<PixelTransferImpl>;
+template class NamedHandle<PixelTransferImpl>;
+
+// number of channels and type of a texture as it is transfered to the host. rgb is padded to rgba
+int get_transfer_channels(const Texture2D& tex);
+GLenum get_transfer_format(const Texture2D& tex);
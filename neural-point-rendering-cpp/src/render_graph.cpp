@@ -0,0 +1,189 @@
+#include "render_graph.h"
+#include <algorithm>
+#include <iostream>
+#include <set>
+
+// ------------------------------------------
+// helper funcs
+
+static bool same_swizzle(const GLint* a, const GLint* b) {
+	return std::equal(a, a + 4, b);
+}
+
+// ------------------------------------------
+// RenderGraph
+
+size_t RenderGraph::bytes_per_pixel(GLint internal_format) {
+	switch (internal_format) {
+	case GL_RGBA32F: return 16;
+	case GL_RGB32F: return 12;
+	case GL_RGBA16F: case GL_RG32F: case GL_DEPTH32F_STENCIL8: return 8;
+	case GL_RGB16F: return 6;
+	case GL_RG16F: case GL_R32F: case GL_RGBA8: case GL_RGBA: return 4;
+	case GL_RGB8: case GL_RGB: return 3;
+	case GL_R16F: case GL_RG8: return 2;
+	case GL_R8: return 1;
+	default: return 4; // depth formats
+	}
+}
+
+void RenderGraph::reset() {
+	passes.clear();
+	resources.clear();
+}
+
+void RenderGraph::persistent(const std::string& name, size_t bytes) {
+	Resource& resource = resources[name];
+	resource.transient = false;
+	resource.bytes = bytes;
+}
+
+void RenderGraph::transient(const std::string& name, const Target& target) {
+	Resource& resource = resources[name];
+	resource.transient = true;
+	resource.target = target;
+	resource.bytes = size_t(std::max(target.size.x, 0)) * size_t(std::max(target.size.y, 0)) * bytes_per_pixel(target.internal_format);
+}
+
+void RenderGraph::add_pass(const std::string& name, const std::vector<std::string>& reads, const std::vector<std::string>& writes, bool side_effect) {
+	Pass pass;
+	pass.name = name;
+	pass.reads = reads;
+	pass.writes = writes;
+	pass.side_effect = side_effect;
+	passes.push_back(pass);
+}
+
+void RenderGraph::compile() {
+	++frame;
+
+	// culling: walk back from the passes with side effects, a pass is kept if a kept pass after it reads one of its targets
+	passes_culled = 0;
+	std::set<std::string> needed;
+	for (int p = int(passes.size()) - 1; p >= 0; --p) {
+		Pass& pass = passes[p];
+		pass.enabled = pass.side_effect;
+		for (const auto& name : pass.writes)
+			pass.enabled = pass.enabled || needed.count(name);
+		if (!pass.enabled) {
+			++passes_culled;
+			continue;
+		}
+		needed.insert(pass.reads.begin(), pass.reads.end());
+	}
+
+	// lifetimes over the kept passes
+	for (int p = 0; p < int(passes.size()); ++p) {
+		if (!passes[p].enabled) continue;
+		for (const auto* names : { &passes[p].reads, &passes[p].writes })
+			for (const auto& name : *names) {
+				auto it = resources.find(name);
+				if (it == resources.end()) continue;
+				if (it->second.first < 0) it->second.first = p;
+				it->second.last = p;
+			}
+	}
+
+	// pool textures in the order of the first use, a texture is free again after the last pass of its holder
+	for (auto& entry : pool) entry.busy_until = -1;
+	std::vector<Resource*> order;
+	persistent_bytes = 0;
+	transient_bytes = 0;
+	for (auto& [name, resource] : resources) {
+		if (!resource.transient) {
+			persistent_bytes += resource.bytes;
+			continue;
+		}
+		if (resource.first < 0 || resource.bytes == 0) continue;
+		transient_bytes += resource.bytes;
+		order.push_back(&resource);
+	}
+	std::stable_sort(order.begin(), order.end(), [](const Resource* a, const Resource* b) { return a->first < b->first; });
+	for (Resource* resource : order)
+		resource->texture = acquire(resource->target, resource->first, resource->last);
+
+	for (auto& attachment : attachments)
+		update_attachment(attachment);
+
+	// free textures that were not used for a while, no attachment holds them anymore
+	pool_bytes = 0;
+	for (auto it = pool.begin(); it != pool.end();) {
+		if (it->last_frame + uint64_t(keep_frames) < frame) {
+			Texture2D::erase(it->texture->name);
+			it = pool.erase(it);
+			continue;
+		}
+		pool_bytes += size_t(it->texture->w) * size_t(it->texture->h) * bytes_per_pixel(it->texture->internal_format);
+		++it;
+	}
+	peak_bytes = std::max(peak_bytes, persistent_bytes + pool_bytes);
+}
+
+Texture2D RenderGraph::acquire(const Target& target, int first, int last) {
+	for (auto& entry : pool) {
+		const Texture2D& tex = entry.texture;
+		if (entry.busy_until >= first || tex->internal_format != target.internal_format || tex->w != target.size.x || tex->h != target.size.y
+			|| !same_swizzle(entry.target.swizzle, target.swizzle))
+			continue;
+		entry.busy_until = last;
+		entry.last_frame = frame;
+		return tex;
+	}
+	PoolEntry entry;
+	entry.texture = Texture2D("render_graph/target_" + std::to_string(texture_counter++), target.size.x, target.size.y, target.internal_format, target.format, target.type);
+	entry.target = target;
+	glTextureParameteriv(entry.texture->id, GL_TEXTURE_SWIZZLE_RGBA, target.swizzle);
+	entry.busy_until = last;
+	entry.last_frame = frame;
+	pool.push_back(entry);
+	return entry.texture;
+}
+
+void RenderGraph::update_attachment(Attachment& attachment) {
+	auto it = resources.find(attachment.resource);
+	const Texture2D tex = it != resources.end() && it->second.first >= 0 ? it->second.texture : Texture2D();
+	Texture2D& current = attachment.slot < 0 ? attachment.fbo->depth_texture : attachment.fbo->color_textures[attachment.slot];
+	if (current.ptr == tex.ptr) return;
+	const GLenum point = attachment.slot < 0 ? GL_DEPTH_ATTACHMENT : GL_COLOR_ATTACHMENT0 + GLenum(attachment.slot);
+	glNamedFramebufferTexture(attachment.fbo->id, point, tex ? tex->id : 0, 0);
+	current = tex;
+}
+
+bool RenderGraph::enabled(const std::string& pass) const {
+	for (const auto& p : passes)
+		if (p.name == pass) return p.enabled;
+	return false;
+}
+
+bool RenderGraph::used(const std::string& resource) const {
+	auto it = resources.find(resource);
+	return it != resources.end() && it->second.first >= 0;
+}
+
+Texture2D RenderGraph::texture(const std::string& resource) const {
+	auto it = resources.find(resource);
+	if (it == resources.end() || !it->second.texture) {
+		std::cerr << "[RenderGraph] WARNING: " << resource << " is not used this frame." << std::endl;
+		return Texture2D();
+	}
+	return it->second.texture;
+}
+
+void RenderGraph::attach(Framebuffer fbo, int slot, const std::string& resource) {
+	// the slots are enabled as draw buffers by bind(), like attach_colorbuffer
+	while (slot >= 0 && int(fbo->color_textures.size()) <= slot) {
+		fbo->color_targets.push_back(GL_COLOR_ATTACHMENT0 + GLenum(fbo->color_textures.size()));
+		fbo->color_textures.push_back(Texture2D());
+	}
+	attachments.push_back(Attachment{ fbo, slot, resource });
+}
+
+void RenderGraph::clear() {
+	resources.clear();
+	for (auto& attachment : attachments)
+		update_attachment(attachment);
+	for (auto& entry : pool)
+		Texture2D::erase(entry.texture->name);
+	pool.clear();
+	pool_bytes = 0;
+}
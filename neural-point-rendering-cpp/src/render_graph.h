@@ -0,0 +1,115 @@
+#pragma once
+#include <cppgl.h>
+#include <map>
+#include <string>
+#include <vector>
+
+/*  Render Graph: the passes of a frame with the render targets they read and write
+	Every frame the passes are declared in execution order. compile() keeps the passes whose outputs are read by a
+	later kept pass (passes with side effects, like presenting or capturing, are always kept) and culls the others.
+	Persistent targets (history, fixed framebuffers) live over frames and are only counted for the memory report.
+	Transient targets are taken from a pool for the passes between their first and last use. Transient targets whose
+	lifetimes do not overlap share a texture if format and exact size match, the pool keeps its textures over frames and
+	frees those unused for keep_frames frames. Textures are matched by their current size: a resize of an attached
+	framebuffer reallocates the storage of its textures in place (glTexImage2D), a target of any other size gets a new texture.
+	Scope: in the renderer only the motion targets are transient. Those of one level are written and read by the same
+	passes and the levels differ in size, so they rarely share. The pool mainly saves the targets of culled passes
+	(e.g. the motion of the mip levels the network does not read) and the reallocation when passes are toggled.
+	Transient targets can be bound to a framebuffer slot, compile() attaches the assigned texture or detaches the slot
+	if the target is not used this frame (color_textures[slot] is empty then).
+	Common usage:
+		on init:
+			attach(fbo, slot, "target")
+		per frame:
+			reset()
+			persistent("history", bytes)
+			transient("target", Target{ GL_RGBA32F, GL_RGBA, GL_FLOAT, size })
+			add_pass("render", {}, { "target" })
+			add_pass("present", { "target", "history" }, {}, true)
+			compile()
+			if (enabled("render")) ...		texture("target") or the attached framebuffer
+*/
+class RenderGraph {
+//structs
+public:
+	// format and size of a transient target
+	struct Target {
+		GLint internal_format = GL_RGBA32F;
+		GLenum format = GL_RGBA;
+		GLenum type = GL_FLOAT;
+		glm::ivec2 size = glm::ivec2(0);
+		GLint swizzle[4] = { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA };
+	};
+
+	struct Pass {
+		std::string name;
+		std::vector<std::string> reads;
+		std::vector<std::string> writes;
+		bool side_effect = false;
+		bool enabled = false;
+	};
+
+	struct Resource {
+		bool transient = false;
+		Target target;
+		size_t bytes = 0;
+		int first = -1, last = -1;		// first and last kept pass using the target, -1: unused
+		Texture2D texture;				// transient: assigned pool texture
+	};
+
+	struct Attachment {
+		Framebuffer fbo;
+		int slot = 0;					// color attachment, -1: depth attachment
+		std::string resource;
+	};
+
+//data
+public:
+	int keep_frames = 8;				// idle pool textures are freed after this many frames
+
+	// statistics of the last compile()
+	int passes_culled = 0;
+	size_t persistent_bytes = 0;		// persistent targets
+	size_t transient_bytes = 0;			// used transient targets, without aliasing
+	size_t pool_bytes = 0;				// allocated pool textures
+	size_t peak_bytes = 0;				// maximum of persistent_bytes + pool_bytes since the start
+
+//methods
+public:
+	// begin the declaration of a frame
+	void reset();
+	void persistent(const std::string& name, size_t bytes);
+	void transient(const std::string& name, const Target& target);
+	// reads and writes name declared targets, reads of undeclared names are ignored (e.g. dataset images)
+	void add_pass(const std::string& name, const std::vector<std::string>& reads, const std::vector<std::string>& writes, bool side_effect = false);
+	// culls the passes, assigns the pool textures and updates the attachments
+	void compile();
+
+	bool enabled(const std::string& pass) const;
+	bool used(const std::string& resource) const;
+	Texture2D texture(const std::string& resource) const;
+
+	void attach(Framebuffer fbo, int slot, const std::string& resource);
+	// frees the pool, detaches all bound slots (needs the gl context)
+	void clear();
+
+	static size_t bytes_per_pixel(GLint internal_format);
+
+private:
+	struct PoolEntry {
+		Texture2D texture;
+		Target target;				// format and swizzle, the size is taken from the texture
+		int busy_until = -1;		// last pass of the target holding it in this frame
+		uint64_t last_frame = 0;
+	};
+
+	Texture2D acquire(const Target& target, int first, int last);
+	void update_attachment(Attachment& attachment);
+
+	std::vector<Pass> passes;
+	std::map<std::string, Resource> resources;
+	std::vector<Attachment> attachments;
+	std::vector<PoolEntry> pool;
+	uint64_t frame = 0;
+	int texture_counter = 0;
+};
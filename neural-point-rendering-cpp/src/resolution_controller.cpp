@@ -0,0 +1,61 @@
+#include "resolution_controller.h"
+#include <algorithm>
+#include <cmath>
+
+bool ResolutionController::update(float frame_ms, float scalable) {
+	if (settle > 0) {
+		--settle;
+		return false;
+	}
+	sum_frame_ms += frame_ms;
+	sum_scalable_ms += std::min(scalable, frame_ms);
+	if (++count < window) return false;
+
+	const float frame = float(sum_frame_ms / count);
+	scalable_ms = float(sum_scalable_ms / count);
+	fixed_ms = std::max(0.f, frame - scalable_ms);
+	count = 0;
+	sum_frame_ms = sum_scalable_ms = 0.0;
+
+	float next = scale;
+	if (frame > target_ms) {
+		// drop until the prediction meets the target, at most max_steps_down levels
+		next = quantize(scale - step);
+		for (int i = 1; i < max_steps_down && next > min_scale && predicted_ms(next) > target_ms; ++i)
+			next = quantize(next - step);
+	}
+	else if (frame < target_ms * (1.f - headroom)) {
+		// rise one level if it is predicted to keep half of the headroom
+		const float up = quantize(scale + step);
+		if (predicted_ms(up) < target_ms * (1.f - 0.5f * headroom)) next = up;
+	}
+	if (std::abs(next - scale) < 1e-4f) return false;
+	scale = next;
+	settle = settle_frames;
+	return true;
+}
+
+void ResolutionController::hold() {
+	settle = settle_frames;
+	count = 0;
+	sum_frame_ms = sum_scalable_ms = 0.0;
+}
+
+void ResolutionController::reset(float scale) {
+	this->scale = scale;
+	hold();
+}
+
+glm::ivec2 ResolutionController::resolution(glm::ivec2 res_max, float scale, int alignment) {
+	if (scale >= 1.f) return res_max;
+	glm::ivec2 res = glm::ivec2(glm::vec2(res_max) * scale) / alignment * alignment;
+	return glm::clamp(res, glm::min(glm::ivec2(alignment), res_max), res_max);
+}
+
+float ResolutionController::quantize(float s) const {
+	return glm::clamp(std::round(s / step) * step, min_scale, max_scale);
+}
+
+float ResolutionController::predicted_ms(float s) const {
+	return fixed_ms + scalable_ms * (s * s) / (scale * scale);
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <glm/glm.hpp>
+
+/*  Resolution Controller: dynamic render scale that holds a target frame time
+	The frame time is modeled as a fixed part plus a part that scales with the pixel count (point rendering, mip maps, inference).
+	Both are averaged over window frames, then the scale that is predicted to hit the target is chosen from discrete levels.
+	The scale drops by several levels at once if the target is missed, but only rises one level at a time with some headroom,
+	so it does not oscillate. After a change settle_frames are not measured (warm-up of the new shape, pipelined frames).
+	Common usage:
+		per rendered frame:
+			if (update(frame_ms, scalable_ms))
+				res0 = resolution(res_max, scale, alignment)		sub-rectangle of the render targets allocated at res_max
+		per idle frame:
+			hold()
+*/
+class ResolutionController {
+//data
+public:
+	float target_ms = 33.3f;
+	float min_scale = 0.5f;
+	float max_scale = 1.f;
+	float step = 1.f / 16.f;		// scales are multiples of step, every level is a separate input shape for the networks
+	float headroom = 0.1f;			// fraction of the target that has to be left before the scale rises
+	int max_steps_down = 3;			// levels the scale may drop at once
+	int window = 16;				// frames averaged per decision
+	int settle_frames = 8;			// frames skipped after a change
+
+	float scale = 1.f;
+	float fixed_ms = 0.f;			// averages of the last decision
+	float scalable_ms = 0.f;
+
+//methods
+public:
+	// feed the timings of a rendered frame, returns true if the scale changed
+	bool update(float frame_ms, float scalable_ms);
+	// skip the next settle_frames, e.g. after idle frames whose timings do not count
+	void hold();
+	void reset(float scale = 1.f);
+
+	// res0 for scale, aligned down to a multiple of alignment (res_max itself at full scale)
+	static glm::ivec2 resolution(glm::ivec2 res_max, float scale, int alignment);
+
+private:
+	float quantize(float s) const;
+	float predicted_ms(float s) const;
+
+	int settle = 0;
+	int count = 0;
+	double sum_frame_ms = 0.0;
+	double sum_scalable_ms = 0.0;
+};
@@ -0,0 +1,21 @@
+#include "__groundtruth_views_include.glsl"
+// camera of the frame, uploaded once per frame by the InferenceRenderer
+layout(std140, binding = 0) uniform FrameCamera {
+    mat4 proj;
+    mat4 view;
+    mat4 view_normal;
+    mat4 proj_old;
+    // previous frame, with taa the first motion vectors point into it
+    mat4 view_prev;
+    // ground truth view of the motion vectors 0 (1 with taa), the following motion vectors use the following views
+    int groundtruth_first;
+    int use_prev_view;
+};
+
+// view of the motion vectors i
+mat4 view_old_n(int i) {
+    if (use_prev_view != 0 && i == 0)
+        return view_prev;
+    int v = groundtruth_first + i;
+    return v >= 0 && v < groundtruth_count ? groundtruth_views[v].view : mat4(1);
+}
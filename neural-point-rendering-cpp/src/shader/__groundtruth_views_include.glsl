@@ -0,0 +1,10 @@
+// nearest ground truth views of the frame (GroundtruthViews), any number of them in one buffer
+struct GroundtruthView {
+    mat4 view;
+    uvec2 handle;   // bindless handle of the texture, 0 without GL_ARB_bindless_texture
+    ivec2 size;
+};
+layout(std430, binding = 6) readonly buffer GroundtruthViews {
+    int groundtruth_count;
+    GroundtruthView groundtruth_views[];
+};
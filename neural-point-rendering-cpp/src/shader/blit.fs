@@ -1,8 +1,14 @@
 #version 460
 in vec2 tc;
 uniform sampler2D tex;
+uniform vec2 tc_scale = vec2(1); // used part of tex (dynamic resolution)
 out vec4 out_col;
 
+// stay half a texel inside the used part, so linear filtering does not fetch outside of it
+vec2 scaled_tc(vec2 t, vec2 scale, sampler2D s) {
+    return min(t * scale, scale - 0.5 / vec2(textureSize(s, 0)));
+}
+
 void main() {
-    out_col = vec4(texture(tex, tc).rgb,1);
+    out_col = vec4(texture(tex, scaled_tc(tc, tc_scale, tex)).rgb,1);
 }
@@ -0,0 +1,15 @@
+#version 460
+#extension GL_ARB_bindless_texture : require
+#include "__groundtruth_views_include.glsl"
+in vec2 tc;
+uniform int view_index;         // ground truth view, the same for the whole draw (bindless handles have to be dynamically uniform)
+uniform bool depth = false;     // show the depth in alpha
+out vec4 out_col;
+
+void main() {
+    out_col = vec4(0, 0, 0, 1);
+    if (view_index < 0 || view_index >= groundtruth_count || groundtruth_views[view_index].handle == uvec2(0))
+        return;
+    vec4 texel = texture(sampler2D(groundtruth_views[view_index].handle), tc);
+    out_col = depth ? vec4(vec3(texel.a), 1) : vec4(texel.rgb, 1);
+}
@@ -4,23 +4,32 @@ uniform sampler2D tex0;
 uniform sampler2D tex1;
 uniform sampler2D tex2;
 uniform sampler2D tex3;
+uniform vec2 tc_scale0 = vec2(1); // used parts of the textures (dynamic resolution)
+uniform vec2 tc_scale1 = vec2(1);
+uniform vec2 tc_scale2 = vec2(1);
+uniform vec2 tc_scale3 = vec2(1);
 out vec4 out_col;
 
+// stay half a texel inside the used part, so linear filtering does not fetch outside of it
+vec2 scaled_tc(vec2 t, vec2 scale, sampler2D s) {
+    return min(t * scale, scale - 0.5 / vec2(textureSize(s, 0)));
+}
+
 void main() {
     
     //out_col = vec4(texture(tex1, tc).rgb,1);
     if(tc.x < 0.5 && tc.y >= 0.5){ // top left
         vec2 newtc = vec2(tc.x*2, (tc.y-0.5)*2);
-        out_col = vec4(texture(tex0, newtc).rgb,1);
+        out_col = vec4(texture(tex0, scaled_tc(newtc, tc_scale0, tex0)).rgb,1);
     } else if(tc.x >= 0.5 && tc.y >= 0.5){ // top right
         vec2 newtc = vec2((tc.x-0.5)*2, (tc.y-0.5)*2);
-        out_col = vec4(vec3(texture(tex1, newtc).r),1);
+        out_col = vec4(vec3(texture(tex1, scaled_tc(newtc, tc_scale1, tex1)).r),1);
     } else if(tc.x < 0.5 && tc.y < 0.5){ // bottom left
         vec2 newtc = tc*2;
-        out_col = vec4(vec3(texture(tex2, newtc).a),1);
+        out_col = vec4(vec3(texture(tex2, scaled_tc(newtc, tc_scale2, tex2)).a),1);
     } else if(tc.x >= 0.5 && tc.y < 0.5){ // bottom right
         vec2 newtc = vec2((tc.x-0.5)*2, tc.y*2);
-        out_col = vec4(vec3(texture(tex3, newtc).a),1);
+        out_col = vec4(vec3(texture(tex3, scaled_tc(newtc, tc_scale3, tex3)).a),1);
     } 
     //out_col = vec4(texture(tex1, tc).rgb,1);
     //out_col = vec4(tc.xy,0,1);
@@ -8,4 +8,43 @@ float intersectSpherePlane(vec3 sphere_c, vec3 plane_point, vec3 plane_normal)
     //vec3 plane_normal_normalized = normalize(plane_normal); // normalize 
     float plane_d = dot(plane_point, plane_normal); // get distance to the origin (projected to n)
     return dot(sphere_c, plane_normal) - plane_d; // return distance of sphere_center to plane
-}
\ No newline at end of file
+}
+
+// hierarchical z test of OcclusionCuller (occluded() is the cpu version)
+// returns true if the nearest corner of the box is behind the max depth pyramid (plus bias) over every pixel its points can cover
+// size: pixels of level 0, point_size: gl_PointSize of the points, the box rectangle is widened by half of it and one pixel
+bool occludedHiZ(vec3 aabb_min, vec3 aabb_max, mat4 view_proj, sampler2D hiz, ivec2 size, int levels, float point_size, float bias)
+{
+    vec2 rect_min = vec2(1e30);
+    vec2 rect_max = vec2(-1e30);
+    float depth_min = 1e30;
+    for (int i = 0; i < 8; ++i) {
+        vec3 corner = vec3((i & 1) != 0 ? aabb_max.x : aabb_min.x, (i & 2) != 0 ? aabb_max.y : aabb_min.y, (i & 4) != 0 ? aabb_max.z : aabb_min.z);
+        vec4 clip = view_proj * vec4(corner, 1);
+        if (clip.w <= 0.0) return false; // reaches behind the camera
+        vec3 ndc = clip.xyz / clip.w;
+        vec2 window = (ndc.xy * 0.5 + 0.5) * vec2(size);
+        rect_min = min(rect_min, window);
+        rect_max = max(rect_max, window);
+        depth_min = min(depth_min, ndc.z * 0.5 + 0.5);
+    }
+    // pixels whose centers the points can reach
+    float margin = point_size * 0.5 + 1.0;
+    vec2 lo = clamp(floor(rect_min - margin), vec2(-1), vec2(size));
+    vec2 hi = clamp(floor(rect_max + margin), vec2(-1), vec2(size));
+    ivec2 p0 = max(ivec2(lo), ivec2(0));
+    ivec2 p1 = min(ivec2(hi), size - 1);
+    if (p0.x > p1.x || p0.y > p1.y) return false;
+
+    // level where the rectangle spans at most 2x2 texels
+    int level = 0;
+    while (level < levels - 1 && ((p1.x >> level) - (p0.x >> level) > 1 || (p1.y >> level) - (p0.y >> level) > 1)) ++level;
+    ivec2 dim = max(ivec2(1), size >> level);
+    ivec2 t0 = min(p0 >> level, dim - 1);
+    ivec2 t1 = min(p1 >> level, dim - 1);
+    float depth_max = 0.0;
+    for (int y = t0.y; y <= t1.y; ++y)
+        for (int x = t0.x; x <= t1.x; ++x)
+            depth_max = max(depth_max, texelFetch(hiz, ivec2(x, y), level).r);
+    return depth_min > depth_max + bias;
+}
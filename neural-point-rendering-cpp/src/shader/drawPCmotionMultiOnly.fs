@@ -26,6 +26,13 @@ uniform ivec2 resolution;
 uniform int gt_timestamp_max; 
 uniform int gt_timestamp_min; 
 uniform bool use_timestamp;
+// > 0: the motion is clamped to [-motion_limit, motion_limit] ndc, points near or behind an old camera plane would overflow half floats
+uniform float motion_limit;
+
+vec2 motion(vec4 pos_old) {
+    vec2 tc_old = pos_old.xy/pos_old.w;
+    return motion_limit > 0.0 ? clamp(tc_old, -motion_limit, motion_limit) : tc_old;
+}
 
 void main() {
     if(use_timestamp){
@@ -33,18 +40,12 @@ void main() {
         if (timestamp < gt_timestamp_min ) discard;
     }
     
-    vec2 tc_old_1 = pos_old_1.xy/pos_old_1.w;
-    out_motion_1 = vec4(tc_old_1,1, 1);
-    vec2 tc_old_2 = pos_old_2.xy/pos_old_2.w;
-    out_motion_2 = vec4(tc_old_2,1, 1);
-    vec2 tc_old_3 = pos_old_3.xy/pos_old_3.w;
-    out_motion_3 = vec4(tc_old_3,1, 1); 
-    vec2 tc_old_4 = pos_old_4.xy/pos_old_4.w;
-    out_motion_4 = vec4(tc_old_4,1, 1); 
-    vec2 tc_old_5 = pos_old_5.xy/pos_old_5.w;
-    out_motion_5 = vec4(tc_old_5,1, 1); 
-    vec2 tc_old_6 = pos_old_6.xy/pos_old_6.w;
-    out_motion_6 = vec4(tc_old_6,1, 1);   
+    out_motion_1 = vec4(motion(pos_old_1),1, 1);
+    out_motion_2 = vec4(motion(pos_old_2),1, 1);
+    out_motion_3 = vec4(motion(pos_old_3),1, 1);
+    out_motion_4 = vec4(motion(pos_old_4),1, 1);
+    out_motion_5 = vec4(motion(pos_old_5),1, 1);
+    out_motion_6 = vec4(motion(pos_old_6),1, 1);
 
     /*vec2 tc_old_1 = pos_old_1.xy/pos_old_1.w; // [-1,1]^2
     tc_old_1 = ((tc_old_1+vec2(1,1)) * 0.5); // [0,1]^2
@@ -1,4 +1,5 @@
-#version 330
+#version 460
+#include "__frame_camera_include.glsl"
 layout (location = 0) in vec3 in_pos;
 layout (location = 1) in vec3 in_color;
 layout (location = 2) in vec3 in_normal;
@@ -8,9 +9,6 @@ layout (location = 4) in int in_timestamp;
 //layout (location = 3) in vec2 in_a;
 
 //uniform mat4 model;
-uniform mat4 view_normal;
-uniform mat4 view;
-uniform mat4 proj;
 // old view for motion vecs
 uniform mat4 view_old;
 
@@ -1,4 +1,5 @@
-#version 330
+#version 460
+#include "__frame_camera_include.glsl"
 layout (location = 0) in vec3 in_pos;
 layout (location = 1) in vec3 in_color;
 layout (location = 2) in vec3 in_normal;
@@ -8,18 +9,8 @@ layout (location = 4) in int in_timestamp;
 //layout (location = 3) in vec2 in_a;
 
 //uniform mat4 model;
-uniform mat4 view_normal;
-uniform mat4 view;
-uniform mat4 proj;
-// old view for motion vecs
-uniform mat4 view_old_1;
-uniform mat4 view_old_2;
-uniform mat4 view_old_3;
-uniform mat4 view_old_4;
-uniform mat4 view_old_5;
-uniform mat4 view_old_6;
-
-uniform mat4 proj_old;
+// motion targets that are drawn (the views the network uses), the others are not reprojected
+uniform int motion_count = 6;
 
 uniform int gt_timestamp; 
 
@@ -49,14 +40,14 @@ void main() {
     pos_proj = proj * view * pos_wc;
     gl_Position = pos_proj;
     if (use_taa) 
-        pos_old_1 = proj * view_old_1 * pos_wc; 
+        pos_old_1 = proj * view_old_n(0) * pos_wc; 
     else
-        pos_old_1 = proj_old * view_old_1 * pos_wc; 
-    pos_old_2 = proj_old * view_old_2 * pos_wc; 
-    pos_old_3 = proj_old * view_old_3 * pos_wc; 
-    pos_old_4 = proj_old * view_old_4 * pos_wc; 
-    pos_old_5 = proj_old * view_old_5 * pos_wc; 
-    pos_old_6 = proj_old * view_old_6 * pos_wc;  
+        pos_old_1 = proj_old * view_old_n(0) * pos_wc; 
+    pos_old_2 = motion_count > 1 ? proj_old * view_old_n(1) * pos_wc : vec4(0, 0, 0, 1);
+    pos_old_3 = motion_count > 2 ? proj_old * view_old_n(2) * pos_wc : vec4(0, 0, 0, 1);
+    pos_old_4 = motion_count > 3 ? proj_old * view_old_n(3) * pos_wc : vec4(0, 0, 0, 1);
+    pos_old_5 = motion_count > 4 ? proj_old * view_old_n(4) * pos_wc : vec4(0, 0, 0, 1);
+    pos_old_6 = motion_count > 5 ? proj_old * view_old_n(5) * pos_wc : vec4(0, 0, 0, 1);
 
     timestamp = in_timestamp;
 }
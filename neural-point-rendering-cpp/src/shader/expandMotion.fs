@@ -0,0 +1,15 @@
+#version 460
+in vec2 tc;
+uniform sampler2D tex_motion;
+uniform sampler2D tex_depth;
+uniform bool pre_init;
+out vec4 out_motion;
+
+// compact motion target (rg) -> rgba layout of the captures: (x, y, 1 where a point was rendered, 1)
+// rendered pixels have a depth in (0,1), empty ones 0 (res0) or 1 (mip levels). pre-initialized motion is valid everywhere
+void main() {
+    ivec2 coord = ivec2(gl_FragCoord.xy);
+    float d = texelFetch(tex_depth, coord, 0).r;
+    float rendered = (pre_init || (d > 0.0 && d < 1.0)) ? 1.0 : 0.0;
+    out_motion = vec4(texelFetch(tex_motion, coord, 0).rg, rendered, 1);
+}
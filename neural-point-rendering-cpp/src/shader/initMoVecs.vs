@@ -1,22 +1,11 @@
-#version 330
+#version 460
+#include "__frame_camera_include.glsl"
 in vec3 in_pos;
 in vec2 in_tc;
 //layout (location = 2) in vec2 in_tc;
 //layout (location = 3) in vec2 in_a;
 
 //uniform mat4 model;
-uniform mat4 view_normal;
-uniform mat4 view;
-uniform mat4 proj;
-// old view for motion vecs
-uniform mat4 view_old_1;
-uniform mat4 view_old_2;
-uniform mat4 view_old_3;
-uniform mat4 view_old_4;
-uniform mat4 view_old_5;
-uniform mat4 view_old_6;
-
-uniform mat4 proj_old;
 
 uniform bool use_taa;
 
@@ -58,15 +47,15 @@ void main() {
     pos_proj = proj * view * pos_wc;
     //gl_Position = pos_proj;
     if (use_taa) 
-        pos_old_1 = proj * view_old_1 * pos_world; 
+        pos_old_1 = proj * view_old_n(0) * pos_world; 
     else
-        pos_old_1 = proj_old * view_old_1 * pos_world; 
+        pos_old_1 = proj_old * view_old_n(0) * pos_world; 
     
-    pos_old_2 = proj_old * view_old_2 * pos_world; 
-    pos_old_3 = proj_old * view_old_3 * pos_world; 
-    pos_old_4 = proj_old * view_old_4 * pos_world; 
-    pos_old_5 = proj_old * view_old_5 * pos_world; 
-    pos_old_6 = proj_old * view_old_6 * pos_world; 
+    pos_old_2 = proj_old * view_old_n(1) * pos_world; 
+    pos_old_3 = proj_old * view_old_n(2) * pos_world; 
+    pos_old_4 = proj_old * view_old_n(3) * pos_world; 
+    pos_old_5 = proj_old * view_old_n(4) * pos_world; 
+    pos_old_6 = proj_old * view_old_n(5) * pos_world; 
 
    
 }
\ No newline at end of file
@@ -5,7 +5,7 @@ uniform sampler2D tex_depth;
 uniform ivec2 res_high;
 uniform ivec2 res_low;
 layout (location = 0) out vec4 out_col;
-layout (location = 1) out vec4 out_depth;
+layout (location = 1) out float out_depth;
 
 void main() {
     // tc is middle point of higher res -> on corner of 4 pixels
@@ -53,7 +53,7 @@ void main() {
     }
     gl_FragDepth = minimum;//-0.001;
     out_col = vec4(texelFetch(tex_rgb, coords[minimum_i],0).rgb,1);
-    out_depth = vec4(vec3(minimum),1);
+    out_depth = minimum;
     //out_col = vec4(vec3(minimum),1);
     
     /*if(minimum_i == 0) out_col = vec4(1,0,0,1);
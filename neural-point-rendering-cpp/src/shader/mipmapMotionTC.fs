@@ -11,14 +11,16 @@ uniform sampler2D tex_motion_6;
 
 uniform ivec2 res_high;
 uniform ivec2 res_low;
+// motion targets that are drawn (the views the network uses), the others are not fetched
+uniform int motion_count = 6;
 layout (location = 0) out vec4 out_col;
-layout (location = 1) out vec4 out_depth;
-layout (location = 2) out vec4 out_motion_1;
-layout (location = 3) out vec4 out_motion_2;
-layout (location = 4) out vec4 out_motion_3;
-layout (location = 5) out vec4 out_motion_4;
-layout (location = 6) out vec4 out_motion_5;
-layout (location = 7) out vec4 out_motion_6;
+layout (location = 1) out float out_depth;
+layout (location = 2) out vec2 out_motion_1;
+layout (location = 3) out vec2 out_motion_2;
+layout (location = 4) out vec2 out_motion_3;
+layout (location = 5) out vec2 out_motion_4;
+layout (location = 6) out vec2 out_motion_5;
+layout (location = 7) out vec2 out_motion_6;
 
 void main() {
     // tc is middle point of higher res -> on corner of 4 pixels
@@ -66,19 +68,13 @@ void main() {
     }
     gl_FragDepth = minimum;//-0.001;
     out_col = vec4(texelFetch(tex_rgb, coords[minimum_i],0).rgb,1);
-    out_depth = vec4(vec3(minimum),1);
-    out_motion_1 = vec4(texelFetch(tex_motion_1, coords[minimum_i],0).rgb,1);
-    out_motion_1 = vec4(out_motion_1.rgb, 1);
-    out_motion_2 = vec4(texelFetch(tex_motion_2, coords[minimum_i],0).rgb,1);
-    out_motion_2 = vec4(out_motion_2.rgb, 1);
-    out_motion_3 = vec4(texelFetch(tex_motion_3, coords[minimum_i],0).rgb,1);
-    out_motion_3 = vec4(out_motion_3.rgb, 1);
-    out_motion_4 = vec4(texelFetch(tex_motion_4, coords[minimum_i],0).rgb,1);
-    out_motion_4 = vec4(out_motion_4.rgb, 1);
-    out_motion_5 = vec4(texelFetch(tex_motion_5, coords[minimum_i],0).rgb,1);
-    out_motion_5 = vec4(out_motion_5.rgb, 1);
-    out_motion_6 = vec4(texelFetch(tex_motion_6, coords[minimum_i],0).rgb,1);
-    out_motion_6 = vec4(out_motion_6.rgb, 1);
+    out_depth = minimum;
+    out_motion_1 = texelFetch(tex_motion_1, coords[minimum_i],0).rg;
+    if (motion_count > 1) out_motion_2 = texelFetch(tex_motion_2, coords[minimum_i],0).rg;
+    if (motion_count > 2) out_motion_3 = texelFetch(tex_motion_3, coords[minimum_i],0).rg;
+    if (motion_count > 3) out_motion_4 = texelFetch(tex_motion_4, coords[minimum_i],0).rg;
+    if (motion_count > 4) out_motion_5 = texelFetch(tex_motion_5, coords[minimum_i],0).rg;
+    if (motion_count > 5) out_motion_6 = texelFetch(tex_motion_6, coords[minimum_i],0).rg;
     /*vec4 offset[4];
     for (int i=0; i<4; ++i) offset[i] = vec4(0);
     offset[0] = vec4( 0.25,  0.25,0,0);
@@ -0,0 +1,310 @@
+#include "software_rasterizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+// ------------------------------------------
+// helper funcs
+
+// window depth in [0,1] -> key. positive floats compare like their bit patterns, the point index breaks ties in draw order
+static inline uint64_t depth_key(float z, uint32_t index) {
+	uint32_t bits;
+	std::memcpy(&bits, &z, sizeof(bits));
+	return (uint64_t(bits) << 32) | index;
+}
+
+static inline float key_depth(uint64_t key) {
+	const uint32_t bits = uint32_t(key >> 32);
+	float z;
+	std::memcpy(&z, &bits, sizeof(z));
+	return z;
+}
+
+static inline glm::vec4 reproject(const glm::mat4& m, const glm::vec4& p, float limit) {
+	const glm::vec4 pos_old = m * p;
+	glm::vec2 tc_old = glm::vec2(pos_old) / pos_old.w;
+	if (limit > 0.f) tc_old = glm::clamp(tc_old, -limit, limit);
+	return glm::vec4(tc_old, 1, 1);
+}
+
+// ------------------------------------------
+// SoftwareRasterizer
+
+SoftwareRasterizer::SoftwareRasterizer(int threads) {
+	start(threads);
+}
+
+SoftwareRasterizer::~SoftwareRasterizer() {
+	stop();
+}
+
+void SoftwareRasterizer::start(int threads) {
+	if (threads <= 0) threads = std::max(1, int(std::thread::hardware_concurrency()));
+	running = true;
+	// the calling thread is the last worker
+	for (int i = 0; i < threads - 1; ++i)
+		workers.emplace_back(&SoftwareRasterizer::work, this);
+}
+
+void SoftwareRasterizer::stop() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		running = false;
+	}
+	cv_work.notify_all();
+	for (auto& worker : workers)
+		if (worker.joinable()) worker.join();
+	workers.clear();
+}
+
+void SoftwareRasterizer::configure(int threads) {
+	const int count = threads <= 0 ? std::max(1, int(std::thread::hardware_concurrency())) : threads;
+	if (count == thread_count()) return;
+	stop();
+	start(count);
+}
+
+void SoftwareRasterizer::work() {
+	uint64_t seen = 0;
+	while (true) {
+		const std::function<void(int)>* fn = nullptr;
+		int count = 0;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			cv_work.wait(lock, [&] { return generation != seen || !running; });
+			if (!running) return;
+			seen = generation;
+			// the job may already be finished by the others: the caller cleared it, or a later job is current
+			// joining only under the lock keeps task, task_count and task_next of one job, which waits for workers_active
+			if (!task) continue;
+			fn = task;
+			count = task_count;
+			++workers_active;
+		}
+		run_tasks(*fn, count);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			--workers_active;
+		}
+		cv_done.notify_all();
+	}
+}
+
+void SoftwareRasterizer::run_tasks(const std::function<void(int)>& fn, int count) {
+	int done = 0;
+	for (int i = task_next.fetch_add(1); i < count; i = task_next.fetch_add(1)) {
+		fn(i);
+		++done;
+	}
+	if (done == 0) return;
+	std::lock_guard<std::mutex> lock(mutex);
+	tasks_done += done;
+}
+
+void SoftwareRasterizer::parallel_for(int count, const std::function<void(int)>& fn) {
+	if (workers.empty() || count <= 1) {
+		for (int i = 0; i < count; ++i) fn(i);
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		task = &fn;
+		task_count = count;
+		task_next = 0;
+		tasks_done = 0;
+		++generation;
+	}
+	cv_work.notify_all();
+	run_tasks(fn, count);
+	// workers that picked up this job must be done with it before fn goes out of scope
+	std::unique_lock<std::mutex> lock(mutex);
+	cv_done.wait(lock, [&] { return tasks_done == count && workers_active == 0; });
+	// workers woken for this job that did not join yet skip it
+	task = nullptr;
+	task_count = 0;
+}
+
+// collect the point ranges of the voxels that intersect the view frustum (planes of view_proj, conservative sphere test)
+void SoftwareRasterizer::cull(const Points& points, const glm::mat4& view_proj) {
+	ranges.clear();
+	const auto add_range = [&](uint32_t start, uint32_t count) {
+		for (uint32_t offset = 0; offset < count; offset += chunk_points)
+			ranges.emplace_back(start + offset, std::min<uint32_t>(chunk_points, count - offset));
+	};
+	if (points.voxels.empty()) {
+		add_range(0, uint32_t(points.positions.size()));
+		points_visible = points.positions.size();
+		return;
+	}
+
+	const glm::mat4 m = glm::transpose(view_proj);
+	glm::vec4 planes[6] = { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2] };
+	for (auto& plane : planes) plane /= glm::length(glm::vec3(plane));
+
+	points_visible = 0;
+	for (const auto& voxel : points.voxels) {
+		if (voxel.size == 0) continue;
+		bool inside = true;
+		for (const auto& plane : planes)
+			if (glm::dot(glm::vec3(plane), voxel.center) + plane.w < -voxel.radius) {
+				inside = false;
+				break;
+			}
+		if (!inside) continue;
+		add_range(voxel.start, voxel.size);
+		points_visible += voxel.size;
+	}
+	std::sort(ranges.begin(), ranges.end());
+}
+
+// transform the points of a chunk and append them to the bins of the tiles they cover
+void SoftwareRasterizer::bin(const Points& points, const Params& params, int chunk) {
+	auto& chunk_bins = bins[chunk];
+	for (auto& b : chunk_bins) b.clear();
+	const int size = std::max(1, params.point_size);
+	const float half = 0.5f * float(size);
+	const glm::vec2 res = glm::vec2(resolution);
+	const bool filter = params.use_timestamp;
+	const bool has_timestamps = !points.timestamps.empty();
+	size_t drawn = 0;
+
+	for (size_t r = chunks[chunk]; r < chunks[chunk + 1]; ++r) {
+		const uint32_t end = ranges[r].first + ranges[r].second;
+		for (uint32_t i = ranges[r].first; i < end; ++i) {
+			if (filter) {
+				const int timestamp = has_timestamps ? points.timestamps[i] : 0;
+				if (timestamp > params.timestamp_max || timestamp < params.timestamp_min) continue;
+			}
+			const glm::vec4 clip = view_proj * glm::vec4(points.positions[i], 1);
+			// gl discards points whose vertex is outside of the clip volume
+			if (!(clip.w > 0.f) || std::abs(clip.x) > clip.w || std::abs(clip.y) > clip.w || std::abs(clip.z) > clip.w) continue;
+			const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+			const float z = ndc.z * 0.5f + 0.5f;
+			// first pixel whose center is inside of [window - size/2, window + size/2)
+			const int x0 = int(std::ceil((ndc.x * 0.5f + 0.5f) * res.x - half - 0.5f));
+			const int y0 = int(std::ceil((ndc.y * 0.5f + 0.5f) * res.y - half - 0.5f));
+			const int x1 = std::min(x0 + size - 1, resolution.x - 1);
+			const int y1 = std::min(y0 + size - 1, resolution.y - 1);
+			if (x1 < 0 || y1 < 0 || x0 >= resolution.x || y0 >= resolution.y) continue;
+
+			const Splat splat = { x0, y0, depth_key(z, i) };
+			for (int ty = std::max(0, y0) / tile_size; ty <= y1 / tile_size; ++ty)
+				for (int tx = std::max(0, x0) / tile_size; tx <= x1 / tile_size; ++tx)
+					chunk_bins[size_t(ty) * tiles.x + tx].push_back(splat);
+			++drawn;
+		}
+	}
+	chunk_drawn[chunk] = drawn;
+}
+
+// depth test of every splat of the tile, then shade the winning point of each pixel
+void SoftwareRasterizer::resolve(const Points& points, const Params& params, int tile) {
+	const int motion_count = glm::clamp(params.motion_count, 1, 6);
+	const int size = std::max(1, params.point_size);
+	const glm::ivec2 t = glm::ivec2(tile % tiles.x, tile / tiles.x) * tile_size;
+	const glm::ivec2 t_end = glm::min(t + tile_size, resolution);
+
+	uint64_t keys[tile_size * tile_size];
+	std::fill(keys, keys + tile_size * tile_size, empty_key);
+	for (const auto& chunk_bins : bins)
+		for (const Splat& splat : chunk_bins[tile]) {
+			const int x0 = std::max(splat.x, t.x) - t.x, x1 = std::min(splat.x + size, t_end.x) - t.x;
+			const int y0 = std::max(splat.y, t.y) - t.y, y1 = std::min(splat.y + size, t_end.y) - t.y;
+			const uint64_t key = splat.key;
+			for (int y = y0; y < y1; ++y) {
+				uint64_t* row = keys + y * tile_size;
+				for (int x = x0; x < x1; ++x)
+					row[x] = key < row[x] ? key : row[x];
+			}
+		}
+
+	const glm::vec4 clear = glm::vec4(0, 0, 0, 1);
+	for (int y = t.y; y < t_end.y; ++y) {
+		const size_t row = size_t(y) * resolution.x;
+		for (int x = t.x; x < t_end.x; ++x) {
+			const uint64_t key = keys[(y - t.y) * tile_size + (x - t.x)];
+			const size_t p = row + x;
+			if (key == empty_key) {
+				if (params.color) {
+					color[p] = clear;
+					depth_color[p] = clear;
+					depth[p] = 1.f;
+				}
+				if (!params.motion) continue;
+				if (!params.pre_init_motion) {
+					for (int i = 0; i < motion_count; ++i) motion[i][p] = params.motion_clear;
+					continue;
+				}
+				// initMoVecs: the pixel center on the far plane, unprojected into the world
+				const glm::vec4 ndc = glm::vec4((x + 0.5f) / resolution.x * 2.f - 1.f, (y + 0.5f) / resolution.y * 2.f - 1.f, 0.99999f, 1.f);
+				glm::vec4 pos_view = inv_proj * ndc;
+				pos_view /= pos_view.w;
+				glm::vec4 pos_world = inv_view * pos_view;
+				pos_world /= pos_world.w;
+				for (int i = 0; i < motion_count; ++i) motion[i][p] = reproject(view_proj_old[i], pos_world, params.motion_limit);
+				continue;
+			}
+			const uint32_t index = uint32_t(key);
+			if (params.color) {
+				const float z = key_depth(key);
+				color[p] = glm::vec4(points.colors[index], 1);
+				depth_color[p] = glm::vec4(z, z, z, 1);
+				depth[p] = z;
+			}
+			if (params.motion) {
+				const glm::vec4 pos_world = glm::vec4(points.positions[index], 1);
+				for (int i = 0; i < motion_count; ++i) motion[i][p] = reproject(view_proj_old[i], pos_world, params.motion_limit);
+			}
+		}
+	}
+}
+
+void SoftwareRasterizer::render(const Points& points, glm::ivec2 resolution, const Params& params) {
+	const auto start = std::chrono::steady_clock::now();
+	this->resolution = glm::max(resolution, glm::ivec2(1));
+	const size_t pixels = size_t(this->resolution.x) * size_t(this->resolution.y);
+	if (params.color) {
+		color.resize(pixels);
+		depth_color.resize(pixels);
+		depth.resize(pixels);
+	}
+	// only the used motion targets are rendered, the others keep their last content
+	if (params.motion)
+		for (int i = 0; i < glm::clamp(params.motion_count, 1, 6); ++i) motion[i].resize(pixels);
+
+	view_proj = params.proj * params.view;
+	for (int i = 0; i < 6; ++i)
+		view_proj_old[i] = (i == 0 && params.use_taa ? params.proj : params.proj_old) * params.view_old[i];
+	inv_proj = glm::inverse(params.proj);
+	inv_view = glm::inverse(params.view);
+
+	cull(points, view_proj);
+	chunks.clear();
+	size_t chunk_size = 0;
+	for (size_t r = 0; r < ranges.size(); ++r) {
+		if (r == 0 || chunk_size + ranges[r].second > chunk_points) {
+			chunks.push_back(r);
+			chunk_size = 0;
+		}
+		chunk_size += ranges[r].second;
+	}
+	const int chunk_count = int(chunks.size());
+	chunks.push_back(ranges.size());
+
+	tiles = (this->resolution + tile_size - 1) / tile_size;
+	const int tile_count = tiles.x * tiles.y;
+	if (int(bins.size()) < chunk_count) bins.resize(chunk_count);
+	for (auto& chunk_bins : bins) chunk_bins.resize(tile_count);
+	// bins of earlier frames with more chunks stay allocated, but must not be resolved
+	for (size_t c = chunk_count; c < bins.size(); ++c)
+		for (auto& b : bins[c]) b.clear();
+	chunk_drawn.assign(chunk_count, 0);
+
+	parallel_for(chunk_count, [&](int chunk) { bin(points, params, chunk); });
+	parallel_for(tile_count, [&](int tile) { resolve(points, params, tile); });
+
+	points_drawn = 0;
+	for (size_t drawn : chunk_drawn) points_drawn += drawn;
+	render_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
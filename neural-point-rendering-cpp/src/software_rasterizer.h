@@ -0,0 +1,135 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "PointCloudData.h"
+
+/*  Software Rasterizer: multithreaded cpu backend of the gl point rendering (drawPCmultiMotion, drawPCmotionMultiOnly)
+	Renders the same targets as the shaders: color, depth (as color and depth buffer) and the six motion vectors, that is the
+	ndc position of every point in view_old_1..6 (view_old_1 with proj instead of proj_old for taa), including the timestamp filter
+	and the optional pre-initialization of the motion vectors with the reprojected far plane (initMoVecs).
+	Points are rasterized as gl_Points without anti-aliasing: a point covers the point_size x point_size pixels whose centers lie
+	in the square around its window position, points whose center is outside of the clip volume are discarded.
+	Every frame:
+		1. the points of the voxels in the view frustum are transformed in parallel chunks and binned into screen tiles
+		2. the tiles are resolved in parallel: depth and point index are packed into one 64 bit key per pixel, the smallest key wins.
+		   This is the depth test GL_LESS with draw order on equal depth, independent of the chunking. The key minimum over a
+		   row of the point footprint is a branchless loop, vectorized by the compiler
+		3. the winning point of every pixel is shaded (color, depth, motion vectors)
+	The targets are stored bottom row first (like gl textures), so they can be uploaded without conversion.
+	Common usage:
+		on load: points.push_back(Points{positions, colors, timestamps, voxels}) per level of detail
+		per frame:
+			render(points[lod], resolution, params)
+			upload color, depth_color, depth and motion[0..motion_count-1] into the render targets
+*/
+class SoftwareRasterizer {
+//structs
+public:
+	// cpu copy of a point cloud
+	struct Points {
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec3> colors;
+		std::vector<int> timestamps;			// empty: every point has timestamp 0 (like the missing vertex attribute)
+		std::vector<PointCloudVoxel> voxels;	// ranges of points for culling, empty: no culling
+	};
+
+	// uniforms of the shaders
+	struct Params {
+		glm::mat4 proj = glm::mat4(1);
+		glm::mat4 view = glm::mat4(1);
+		glm::mat4 proj_old = glm::mat4(1);
+		glm::mat4 view_old[6] = { glm::mat4(1), glm::mat4(1), glm::mat4(1), glm::mat4(1), glm::mat4(1), glm::mat4(1) };
+		bool use_taa = false;
+		bool use_timestamp = false;
+		int timestamp_min = 0;
+		int timestamp_max = 0;
+		int point_size = 1;
+		bool color = true;						// color and depth targets
+		bool motion = true;						// motion vector targets
+		int motion_count = 6;					// motion[0..motion_count-1] are rendered (the views the network uses)
+		bool pre_init_motion = false;			// empty pixels get the motion of the far plane (initMoVecs) instead of the clear color
+		glm::vec4 motion_clear = glm::vec4(0, 0, 0, 1);
+		float motion_limit = 0.f;				// > 0: the motion is clamped to [-motion_limit, motion_limit] ndc (half float targets)
+	};
+
+	// point of a bin: first covered pixel and depth test key
+	struct Splat {
+		int x = 0, y = 0;
+		uint64_t key = 0;
+	};
+
+//data
+public:
+	static constexpr int tile_size = 32;
+	static constexpr int chunk_points = 1 << 16;	// points per transform task
+	static constexpr uint64_t empty_key = ~uint64_t(0);
+
+	// targets of the last render(), resolution.x * resolution.y, bottom row first
+	glm::ivec2 resolution = glm::ivec2(0);
+	std::vector<glm::vec4> color;
+	std::vector<glm::vec4> depth_color;
+	std::vector<float> depth;
+	std::vector<glm::vec4> motion[6];
+
+	// statistics of the last render()
+	size_t points_visible = 0;		// points of the voxels that passed the culling
+	size_t points_drawn = 0;		// points that passed clipping and the timestamp filter
+	float render_ms = 0.f;
+
+//methods
+public:
+	SoftwareRasterizer(int threads = 0);
+	~SoftwareRasterizer();
+
+	// restarts the worker threads if their amount changed. threads <= 0: all hardware threads
+	void configure(int threads);
+	int thread_count() const { return int(workers.size()) + 1; }
+
+	void render(const Points& points, glm::ivec2 resolution, const Params& params);
+
+	SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+	SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+private:
+	void start(int threads);
+	void stop();
+	void work();
+	// run fn(0..count-1) on the workers and the calling thread, returns when every task has finished
+	void parallel_for(int count, const std::function<void(int)>& fn);
+	void run_tasks(const std::function<void(int)>& fn, int count);
+
+	void cull(const Points& points, const glm::mat4& view_proj);
+	void bin(const Points& points, const Params& params, int chunk);
+	void resolve(const Points& points, const Params& params, int tile);
+
+	// per frame
+	std::vector<std::pair<uint32_t, uint32_t>> ranges;	// start and count of the visible points, ascending, at most chunk_points each
+	std::vector<size_t> chunks;							// first range of each transform task, followed by ranges.size()
+	std::vector<std::vector<std::vector<Splat>>> bins;	// [chunk][tile]
+	std::vector<size_t> chunk_drawn;
+	glm::ivec2 tiles = glm::ivec2(0);
+	glm::mat4 view_proj = glm::mat4(1);
+	glm::mat4 view_proj_old[6];
+	glm::mat4 inv_proj = glm::mat4(1);
+	glm::mat4 inv_view = glm::mat4(1);
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable cv_work;
+	std::condition_variable cv_done;
+	// current job, nullptr between jobs. set, read and cleared under the mutex only
+	const std::function<void(int)>* task = nullptr;
+	int task_count = 0;
+	std::atomic<int> task_next{ 0 };
+	int tasks_done = 0;
+	int workers_active = 0;
+	uint64_t generation = 0;
+	bool running = false;
+};
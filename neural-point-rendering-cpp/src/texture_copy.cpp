@@ -1,4 +1,5 @@
 #include "texture_copy.h"
+#include "pixel_transfer.h"
 #include <cuda_gl_interop.h>
 #include <torch/torch.h>
 
@@ -10,6 +11,9 @@ cudaGraphicsResource* res2;
 cudaArray_t array1;
 cudaArray_t array2;
 
+static torch::Device transfer_device = torch::kCUDA;
+static PixelTransfer pixel_transfer;
+
 
 
 void CHECK_CUDA(cudaError_t err) {
@@ -98,6 +102,32 @@ int texture_to_texture(GLuint tex1, GLuint tex2, size_t height, size_t width) {
 	return 0;
 }
 
+void set_texture_transfer_device(torch::Device device) {
+	transfer_device = device;
+}
+
+torch::Device get_texture_transfer_device() {
+	return transfer_device;
+}
+
+// created lazily, since a gl context is needed
+static PixelTransfer get_pixel_transfer() {
+	if (!pixel_transfer) pixel_transfer = PixelTransfer("texture_copy_transfer", 2);
+	return pixel_transfer;
+}
+
+void release_texture_transfers() {
+	if (!pixel_transfer) return;
+	pixel_transfer->clear();
+	PixelTransfer::erase(pixel_transfer->name);
+	pixel_transfer = PixelTransfer();
+}
+
+void texture2D_request_readback(Texture2D tex) {
+	if (transfer_device.is_cuda()) return;
+	get_pixel_transfer()->request_readback(tex);
+}
+
 pair<torch::ScalarType, int> get_type_from_texture2D(Texture2D tex) {
 	// GL_UNSIGNED_BYTE, GL_BYTE, GL_UNSIGNED_SHORT, GL_SHORT, GL_UNSIGNED_INT, GL_INT, GL_HALF_FLOAT, GL_FLOAT
 	// dtype: kUInt8, kInt8, kInt16, kInt32, kInt64, kFloat32
@@ -175,11 +205,23 @@ torch::Tensor texture2D_to_tensor(Texture2D tex, int height, int width, int chan
 	}
 	//std::cout << "transform texture of size [" << h_tensor << ", " << w_tensor << ", " << c_tensor << "]"<<std::endl;
 
-	torch::Tensor tensor = torch::zeros({ h_tensor,w_tensor, c_tensor }, torch::TensorOptions().device(torch::kCUDA).dtype(d_t));
-	texture_to_tensor(tex->id, tensor, (size_t)min(tex->h, h_tensor), (size_t)min(tex->w, w_tensor) * type_size_used * c_tensor);
+	if (!transfer_device.is_cuda()) {
+		// read back through pixel buffers. the mapped memory is only wrapped, flip() below copies it out
+		torch::Tensor tensor = get_pixel_transfer()->readback(tex);
+		tensor = tensor.index({ Slice(0, min(tex->h, h_tensor)), Slice(0, min(tex->w, w_tensor)), Slice(0, min(c, c_tensor)) });
+		if (overwrite_type && d_t != tensor.scalar_type()) tensor = tensor.to(d_t);
+		tensor = tensor.permute({ 2,0,1 });
+		tensor = tensor.flip({ 1 });
+		return transfer_device.is_cpu() ? tensor : tensor.to(transfer_device);
+	}
+
+	// the rows of the cuda array have the channels of the texture, compact targets (r, rg) have fewer than requested
+	const int c_transfer = get_transfer_channels(tex);
+	torch::Tensor tensor = torch::zeros({ h_tensor,w_tensor, c_transfer }, torch::TensorOptions().device(torch::kCUDA).dtype(d_t));
+	texture_to_tensor(tex->id, tensor, (size_t)min(tex->h, h_tensor), (size_t)min(tex->w, w_tensor) * type_size_used * c_transfer);
 
-	if (c_tensor != c) {
-		tensor = tensor.index({ Slice(), Slice(), Slice(0, c) });
+	if (c_transfer != min(c, c_tensor)) {
+		tensor = tensor.index({ Slice(), Slice(), Slice(0, min(c, c_tensor)) });
 	}
 
 	//permute to CxHxW and flip H dimension
@@ -199,6 +241,32 @@ torch::Tensor texture2D_to_tensor(Texture2D tex, int height, int width) {
 	return texture2D_to_tensor(tex, height, width, -1, false, torch::kFloat32, -1);
 }
 
+torch::Tensor texture2D_to_staging(Texture2D tex, torch::Tensor& staging) {
+	if (!transfer_device.is_cuda())
+		return get_pixel_transfer()->readback(tex);
+
+	int c = get_transfer_channels(tex);
+	pair<torch::ScalarType, int> type_info = get_type_from_texture2D(tex);
+	if (!staging.defined() || staging.size(0) != tex->h || staging.size(1) != tex->w || staging.size(2) != c || staging.scalar_type() != type_info.first)
+		staging = torch::empty({ tex->h, tex->w, c }, torch::TensorOptions().device(torch::kCUDA).dtype(type_info.first));
+	texture_to_tensor(tex->id, staging, (size_t)tex->h, (size_t)tex->w * type_info.second * c);
+	return staging;
+}
+
+void staging_to_texture2D(torch::Tensor staging, Texture2D tex) {
+	if (!transfer_device.is_cuda()) {
+		get_pixel_transfer()->upload(staging, tex);
+		return;
+	}
+	int c = get_transfer_channels(tex);
+	if (staging.dim() != 3 || staging.size(0) != tex->h || staging.size(1) != tex->w || staging.size(2) != c || !staging.is_contiguous()) {
+		cerr << "Staging tensor of size " << staging.sizes() << " does not match texture [" << tex->h << ", " << tex->w << ", " << c << "] or is not contiguous." << endl;
+		cerr << "Aborting copy into: " << tex->name << endl;
+		return;
+	}
+	tensor_to_texture(tex->id, staging, (size_t)tex->h, (size_t)tex->w * get_type_from_texture2D(tex).second * c);
+}
+
 // wxhx3
 void tensor_to_texture2D(torch::Tensor t, Texture2D tex, int height, int width, bool ignore_type_check) {
 	// Check dimensions of tensor
@@ -210,6 +278,17 @@ void tensor_to_texture2D(torch::Tensor t, Texture2D tex, int height, int width,
 
 	}
 
+	if (!transfer_device.is_cuda()) {
+		if (tex->format == GL_RGB) {
+			cerr << "Texture is of RGB format. This Format is not supported" << endl;
+			cerr << "Aborting copy." << endl;
+			return;
+		}
+		// upload through pixel buffers, the flipped/permuted view is written directly into the mapped memory
+		get_pixel_transfer()->upload(t.flip({ 1 }).permute({ 1,2,0 }), tex);
+		return;
+	}
+
 	if (!t.device().is_cuda()) {
 		cerr << "Tensor is not on the GPU, please use .to(torch::kCUDA)" << std::endl;
 		return;
@@ -14,7 +14,17 @@ int texture_to_texture(GLuint tex1, GLuint tex2, size_t height, size_t width);
 
 std::pair<torch::ScalarType, int> get_type_from_texture2D(Texture2D tex);
 
+// device of the tensors returned by/passed to the texture2D conversions (default: kCUDA)
+// cuda uses cuda-gl interop, every other device transfers asynchronously through persistently mapped pixel buffers
+void set_texture_transfer_device(torch::Device device);
+torch::Device get_texture_transfer_device();
+// issue an asynchronous download of tex, consumed by the next texture2D_to_tensor call of tex (no-op for cuda interop)
+void texture2D_request_readback(Texture2D tex);
+// unmap and delete the pixel buffers and fences of the transfers, call at shutdown while the gl context exists
+void release_texture_transfers();
+
 //output: CxHxW tensor (y dimension is flipped afterwords to convert from opengl)
+//channels: at most the channels of tex, compact render targets (r32f depth, rg motion) return only the channels they store
 torch::Tensor texture2D_to_tensor(Texture2D tex, int height, int width, int channels, bool overwrite_type, torch::ScalarType type, int type_size);
 //output: CxHxW tensor (y dimension is flipped afterwords to convert from opengl)
 torch::Tensor texture2D_to_tensor(Texture2D tex, int height, int width, int channels);
@@ -22,5 +32,12 @@ torch::Tensor texture2D_to_tensor(Texture2D tex, int height, int width, int chan
 torch::Tensor texture2D_to_tensor(Texture2D tex, int height, int width);
 
 
+//output: HxWxC tensor in gl layout (y not flipped, rgb padded to rgba) without allocations in the steady state
+//interop: tex is copied into staging, which is (re)allocated only if its shape/type does not match
+//pixel buffers: the mapped memory is wrapped (valid until the next readback of tex), staging stays untouched
+torch::Tensor texture2D_to_staging(Texture2D tex, torch::Tensor& staging);
+//input: HxWxC tensor in gl layout (y already flipped) with the channel count and type of tex
+void staging_to_texture2D(torch::Tensor staging, Texture2D tex);
+
 //input: CxHxW tensor, channels should not be three, will internally flip y to convert to opengl
 void tensor_to_texture2D(torch::Tensor tensor, Texture2D tex, int height, int width, bool ignore_type_check);
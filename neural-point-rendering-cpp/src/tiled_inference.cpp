@@ -0,0 +1,221 @@
+#include "tiled_inference.h"
+#include <ATen/Parallel.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+
+static int round_up_32(int v) { return ((v + 31) / 32) * 32; }
+
+int TiledInference::tile_size_from_budget(size_t budget_bytes, size_t bytes_per_pixel, int halo, int threads) {
+	size_t budget_per_thread = budget_bytes / size_t(std::max(1, threads));
+	int side = int(std::sqrt(double(budget_per_thread) / double(std::max<size_t>(1, bytes_per_pixel))));
+	int core = side - 2 * round_up_32(halo);
+	return std::max(32, (core / 32) * 32);
+}
+
+std::vector<TiledInference::Tile> TiledInference::plan(int width, int height, int tile_size, int halo) {
+	std::vector<Tile> tiles;
+	tile_size = std::max(32, (tile_size / 32) * 32);
+	halo = round_up_32(halo);
+	for (int cy0 = 0; cy0 < height; cy0 += tile_size) {
+		for (int cx0 = 0; cx0 < width; cx0 += tile_size) {
+			Tile tile;
+			tile.cx0 = cx0;
+			tile.cy0 = cy0;
+			tile.cw = std::min(tile_size, width - cx0);
+			tile.ch = std::min(tile_size, height - cy0);
+			tile.x0 = std::max(0, cx0 - halo);
+			tile.y0 = std::max(0, cy0 - halo);
+			tile.w = std::min(width, cx0 + tile.cw + halo) - tile.x0;
+			tile.h = std::min(height, cy0 + tile.ch + halo) - tile.y0;
+			tiles.push_back(tile);
+		}
+	}
+	return tiles;
+}
+
+// blend weights along one axis of a tile: one inside the core, linear ramps of width blend centered on the core borders
+// towards neighboring tiles. the ramps of two neighbors sum up to one
+torch::Tensor TiledInference::ramp(int start, int core_start, int core_end, int end, int blend, bool ramp_start, bool ramp_end, torch::Device device) {
+	torch::Tensor x = torch::arange(start, end, torch::TensorOptions().device(device).dtype(torch::kFloat32)) + 0.5f;
+	torch::Tensor w = torch::ones_like(x);
+	if (blend <= 0) {
+		if (ramp_start) w = w * (x >= float(core_start)).to(torch::kFloat32);
+		if (ramp_end) w = w * (x < float(core_end)).to(torch::kFloat32);
+		return w;
+	}
+	if (ramp_start) w = torch::min(w, ((x - (core_start - 0.5f * blend)) / float(blend)).clamp(0.0, 1.0));
+	if (ramp_end) w = torch::min(w, (((core_end + 0.5f * blend) - x) / float(blend)).clamp(0.0, 1.0));
+	return w;
+}
+
+void TiledInference::reset() {
+	prev_output = torch::Tensor();
+	prev_resolution0 = torch::Tensor();
+	prev_groundtruth.clear();
+	prev_motion.clear();
+	prev_module = nullptr;
+}
+
+static bool differs(const torch::Tensor& a, const torch::Tensor& b, float tolerance) {
+	return !b.defined() || a.sizes() != b.sizes() || a.device() != b.device() || (a - b).abs().max().item<float>() > tolerance;
+}
+
+std::vector<bool> TiledInference::changed_tiles(NetworkInputArena& arena, int halo, float tolerance) {
+	const torch::Tensor& res0 = arena.resolutions[0];
+	bool all = !prev_output.defined() || prev_output.sizes() != torch::IntArrayRef({ 1, 3, res0.size(2), res0.size(3) })
+		|| prev_groundtruth.size() != arena.groundtruth_inputs().size() || prev_motion.size() != arena.motion.size()
+		|| !prev_resolution0.defined() || prev_resolution0.sizes() != res0.sizes() || prev_resolution0.device() != res0.device();
+	// auxiliary images are sampled anywhere through the motion vectors -> a change affects every tile
+	for (size_t i = 0; !all && i < arena.groundtruth_inputs().size(); ++i)
+		all = differs(arena.groundtruth_inputs()[i], prev_groundtruth[i], tolerance);
+	if (all) return std::vector<bool>(tiles.size(), true);
+
+	// per pixel change of the point rendering and the motion
+	torch::Tensor changed = ((res0 - prev_resolution0).abs().amax(1, true) > tolerance);
+	for (size_t i = 0; i < arena.motion.size(); ++i) {
+		if (arena.motion[i].size(2) == res0.size(2) && arena.motion[i].size(3) == res0.size(3) && prev_motion[i].sizes() == arena.motion[i].sizes())
+			changed = changed.logical_or((arena.motion[i] - prev_motion[i]).abs().amax(1, true) > tolerance);
+		else if (differs(arena.motion[i], prev_motion[i], tolerance))
+			return std::vector<bool>(tiles.size(), true);
+	}
+
+	// reduce to the core grid and dilate by the halo: a tile is affected by changes inside its input region
+	torch::Tensor cells = torch::max_pool2d(changed.to(torch::kFloat32), { tile_size, tile_size }, { tile_size, tile_size }, { 0, 0 }, { 1, 1 }, true);
+	int k = (round_up_32(halo) + tile_size - 1) / tile_size;
+	if (k > 0) cells = torch::max_pool2d(cells, { 2 * k + 1, 2 * k + 1 }, { 1, 1 }, { k, k });
+	cells = cells.to(torch::kCPU);
+	auto cells_a = cells.accessor<float, 4>();
+
+	std::vector<bool> result(tiles.size());
+	for (size_t t = 0; t < tiles.size(); ++t)
+		result[t] = cells_a[0][0][tiles[t].cy0 / tile_size][tiles[t].cx0 / tile_size] > 0.0f;
+	return result;
+}
+
+// copies into persistent buffers, only allocates if the inputs changed their shape
+static void store(torch::Tensor& dst, const torch::Tensor& src) {
+	if (!dst.defined() || dst.sizes() != src.sizes() || dst.device() != src.device() || dst.scalar_type() != src.scalar_type())
+		dst = torch::empty_like(src, torch::MemoryFormat::Contiguous);
+	dst.copy_(src);
+}
+
+void TiledInference::store_inputs(NetworkInputArena& arena) {
+	store(prev_resolution0, arena.resolutions[0]);
+	prev_groundtruth.resize(arena.groundtruth_inputs().size());
+	for (size_t i = 0; i < arena.groundtruth_inputs().size(); ++i) store(prev_groundtruth[i], arena.groundtruth_inputs()[i]);
+	prev_motion.resize(arena.motion.size());
+	for (size_t i = 0; i < arena.motion.size(); ++i) store(prev_motion[i], arena.motion[i]);
+}
+
+int TiledInference::parallel_tiles(int threads, torch::Device device) {
+	// nested parallel regions run single threaded: a forward inside at::parallel_for would use one core only
+	return device.is_cuda() ? std::max(1, threads) : 1;
+}
+
+torch::Tensor TiledInference::run(torch::jit::script::Module& module, NetworkInputArena& arena, NetworkPrecision precision, torch::Device device,
+	int tile_size, int halo, int blend, int threads, bool selective, float tolerance) {
+	auto start = std::chrono::steady_clock::now();
+	const int H = int(arena.resolutions[0].size(2));
+	const int W = int(arena.resolutions[0].size(3));
+	tile_size = std::max(32, (tile_size / 32) * 32);
+	this->tile_size = tile_size;
+	tiles = plan(W, H, tile_size, halo);
+	blend = std::min(blend, round_up_32(halo));
+
+	// tiles to infer, all of them without selective update or if the network changed
+	std::vector<bool> infer(tiles.size(), true);
+	if (selective && prev_module == module._ivalue().get() && prev_precision == precision)
+		infer = changed_tiles(arena, halo, tolerance);
+	std::vector<int> todo;
+	for (int t = 0; t < int(tiles.size()); ++t)
+		if (infer[t]) todo.push_back(t);
+	tiles_inferred = int(todo.size());
+
+	auto options = torch::TensorOptions().device(device).dtype(torch::kFloat32);
+	if (!accum.defined() || accum.size(2) != H || accum.size(3) != W || accum.device() != device) {
+		accum = torch::zeros({ 1, 3, H, W }, options);
+		weight_sum = torch::zeros({ 1, 1, H, W }, options);
+	}
+	else {
+		accum.zero_();
+		weight_sum.zero_();
+	}
+
+	std::atomic<int> next_tile{ 0 };
+	std::mutex accum_mutex;
+	std::string error;
+	auto work = [&]() {
+		// grad mode and autocast are thread local
+		torch::NoGradGuard no_grad;
+		PrecisionGuard precision_guard(precision, device);
+		for (int n = next_tile++; n < int(todo.size()); n = next_tile++) {
+			const Tile& tile = tiles[todo[n]];
+			try {
+				std::vector<torch::jit::IValue> current, groundtruth, motion;
+				for (int l = 0; l < int(arena.resolutions.size()); ++l)
+					current.push_back(arena.resolutions[l].narrow(2, tile.y0 >> l, tile.h >> l).narrow(3, tile.x0 >> l, tile.w >> l));
+				for (const auto& gt : arena.groundtruth_inputs())
+					groundtruth.push_back(gt);
+				for (const auto& m : arena.motion) {
+					double scale = double(m.size(3)) / double(W);
+					motion.push_back(m.narrow(2, int(tile.y0 * scale), int(tile.h * scale)).narrow(3, int(tile.x0 * scale), int(tile.w * scale)));
+				}
+				std::vector<torch::jit::IValue> inputs;
+				inputs.push_back(c10::ivalue::Tuple::create(current));
+				inputs.push_back(c10::ivalue::Tuple::create(groundtruth));
+				inputs.push_back(c10::ivalue::Tuple::create(motion));
+				torch::Tensor out = module.forward(inputs).toTensor().narrow(1, 0, 3).to(torch::kFloat32);
+
+				torch::Tensor wy = ramp(tile.y0, tile.cy0, tile.cy0 + tile.ch, tile.y0 + tile.h, blend, tile.cy0 > 0, tile.cy0 + tile.ch < H, device).view({ 1, 1, tile.h, 1 });
+				torch::Tensor wx = ramp(tile.x0, tile.cx0, tile.cx0 + tile.cw, tile.x0 + tile.w, blend, tile.cx0 > 0, tile.cx0 + tile.cw < W, device).view({ 1, 1, 1, tile.w });
+				torch::Tensor weight = wy * wx;
+
+				std::lock_guard<std::mutex> lock(accum_mutex);
+				accum.narrow(2, tile.y0, tile.h).narrow(3, tile.x0, tile.w).add_(out * weight);
+				weight_sum.narrow(2, tile.y0, tile.h).narrow(3, tile.x0, tile.w).add_(weight);
+			}
+			catch (const c10::Error& e) {
+				std::lock_guard<std::mutex> lock(accum_mutex);
+				error = e.what_without_backtrace();
+			}
+		}
+	};
+
+	// the workers run on the intra-op threads of torch, every one takes tiles until none are left
+	// on the cpu the tiles run one after another, each forward on all intra-op threads
+	threads = std::max(1, std::min(parallel_tiles(threads, device), int(todo.size())));
+	if (threads == 1) {
+		work();
+	}
+	else {
+		at::parallel_for(0, threads, 1, [&](int64_t begin, int64_t end) {
+			for (int64_t i = begin; i < end; ++i) work();
+		});
+	}
+	TORCH_CHECK(error.empty(), "[TiledInference] tile inference failed: ", error);
+
+	torch::Tensor output;
+	if (tiles_inferred == int(tiles.size()))
+		output = accum / weight_sum.clamp_min(1e-6);
+	else // the blend weights of all tiles sum up to one -> skipped tiles contribute their previous output
+		output = accum + (1.0 - weight_sum).clamp_min(0.0) * prev_output;
+
+	if (selective) {
+		store_inputs(arena);
+		store(prev_output, output);
+		prev_module = module._ivalue().get();
+		prev_precision = precision;
+	}
+
+	// statistics
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	if (tiles_inferred > 0) {
+		double per_tile = ms / tiles_inferred;
+		tile_ms_avg = tile_ms_avg <= 0.0 ? per_tile : 0.9 * tile_ms_avg + 0.1 * per_tile;
+	}
+	time_saved_ms = tile_ms_avg * (int(tiles.size()) - tiles_inferred);
+	return output;
+}
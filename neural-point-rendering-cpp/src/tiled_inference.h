@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+
+#include <torch/script.h>
+
+#include "network_input.h"
+#include "network_precision.h"
+
+/*  Tiled Inference: runs the network on overlapping tiles of the frame to bound the activation memory
+	Every tile gets a halo of receptive_field pixels on each side (clamped to the frame), so the core of the tile
+	sees the same context as in a full frame pass. The pyramid levels res1-res3 and the motion are cropped accordingly.
+	The auxiliary images (or their features) are passed in full, since the motion vectors address them in normalized frame coordinates.
+	Seams are blended with linear ramps of blend pixels across the tile borders. All tile coordinates are multiples
+	of 32 to satisfy the network's downsampling.
+	Memory: inputs and the accumulated output are full frame, activations scale with the tile size only.
+	Selective update: the inputs are compared against the previous frame. Only tiles whose input region (core + halo)
+	contains a change above the tolerance are inferred again, the others keep the previous output. Changes of the
+	auxiliary images are not local (warping), they invalidate all tiles.
+*/
+class TiledInference {
+//structs
+public:
+	struct Tile {
+		int x0, y0, w, h;		// input region (core + halo) in res0 pixels
+		int cx0, cy0, cw, ch;	// core region in res0 pixels
+	};
+
+//data
+public:
+	std::vector<Tile> tiles;	// tiles of the last run
+	int tile_size = 0;			// core size of the last run
+	int tiles_inferred = 0;		// tiles of the last run that were actually inferred
+	double tile_ms_avg = 0.0;	// exponential average of the time per inferred tile
+	double time_saved_ms = 0.0;	// estimated time saved by skipping tiles in the last run
+
+//methods
+public:
+	// largest core size (multiple of 32) whose input region fits into budget_bytes per thread
+	static int tile_size_from_budget(size_t budget_bytes, size_t bytes_per_pixel, int halo, int threads);
+	// tiles run in parallel on device: threads on cuda, 1 on the cpu where every forward uses the whole intra-op pool
+	static int parallel_tiles(int threads, torch::Device device);
+	static std::vector<Tile> plan(int width, int height, int tile_size, int halo);
+
+	// 1x3xHxW output of the network for the packed arena, parallel_tiles(threads) tiles in parallel on the intra-op threads of torch
+	torch::Tensor run(torch::jit::script::Module& module, NetworkInputArena& arena, NetworkPrecision precision, torch::Device device,
+		int tile_size, int halo, int blend, int threads, bool selective = false, float tolerance = 0.0f);
+	// forget the previous frame, the next selective run infers all tiles
+	void reset();
+
+private:
+	torch::Tensor ramp(int start, int core_start, int core_end, int end, int blend, bool ramp_start, bool ramp_end, torch::Device device);
+	// per tile flag if it has to be inferred, compared to the inputs of the previous frame
+	std::vector<bool> changed_tiles(NetworkInputArena& arena, int halo, float tolerance);
+	void store_inputs(NetworkInputArena& arena);
+
+	torch::Tensor accum;		// weighted sum of the tile outputs
+	torch::Tensor weight_sum;
+
+	// inputs and output of the previous frame for the selective update
+	torch::Tensor prev_output, prev_resolution0;
+	std::vector<torch::Tensor> prev_groundtruth, prev_motion;
+	const void* prev_module = nullptr;
+	NetworkPrecision prev_precision = NetworkPrecision::FP32;
+};
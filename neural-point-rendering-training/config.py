@@ -108,6 +108,17 @@ class ConfigParams:
         self.output_results = False
         #---------------------------------------------------------------
 
+        ################################################################
+        # trace export
+        #---------------------------------------------------------------
+        # Specify if an int8 quantized trace (_inovis_int8.pt) is exported next to the fp32 trace. Selected in the real-time application with 'precision: int8'.
+        self.trace_int8 = False
+        # Number of captured validation batches used to calibrate the int8 quantization.
+        self.trace_int8_calibration_batches = 16
+        # Specify if the network is additionally exported as encoder (_inovis_encoder.pt) and decoder (_inovis_decoder.pt). The real-time application then caches the encoded auxiliary images per view, see 'encoder:' and 'decoder:' in networks/README.md.
+        self.trace_split = False
+        #---------------------------------------------------------------
+
         ################################################################
         # optimizer and scheduler config
         #---------------------------------------------------------------
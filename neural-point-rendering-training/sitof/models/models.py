@@ -668,6 +668,27 @@ class INOVIS(nn.Module):
         input_previous,         # input tensors of the auxiliary frames.
         input_movecs            # input tensors of the motion vectors.
         ):
+        features_previous = [self.encode_groundtruth(input_previous[i]) for i in range(self.in_gt_frame_amount)]
+        return self.decode(input_current, features_previous, input_movecs)
+
+    ################################################################
+    # Feature Extraction of one auxiliary frame. Independent of the current view -> can be cached per view (see INOVIS_Encoder)
+    def encode_groundtruth(self, input_previous):
+        # (Optional) Concat RGBD Data if should be warped
+        if self.warp_rgbd: # if rgbd should be warped as well, scale down and concat rgbd upfront
+            scale = 1.0 / (2**self.feature_extraction_depth)
+            rgbd = F.interpolate(input_previous, scale_factor=scale, mode='bilinear')
+            return torch.cat((rgbd, self.feature_extraction_previous_module(input_previous)),1)
+        # if rgbd should not be warped, do standard stuff
+        return self.feature_extraction_previous_module(input_previous)
+
+    ################################################################
+    # Everything after the auxiliary frame feature extraction: current view branch, warping, reweighting and reconstruction
+    def decode(self,
+        input_current,          # input tensor list of the current frame.
+        features_previous,      # encoded auxiliary frames (encode_groundtruth).
+        input_movecs            # input tensors of the motion vectors.
+        ):
         
         ################################################################
         # Feature Extraction
@@ -675,18 +696,6 @@ class INOVIS(nn.Module):
         # Extract Features of Highest Resolution Point Rendering 
         features_current = self.feature_extraction_current_module(input_current[0])
         #---------------------------------------------------------------
-        # Extract Featues of Nearest Groundtruth Frames
-        # (Optional) Concat RGBD Data if should be warped
-        features_previous = [None]*self.in_gt_frame_amount
-        if self.warp_rgbd: # if rgbd should be warped as well, scale down and concat rgbd upfront
-            for i in range(self.in_gt_frame_amount):
-                scale = 1.0 / (2**self.feature_extraction_depth)
-                rgbd = F.interpolate(input_previous[i], scale_factor=scale, mode='bilinear')
-                features_previous[i]=torch.cat((rgbd, self.feature_extraction_previous_module(input_previous[i])),1)
-        else:   # if rgbd should not be warped, do standard stuff
-            for i in range(self.in_gt_frame_amount):
-                features_previous[i]=self.feature_extraction_previous_module(input_previous[i])
-        #---------------------------------------------------------------
         
         ################################################################
         # Backward Warping
@@ -770,6 +779,25 @@ class INOVIS(nn.Module):
         return reconstr
         #---------------------------------------------------------------
 
+#######################################################################################################
+# INOVIS split into a per view encoder and a per frame decoder for tracing. The real-time application caches the
+# encoded auxiliary frames, so only the decoder runs every frame. Both share the parameters of the wrapped INOVIS.
+class INOVIS_Encoder(nn.Module):
+    def __init__(self, inovis):
+        super().__init__()
+        self.inovis = inovis
+
+    def forward(self, input_previous):  # rgbd of one auxiliary frame
+        return self.inovis.encode_groundtruth(input_previous)
+
+class INOVIS_Decoder(nn.Module):
+    def __init__(self, inovis):
+        super().__init__()
+        self.inovis = inovis
+
+    def forward(self, input_current, features_previous, input_movecs):
+        return self.inovis.decode(input_current, features_previous, input_movecs)
+
 #######################################################################################################
 # Unet from Neural Point-Based Graphics by Aliev et al.
 # Implementation from https://github.com/alievk/npbg/blob/master/npbg/models/unet.py
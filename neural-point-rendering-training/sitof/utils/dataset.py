@@ -25,6 +25,7 @@ import imgaug.augmenters as iaa
 from tqdm import tqdm
 
 from .read_image_from_binary_blob import read_blob
+from .shard_reader import read_shard_image, shard_reader_for_feature_dir
 from .tensor_utils import *
 from .data_transforms_monitor import *
 
@@ -43,11 +44,22 @@ def read_image(base_dir, file_stem, file_extension, channels = 3):
         return np.array(Image.open(file_path))[:,:,:channels].astype(dtype=np.float32)/255.0
     elif file_extension.lower() == '.bin':
         return read_blob(file_path)[:,:,:channels]
+    elif file_extension.lower() == '.shard':
+        return read_shard_image(file_path, channels)
     else:
         print("WARNING:", file_extension, "is an untested file format! (Using PIL...)")
         return np.array(Image.open(file_path))[:,:,:channels]
 
 def process_filelists(file_dir, max_images):
+    # dataset captured into shards: the samples of the feature, read with the .shard extension
+    if not os.path.isdir(file_dir) and shard_reader_for_feature_dir(file_dir) is not None:
+        filenames = shard_reader_for_feature_dir(file_dir).samples(os.path.basename(os.path.normpath(file_dir)))
+        assert len(filenames) > 0, f"{file_dir} is not in the shards!"
+        total_files_in_dir = len(filenames)
+        if max_images > 0 and max_images < len(filenames):
+            filenames = filenames[:max_images]
+        return filenames, '.shard', total_files_in_dir
+
     file_list = listdir(file_dir)
     assert len(file_list) > 0, f"{file_dir} is empty!"
     file_extension = splitext(listdir(file_dir)[0])[1]
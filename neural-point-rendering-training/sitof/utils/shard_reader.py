@@ -0,0 +1,133 @@
+import json
+import mmap
+import os
+import struct
+import zlib
+from glob import glob
+
+import numpy as np
+
+SHARD_MAGIC = b'INOSHARD'
+INDEX_MAGIC = b'INOINDEX'
+FOOTER_BYTES = 24
+
+class Shard:
+    ''' one memory mapped shard file written by the capture of the real-time application (see capture_shards.h):
+            header: "INOSHARD" uint32 version uint32 0
+            records: h x w x c tensors, 64 byte aligned, optionally zlib compressed
+            index: json with one entry per record
+            footer: uint64 index offset, uint64 index size, "INOINDEX"
+    '''
+    def __init__(self, path):
+        self.path = path
+        self.file = open(path, 'rb')
+        self.data = mmap.mmap(self.file.fileno(), 0, access=mmap.ACCESS_READ)
+        if len(self.data) < 16 + FOOTER_BYTES or self.data[:8] != SHARD_MAGIC or self.data[-8:] != INDEX_MAGIC:
+            self.close()
+            raise ValueError(path + ' is no complete shard (capture not finished?)')
+        index_offset, index_bytes = struct.unpack('<QQ', self.data[-FOOTER_BYTES:-8])
+        self.entries = json.loads(bytes(self.data[index_offset:index_offset + index_bytes]).decode('utf-8'))['entries']
+
+    def read(self, entry):
+        ''' numpy array h x w x c of an entry, a read-only view into the mapped file if it is not compressed '''
+        dtype = np.dtype(entry['dtype'])
+        offset, size = entry['offset'], entry['bytes']
+        if entry['compression'] == 'zlib':
+            return np.frombuffer(zlib.decompress(self.data[offset:offset + size]), dtype=dtype).reshape(entry['shape'])
+        return np.frombuffer(self.data, dtype=dtype, count=size // dtype.itemsize, offset=offset).reshape(entry['shape'])
+
+    def close(self):
+        self.data.close()
+        self.file.close()
+
+
+class ShardReader:
+    ''' all shards of a captured dataset (the shards folder of the dataset), indexed by sample and feature.
+        features are named like the folders of the png capture, e.g. input_0_lod0, nearest1_motion_0_lod0, groundtruth.
+        images are uint8 (as the pngs), motion vectors float32 with 3 channels (as the .bin files). Usage:
+            reader = ShardReader(data_root + set_description + '/shards/')
+            for sample in reader.samples():
+                arr = reader.get(sample, 'input_0_lod0')          # no copy, no decoding
+                t = reader.get_tensor(sample, 'groundtruth')      # torch tensor (shares the memory of arr)
+    '''
+    def __init__(self, directory):
+        self.directory = directory
+        self.shards = []
+        self.index = {}  # sample -> feature -> (shard, entry)
+        for path in sorted(glob(os.path.join(directory, 'shard_*.inoshard'))):
+            try:
+                shard = Shard(path)
+            except ValueError as e:
+                print('WARNING:', e)
+                continue
+            self.shards.append(shard)
+            for entry in shard.entries:
+                self.index.setdefault(entry['sample'], {})[entry['feature']] = (shard, entry)
+
+    def samples(self, feature=None):
+        ''' sorted sample names, only those that contain feature if given '''
+        return sorted(s for s, f in self.index.items() if feature is None or feature in f)
+
+    def features(self):
+        return sorted({f for features in self.index.values() for f in features})
+
+    def get(self, sample, feature):
+        shard, entry = self.index[sample][feature]
+        return shard.read(entry)
+
+    def get_tensor(self, sample, feature):
+        import torch
+        import warnings
+        # shares the read-only memory of the mapped shard, the tensor must not be written to
+        with warnings.catch_warnings():
+            warnings.simplefilter('ignore', UserWarning)
+            return torch.from_numpy(self.get(sample, feature))
+
+    def close(self):
+        for shard in self.shards:
+            shard.close()
+        self.shards = []
+        self.index = {}
+
+
+###########################################################
+# shards as image folders: <set>/<feature>/ does not exist but <set>/shards/ does
+
+_readers = {}
+
+def shard_reader_for_feature_dir(feature_dir):
+    ''' reader of the shards next to the (missing) feature folder, None if there are none. one reader per process (dataloader workers) '''
+    feature_dir = os.path.normpath(feature_dir)
+    shard_dir = os.path.join(os.path.dirname(feature_dir), 'shards')
+    if not os.path.isdir(shard_dir):
+        return None
+    key = (os.getpid(), shard_dir)
+    if key not in _readers:
+        _readers[key] = ShardReader(shard_dir)
+    return _readers[key]
+
+def read_shard_image(file_path, channels=3):
+    ''' like read_image of a png/bin in <set>/<feature>/<sample>.shard: float32 h x w x channels, images in [0,1] '''
+    feature_dir, sample = os.path.split(os.path.splitext(file_path)[0])
+    arr = shard_reader_for_feature_dir(feature_dir).get(sample, os.path.basename(os.path.normpath(feature_dir)))[:, :, :channels]
+    if arr.dtype == np.uint8:
+        return arr.astype(dtype=np.float32) / 255.0
+    return arr.astype(dtype=np.float32)
+
+
+def main():
+    import sys
+    import time
+    reader = ShardReader(sys.argv[1])
+    print(len(reader.shards), 'shards,', len(reader.index), 'samples, features:', reader.features())
+    start = time.time()
+    n = 0
+    for sample in reader.samples():
+        for feature in reader.index[sample]:
+            reader.get(sample, feature).sum()
+            n += 1
+    print(n, 'images in', time.time() - start, 's')
+
+
+if __name__ == '__main__':
+    main()
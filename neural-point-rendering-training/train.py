@@ -24,7 +24,7 @@ import torch.nn.functional as F
 
 # framework
 import sitof.models.models
-from sitof.models.models import get_current_learning_rate, INOVIS
+from sitof.models.models import get_current_learning_rate, INOVIS, INOVIS_Encoder, INOVIS_Decoder
 import sitof.models.model_zoo
 from sitof.utils.tensor_utils import *
 import sitof.utils.pytorch_ssim
@@ -439,7 +439,6 @@ def trace_model(dirpath):
 
         ################################################################
         # batch loop
-        batch_id = 0
         for i, filename, batch in dataloader:
             #---------------------------------------------------------------
             # put input tensors to device
@@ -447,39 +446,45 @@ def trace_model(dirpath):
             for key in batch:
                 on_device_batch[key] = batch[key].clone()
                 on_device_batch[key] = on_device_batch[key].to(state['config'].device) 
-            results = {}      
                             
             ################################################################
-            # forward pass
+            # trace with the first batch
             #---------------------------------------------------------------
             if state['config'].network_type == INOVIS:
-                #---------------------------------------------------------------
-                # tuple of point rendered input tensors of different sizes: full res; 1/2 res; 1/4 res; 1/8 res.
-                current = (torch.cat((on_device_batch['i_0'],on_device_batch['d_0'][:,0:1,:,:]),1),
-                            torch.cat((on_device_batch['i_l1'],on_device_batch['d_l1'][:,0:1,:,:]),1),
-                            torch.cat((on_device_batch['i_l2'],on_device_batch['d_l2'][:,0:1,:,:]),1),
-                            torch.cat((on_device_batch['i_l3'],on_device_batch['d_l3'][:,0:1,:,:]),1) )
-                #---------------------------------------------------------------
-                # tuple of #aux_images input data. Each with 6-7 channels: 3 channels rgb; 1 channel d, 2-3 channels movecs (depending on if mask information is given)
-                movec_c = 3 if state['config'].network_args['mask_warped'] else 2
-                previous = []
-                movecs = []
-
-                for gt_i in range(1,state['config'].network_args['in_gt_frame_amount'] + 1):
-                    previous += [torch.cat((on_device_batch['i_' + str(gt_i)][:,0:3,:,:],on_device_batch['d_' + str(gt_i)][:,0:1,:,:]),1)]
-                    movecs += [on_device_batch['m_' + str(gt_i)][:,0:movec_c,:,:]]
-                previous = tuple(previous)
-                movecs = tuple(movecs)
-                rendered = network(current,previous, movecs)
-                #---------------------------------------------------------------
-                # actual forward pass
-                results['rendered'] = rendered
-                jit_trace_model(network, (current,previous,movecs), dirpath + '_inovis.pt')
+                jit_trace_model(network, build_inovis_inputs(on_device_batch), dirpath + '_inovis.pt')
+                if getattr(state['config'], 'trace_split', False):
+                    jit_trace_model_split(network, build_inovis_inputs(on_device_batch), dirpath + '_inovis')
             #---------------------------------------------------------------
             # break, because we only need one batch input to trace the model 
             break
             #---------------------------------------------------------------
+
+        ################################################################
+        # int8 trace, calibrated on the captured validation frames
+        #---------------------------------------------------------------
+        if state['config'].network_type == INOVIS and getattr(state['config'], 'trace_int8', False):
+            jit_trace_model_int8(network, dataloader, getattr(state['config'], 'trace_int8_calibration_batches', 16), dirpath + '_inovis_int8.pt')
         
+################################################################
+# build the network input tuples from a batch
+def build_inovis_inputs(on_device_batch):
+    #---------------------------------------------------------------
+    # tuple of point rendered input tensors of different sizes: full res; 1/2 res; 1/4 res; 1/8 res.
+    current = (torch.cat((on_device_batch['i_0'],on_device_batch['d_0'][:,0:1,:,:]),1),
+                torch.cat((on_device_batch['i_l1'],on_device_batch['d_l1'][:,0:1,:,:]),1),
+                torch.cat((on_device_batch['i_l2'],on_device_batch['d_l2'][:,0:1,:,:]),1),
+                torch.cat((on_device_batch['i_l3'],on_device_batch['d_l3'][:,0:1,:,:]),1) )
+    #---------------------------------------------------------------
+    # tuple of #aux_images input data. Each with 6-7 channels: 3 channels rgb; 1 channel d, 2-3 channels movecs (depending on if mask information is given)
+    movec_c = 3 if state['config'].network_args['mask_warped'] else 2
+    previous = []
+    movecs = []
+
+    for gt_i in range(1,state['config'].network_args['in_gt_frame_amount'] + 1):
+        previous += [torch.cat((on_device_batch['i_' + str(gt_i)][:,0:3,:,:],on_device_batch['d_' + str(gt_i)][:,0:1,:,:]),1)]
+        movecs += [on_device_batch['m_' + str(gt_i)][:,0:movec_c,:,:]]
+    return (current, tuple(previous), tuple(movecs))
+
 ################################################################
 # pytorch trace model
 def jit_trace_model(model, exampletensor, save_path):
@@ -488,6 +493,47 @@ def jit_trace_model(model, exampletensor, save_path):
      frozen_model = torch.jit.optimize_for_inference(traced_script_module.eval())
      torch.jit.save(frozen_model,save_path)
 
+################################################################
+# pytorch trace encoder (one auxiliary frame -> features) and decoder (current, features, movecs -> image) separately
+def jit_trace_model_split(model, exampletensor, save_prefix):
+    current, previous, movecs = exampletensor
+    encoder = INOVIS_Encoder(model).eval()
+    decoder = INOVIS_Decoder(model).eval()
+    features = tuple(encoder(p) for p in previous)
+    jit_trace_model(encoder, (previous[0],), save_prefix + '_encoder.pt')
+    jit_trace_model(decoder, (current, features, movecs), save_prefix + '_decoder.pt')
+
+################################################################
+# pytorch trace int8 quantized model (cpu inference)
+# static post training quantization (fx graph mode). the activation ranges are calibrated by running the
+# captured frames of the dataloader through the prepared model
+def jit_trace_model_int8(model, dataloader, calibration_batches, save_path):
+    import copy
+    from torch.ao.quantization import get_default_qconfig_mapping
+    from torch.ao.quantization.quantize_fx import prepare_fx, convert_fx
+
+    try:
+        float_model = copy.deepcopy(model).cpu().eval()
+        example = None
+        prepared = None
+        for batch_id, (i, filename, batch) in enumerate(dataloader):
+            if batch_id >= calibration_batches:
+                break
+            inputs = build_inovis_inputs(batch)
+            if prepared is None:
+                example = inputs
+                prepared = prepare_fx(float_model, get_default_qconfig_mapping('x86'), example_inputs=example)
+            prepared(*inputs)
+        if prepared is None:
+            logging.warning('int8 trace: no calibration frames found, skipping ' + save_path)
+            return
+        quantized = convert_fx(prepared)
+        traced_script_module = torch.jit.trace(quantized, example)
+        torch.jit.save(torch.jit.freeze(traced_script_module.eval()), save_path)
+        logging.info('int8 trace: calibrated on ' + str(min(batch_id + 1, calibration_batches)) + ' batches, saved to ' + save_path)
+    except Exception as e:
+        logging.warning('int8 trace: quantization failed, only the fp32 trace is available: ' + str(e))
+
 ################################################################
 # crete a clean state -> no checkpoint loading
 def create_clean_state(configParams):